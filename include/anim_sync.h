@@ -0,0 +1,163 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// --- Animation Sync ---
+// Chained controllers share one animation timebase over a UART. The leader
+// sends a beacon every SYNC_BEACON_INTERVAL_MS with its clock and the active
+// pattern. A follower estimates its offset and drift against the leader clock
+// and renders from leader time. It also forwards each beacon on its own TX,
+// re-stamped with its estimate, so the next unit in the chain can follow it.
+// Pure code: nothing here reads a clock or touches a port, callers pass the
+// time in µs and move the bytes. The same code runs on the host through ptys.
+
+#ifndef SYNC_BEACON_INTERVAL_MS
+  #define SYNC_BEACON_INTERVAL_MS 100
+#endif
+
+#ifndef SYNC_LINK_BAUD
+  #define SYNC_LINK_BAUD 115200
+#endif
+
+// Wire format, little-endian: A5 5A seq hops leaderUs[6] pattern epochMs[4] crc8
+const size_t syncBeaconSize = 16;
+const uint8_t syncMaxHops = 8;   // Beacons that went further are dropped (a wired loop)
+
+struct SyncBeacon {
+    uint8_t seq;
+    uint8_t hops;            // 0 = sent by the leader itself
+    uint64_t leaderUs;       // Leader time when the first byte went out (48 bits on the wire)
+    uint8_t pattern;
+    uint32_t patternEpochMs; // Pattern start, in leader time
+};
+
+void encodeSyncBeacon(const SyncBeacon& beacon, uint8_t* out);
+// Time a beacon spends on the wire at a baud rate (8N1)
+uint32_t syncWireTimeUs(uint32_t baud);
+
+// Finds beacons in a byte stream; garbage and corrupted frames are skipped
+class SyncBeaconParser {
+public:
+    // Feed one byte; true when it completed a valid beacon
+    bool push(uint8_t byte, SyncBeacon& beacon);
+    uint32_t crcErrors() const { return badFrames; }
+
+private:
+    uint8_t frame[syncBeaconSize];
+    size_t length = 0;
+    uint32_t badFrames = 0;
+};
+
+// --- Clock Estimate ---
+// NTP-style: a beacon is only ever late, never early, so within each window of
+// syncFilterWindow beacons the one with the largest leader-minus-local offset
+// had the least delay and is kept. A straight line fitted through the last
+// syncFitPoints kept offsets gives the drift. The sync error is how far each
+// kept offset landed from the line's prediction.
+const int syncFilterWindow = 8;
+const int syncFitPoints = 16;
+const int64_t syncStepThresholdUs = 20000; // Further off than this is an outlier...
+const int syncStepOutliers = 3;            // ...and this many in a row mean the clocks stepped
+const int32_t syncMaxDriftPpb = 500000;    // 500 ppm, far beyond any crystal
+
+struct SyncClockStats {
+    uint32_t samples = 0;     // Beacons fed in
+    uint32_t outliers = 0;    // Beacons discarded as far too late
+    uint32_t steps = 0;       // Restarts after the leader (or this unit) changed its clock
+    int64_t offsetUs = 0;     // Leader minus local at the last kept sample
+    int32_t driftPpb = 0;     // Leader clock rate relative to the local one
+    int32_t lastErrorUs = 0;  // Last kept offset minus the prediction
+    int32_t worstErrorUs = 0; // Largest |error| since clearErrorPeak()
+};
+
+class SyncClock {
+public:
+    // A beacon stamped leaderUs was received at localUs (link delay already taken off)
+    void addSample(uint64_t localUs, uint64_t leaderUs);
+    bool locked() const { return numPoints > 0; }
+    // Leader time at a local time; only meaningful once locked
+    uint64_t leaderTimeUs(uint64_t localUs) const;
+    SyncClockStats stats() const { return clockStats; }
+    void clearErrorPeak() { clockStats.worstErrorUs = 0; }
+    void reset();
+
+private:
+    int64_t predictedOffsetUs(uint64_t localUs) const;
+    void addPoint(uint64_t localUs, int64_t offsetUs);
+
+    int windowCount = 0;
+    uint64_t windowBestLocalUs = 0;
+    int64_t windowBestOffsetUs = 0;
+    int consecutiveOutliers = 0;
+
+    uint64_t pointLocalUs[syncFitPoints];
+    int64_t pointOffsetUs[syncFitPoints];
+    int numPoints = 0;
+    int nextPoint = 0;
+
+    // offset(local) = modelOffsetUs + (local - modelLocalUs) * driftPpb / 1e9
+    uint64_t modelLocalUs = 0;
+    int64_t modelOffsetUs = 0;
+    int32_t driftPpb = 0;
+    SyncClockStats clockStats;
+};
+// --- End Clock Estimate ---
+
+// --- Sync Node ---
+enum SyncRole {
+    SYNC_ROLE_OFF,
+    SYNC_ROLE_LEADER,
+    SYNC_ROLE_FOLLOWER, // Follows the beacons on RX and forwards them on TX
+    NUM_SYNC_ROLES
+};
+extern const char* const syncRoleNames[NUM_SYNC_ROLES];
+
+struct SyncPatternState {
+    uint8_t pattern;
+    uint32_t epochMs;
+};
+
+struct SyncNodeStats {
+    uint32_t received = 0;  // Valid beacons in
+    uint32_t sent = 0;      // Beacons out (own or forwarded)
+    uint32_t crcErrors = 0;
+    uint32_t tooFar = 0;    // Beacons dropped for exceeding syncMaxHops
+    uint8_t hops = 0;       // Distance from the leader of the last beacon followed
+};
+
+class SyncNode {
+public:
+    // linkDelayUs: fixed time from a beacon's first byte leaving the sender to receive() seeing it
+    explicit SyncNode(uint32_t linkDelayUs) : linkDelayUs(linkDelayUs) {}
+    void setRole(SyncRole newRole);
+    SyncRole role() const { return currentRole; }
+    // Bytes that had all arrived by rxLocalUs
+    void receive(const uint8_t* data, size_t length, uint64_t rxLocalUs);
+    // Beacon due now (leader interval, or a received beacon to forward); returns its size or 0
+    size_t poll(uint64_t localUs, const SyncPatternState& localState, uint8_t* out);
+    // µs until poll() has a beacon of its own to send (UINT64_MAX if none scheduled)
+    uint64_t usUntilDue(uint64_t localUs) const;
+    // Follower with a clock estimate: patterns should run on leader time
+    bool following() const { return currentRole == SYNC_ROLE_FOLLOWER && syncClock.locked(); }
+    // Leader time when following, else the local time
+    uint64_t sharedTimeUs(uint64_t localUs) const;
+    // Pattern the leader last announced; false until following
+    bool leaderState(SyncPatternState& state) const;
+    SyncClock& clock() { return syncClock; }
+    SyncNodeStats stats() const;
+
+private:
+    uint32_t linkDelayUs;
+    SyncRole currentRole = SYNC_ROLE_OFF;
+    SyncBeaconParser parser;
+    SyncClock syncClock;
+    SyncBeacon lastBeacon = {};
+    bool haveLeaderState = false;
+    bool forwardPending = false;
+    uint8_t nextSeq = 0;
+    uint64_t nextSendUs = 0;
+    SyncNodeStats nodeStats;
+};
+// --- End Sync Node ---
+// --- End Animation Sync ---
@@ -0,0 +1,16 @@
+#pragma once
+
+// --- Kernel Benchmarks ---
+// Times the per-frame kernels (every pattern direct and indexed, brightness
+// scaling, RGBW conversion) at 1, 60, 300, 1000 and 4000 LEDs, plus the
+// display text formatting. Prints one "BENCH name=... leds=... ns_per_frame=..."
+// line per kernel and then the whole run as one "BENCH JSON {...}" line, which
+// scripts/bench_compare.py checks against scripts/bench_baseline.json.
+// Runs on the calling task with the strip left as it is; LED counts whose
+// buffers don't fit in the heap are skipped. Without ARDUINO the same file
+// builds for the host as board "Host" (test/test_bench, `pio test -e native`).
+
+// formatDisplay formats every menu and mode screen once without drawing; may be null.
+// Returns false if no buffer fitted or the RGBW kernel's output didn't match the reference.
+bool runBenchmarks(void (*formatDisplay)());
+// --- End Kernel Benchmarks ---
@@ -0,0 +1,102 @@
+#pragma once
+
+// --- Board Profiles ---
+// Each controller PCB is a set of compile-time traits, picked by its PlatformIO
+// env (-DBOARD_KNOB / -DBOARD_MINICLOCK). Code for a peripheral sits behind
+// `if constexpr` on these traits, and its driver object is a stand-in there
+// (board_drivers.h), so a board without it links none of its driver.
+
+// Strip chipsets, stored in NVS by number
+const int CHIPSET_TYPE_WS2812 = 0;
+const int CHIPSET_TYPE_SK6812 = 1;
+const int CHIPSET_TYPE_SK6812_RGBW = 2;
+const int NUM_CHIPSET_TYPES = 3; // Total number of options
+
+// Knob controller (media/knob-controller-pcb.jpeg): rotary encoder, BH1750,
+// INA219 on the strip supply, three indicator LEDs, OLED on the I2C header
+struct KnobBoard {
+    static constexpr const char* name = "Knob";
+    static constexpr bool hasI2cBus = true;
+    static constexpr int sdaPin = 14;
+    static constexpr int sclPin = 13;
+    static constexpr int ledDataPin = 21;
+    // Parallel segment pins, ledDataPin first. Only the strip output so far;
+    // add more once they are checked against the PCB.
+    static constexpr int ledDataPins[] = {21};
+    static constexpr int numLedDataPins = sizeof(ledDataPins) / sizeof(ledDataPins[0]);
+    static constexpr int maxLeds = 1000;
+    static constexpr int defaultChipset = CHIPSET_TYPE_WS2812;
+    static constexpr bool hasEncoder = true;
+    static constexpr int encoderAPin = 26;
+    static constexpr int encoderBPin = 27;
+    static constexpr int encoderButtonPin = 18;
+    static constexpr bool hasUserButton = true;
+    static constexpr int userButtonPin = 33;
+    static constexpr int bootButtonPin = 0;
+    static constexpr bool hasPwmLeds = true; // LED2-4
+    static constexpr int led2Pin = 22;
+    static constexpr int led3Pin = 19;
+    static constexpr int led4Pin = 23;
+    static constexpr bool hasLightSensor = true;   // BH1750
+    static constexpr bool hasCurrentSensor = true; // INA219
+    static constexpr bool hasDisplay = true;       // SSD1306, detected at boot
+    static constexpr bool hasSyncPort = true;      // Serial2, chains controllers
+    static constexpr int syncRxPin = 16; // Unverified placeholders: Serial2's default pins,
+    static constexpr int syncTxPin = 17; // not checked against the PCB's header
+};
+
+// Miniclock controller (media/miniclock-controller-pcb.jpeg): the digit strip
+// output, two buttons (SW2/SW3), an I2C expansion header and no sync header,
+// encoder, sensors or indicator LEDs. The photo shows the parts but not their
+// GPIOs, so only the boot button (GPIO 0 on every ESP32) is filled in. The
+// strip GPIO must be given for a miniclock build; the user button and the I2C
+// header stay off until theirs are known. Set them from the schematic:
+#ifndef MINICLOCK_LED_DATA_PIN // Digit strip data, required
+  #define MINICLOCK_LED_DATA_PIN -1
+#endif
+#ifndef MINICLOCK_USER_BUTTON_PIN // Select / back; without it the menu is driven from serial
+  #define MINICLOCK_USER_BUTTON_PIN -1
+#endif
+#ifndef MINICLOCK_SDA_PIN // I2C expansion header (optional OLED)
+  #define MINICLOCK_SDA_PIN -1
+#endif
+#ifndef MINICLOCK_SCL_PIN
+  #define MINICLOCK_SCL_PIN -1
+#endif
+
+struct MiniclockBoard {
+    static constexpr const char* name = "Miniclock";
+    static constexpr bool hasI2cBus = MINICLOCK_SDA_PIN >= 0 && MINICLOCK_SCL_PIN >= 0;
+    static constexpr int sdaPin = MINICLOCK_SDA_PIN;
+    static constexpr int sclPin = MINICLOCK_SCL_PIN;
+    static constexpr int ledDataPin = MINICLOCK_LED_DATA_PIN;
+    static constexpr int ledDataPins[] = {MINICLOCK_LED_DATA_PIN}; // One run is short enough
+    static constexpr int numLedDataPins = sizeof(ledDataPins) / sizeof(ledDataPins[0]);
+    static constexpr int maxLeds = 300; // Four digits, far shorter than a test strip
+    static constexpr int defaultChipset = CHIPSET_TYPE_WS2812;
+    static constexpr bool hasEncoder = false;
+    static constexpr int encoderAPin = -1;
+    static constexpr int encoderBPin = -1;
+    static constexpr int encoderButtonPin = -1;
+    static constexpr bool hasUserButton = MINICLOCK_USER_BUTTON_PIN >= 0;
+    static constexpr int userButtonPin = MINICLOCK_USER_BUTTON_PIN;
+    static constexpr int bootButtonPin = 0; // Next
+    static constexpr bool hasPwmLeds = false;
+    static constexpr int led2Pin = -1;
+    static constexpr int led3Pin = -1;
+    static constexpr int led4Pin = -1;
+    static constexpr bool hasLightSensor = false;
+    static constexpr bool hasCurrentSensor = false;
+    static constexpr bool hasDisplay = hasI2cBus; // Optional OLED on the expansion header
+    static constexpr bool hasSyncPort = false;
+    static constexpr int syncRxPin = -1;
+    static constexpr int syncTxPin = -1;
+};
+
+#if defined(BOARD_MINICLOCK)
+using Board = MiniclockBoard;
+static_assert(Board::ledDataPin >= 0, "set the miniclock's strip GPIO with -DMINICLOCK_LED_DATA_PIN");
+#else
+using Board = KnobBoard;
+#endif
+// --- End Board Profiles ---
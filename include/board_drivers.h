@@ -0,0 +1,35 @@
+#pragma once
+
+#include <type_traits>
+#include <BH1750.h>
+#include "ina219.h"
+#include "board.h"
+
+// --- Board Drivers ---
+// Sensor driver objects, picked by the board's traits. A board without the
+// part gets a stand-in with the same calls that does nothing, so shared code
+// still compiles there but no driver code is instantiated or linked.
+
+struct AbsentLightMeter {
+    bool begin(BH1750::Mode = BH1750::CONTINUOUS_HIGH_RES_MODE) { return false; }
+    float readLightLevel() { return -1; } // BH1750's error value
+};
+
+struct AbsentCurrentSensor {
+    bool begin(TwoWire*, uint32_t = INA219_SHUNT_MICROOHM) { return false; }
+    bool setProfile(Ina219Profile) { return false; }
+    bool poll() { return false; }
+    bool measure() { return false; }
+    bool started() const { return false; }
+    const Ina219Sample& last() const { return sample; }
+    Ina219Stats stats() const { return {}; }
+    Ina219Sample sample; // Stays zero
+};
+
+using LightMeter = std::conditional_t<Board::hasLightSensor, BH1750, AbsentLightMeter>;
+using CurrentSensor = std::conditional_t<Board::hasCurrentSensor, Ina219, AbsentCurrentSensor>;
+
+// The INA219 driver for calls that can use a running one (fingerprinting), or nullptr
+inline Ina219* currentSensorDriver(Ina219& sensor) { return &sensor; }
+inline Ina219* currentSensorDriver(AbsentCurrentSensor&) { return nullptr; }
+// --- End Board Drivers ---
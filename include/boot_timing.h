@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdint.h>
+
+// --- Boot Phase Timing ---
+// setup() and the background init task each mark the end of their boot
+// phases as they go. The report lists every phase with the task that ran it,
+// when it ended and how long it took, so a slower startup shows up as the one
+// phase that grew. Times count from app start; the bootloader is not included.
+
+const int maxBootPhases = 20;
+
+// µs since the app started
+uint32_t bootNowUs();
+// Record a phase that began at phaseStartUs and ends now; phaseStartUs moves on to now
+void bootPhaseDone(const char* name, uint32_t& phaseStartUs);
+// Print "BOOT PHASE ..." lines for every recorded phase plus a "BOOT END" summary
+void printBootReport(uint32_t firstFrameUs);
+// --- End Boot Phase Timing ---
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <U8g2lib.h>
+
+// --- Asynchronous Display Flush ---
+// The UI draws into the U8g2 frame buffer as usual, then posts it. A
+// background task copies the latest posted frame and sends it over I2C, so
+// the caller never waits for the transfer. If the display falls behind, only
+// the newest frame is kept; frames identical to the last one sent are skipped.
+
+struct DisplayFlushStats {
+    uint32_t posted = 0;    // displayPost() calls
+    uint32_t unchanged = 0; // Posts skipped because nothing changed on screen
+    uint32_t dropped = 0;   // Posts overwritten before the task could send them
+    uint32_t flushed = 0;   // Frames actually sent to the display
+    uint32_t lastFlushUs = 0;
+};
+
+// Start the flush task for an initialized display
+void displayFlushBegin(U8G2& display);
+// Queue the current contents of the display's frame buffer for sending
+void displayPost();
+// Counters since boot
+DisplayFlushStats displayFlushStats();
+// --- End Asynchronous Display Flush ---
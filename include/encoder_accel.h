@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stdint.h>
+
+// --- Encoder Acceleration ---
+// Turning the knob faster moves a value further per step, so a large range
+// is crossed in a few seconds while slow turning keeps single-unit control.
+// Speed is the number of encoder steps in the last ENCODER_VELOCITY_WINDOW_MS,
+// worked out from timestamped count changes. Turning back the other way starts
+// again from zero. Each value type has a curve that sets its step sizes:
+//   DECADE:     1 when slow, then 10, then 100. A coarse step lands on the
+//               next multiple of its size (237 -> 240 -> 250), so a count
+//               comes out round.
+//   PERCEPTUAL: 1 when slow, then steps of equal perceived brightness (CIE
+//               L*) that land on a fixed grid of coarseSteps levels; fast
+//               turning jumps several levels. Every step moves the value by
+//               at least 1.
+// Nothing here reads a clock: callers pass the time in.
+
+#ifndef ENCODER_VELOCITY_WINDOW_MS // Speed is averaged over this long
+  #define ENCODER_VELOCITY_WINDOW_MS 200
+#endif
+
+#ifndef ENCODER_MEDIUM_FROM_SPS // Steps per second from which a curve takes its medium step
+  #define ENCODER_MEDIUM_FROM_SPS 12
+#endif
+
+#ifndef ENCODER_FAST_FROM_SPS // Steps per second from which a curve takes its largest step
+  #define ENCODER_FAST_FROM_SPS 25
+#endif
+
+static_assert(ENCODER_MEDIUM_FROM_SPS * ENCODER_VELOCITY_WINDOW_MS > 1000, "a single step in the window must read as slow");
+
+const int encoderVelocityEvents = 16;     // Count changes kept for the window
+const int encoderPerceptualFastLevels = 4; // Levels per step of a PERCEPTUAL curve when fast
+
+enum EncoderSpeedTier {
+    ENCODER_SPEED_SLOW,
+    ENCODER_SPEED_MEDIUM,
+    ENCODER_SPEED_FAST,
+};
+
+enum EncoderCurveKind {
+    ENCODER_CURVE_DECADE,
+    ENCODER_CURVE_PERCEPTUAL,
+};
+
+struct EncoderCurve {
+    EncoderCurveKind kind;
+    int minValue;
+    int maxValue;
+    int coarseSteps;  // PERCEPTUAL: levels across the range
+    float mediumFromSps = ENCODER_MEDIUM_FROM_SPS;
+    float fastFromSps = ENCODER_FAST_FROM_SPS;
+};
+
+// Encoder steps per second, from the count changes seen in the window
+class EncoderVelocity {
+public:
+    // Record a count change (either sign) at nowMs; returns the speed including it
+    float update(uint32_t nowMs, long steps);
+    // Speed at nowMs without a new change
+    float speed(uint32_t nowMs) const;
+    void reset() { count = 0; }
+
+private:
+    struct Event {
+        uint32_t timeMs;
+        long steps;
+    };
+    Event events[encoderVelocityEvents];
+    int head = 0;      // Next slot to write
+    int count = 0;
+    int direction = 0; // Sign of the last change
+};
+
+EncoderSpeedTier encoderSpeedTier(const EncoderCurve& curve, float stepsPerSec);
+// Size of a DECADE curve's step for a tier: the largest of 1, 10, 100 that fits ten times in the range
+int encoderDecadeStep(const EncoderCurve& curve, EncoderSpeedTier tier);
+// Value after `steps` encoder steps (either sign) at a speed, clamped to the curve's range
+int encoderAccelApply(const EncoderCurve& curve, int value, long steps, float stepsPerSec);
+// PERCEPTUAL curves: perceived lightness (0..100) of a value and back
+float encoderPerceivedLevel(const EncoderCurve& curve, int value);
+int encoderValueForLevel(const EncoderCurve& curve, float level);
+// --- End Encoder Acceleration ---
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+class TwoWire;
+class Ina219;
+
+// --- I2C Topology ---
+// Identifies the parts the firmware knows by what they answer, not just by an
+// ACK at their address:
+//   SSD1306 (0x3C): a one-byte read returns the status register, whose low
+//                   nibble is 0x3, 0x6 or 0x7 on SSD1306 controllers (SH1106: 0x8)
+//   BH1750  (0x23): has no readable registers; a two-byte read returns the last result
+//   INA219  (0x40): the configuration register holds its reset value 0x399F or
+//                   one of the firmware's profiles (ina219ConfigValue())
+// A part that ACKs but doesn't match is reported as unverified and still
+// used. The topology found at boot is cached in NVS, so the next boot only
+// initializes the parts that were there last time. The boot task then checks
+// every known address again. It brings up a part that has appeared and saves
+// the topology if it changed.
+
+enum I2cDeviceKind {
+    I2C_DEVICE_SSD1306,
+    I2C_DEVICE_BH1750,
+    I2C_DEVICE_INA219,
+    NUM_I2C_DEVICE_KINDS
+};
+
+enum I2cMatch {
+    I2C_MATCH_ABSENT,     // No ACK
+    I2C_MATCH_OK,         // ACK and the part's signature
+    I2C_MATCH_UNVERIFIED, // ACK, but the signature didn't match
+};
+
+struct I2cKnownDevice {
+    uint8_t address;
+    const char* name;
+};
+extern const I2cKnownDevice i2cKnownDevices[NUM_I2C_DEVICE_KINDS];
+extern const char* const i2cMatchNames[3];
+
+struct I2cTopology {
+    I2cMatch devices[NUM_I2C_DEVICE_KINDS] = {};
+};
+
+const int maxI2cScanDevices = 16;
+
+// Every address that answered a full scan, and what it was identified as
+struct I2cScanResult {
+    int count = 0;
+    uint8_t addresses[maxI2cScanDevices];
+    int kinds[maxI2cScanDevices];         // I2cDeviceKind, or -1 for an unknown part
+    I2cMatch matches[maxI2cScanDevices];
+};
+
+// --- Pure signature checks and encoding (no I/O) ---
+bool ssd1306StatusMatches(uint8_t status);
+bool bh1750ReadMatches(int bytesRead);
+bool ina219ConfigMatches(uint16_t config);
+// Kind of the known part at an address, or -1
+int i2cKnownDeviceAt(uint8_t address);
+// NVS value, versioned; decode returns false if there is no usable cache
+int32_t encodeI2cTopology(const I2cTopology& topology);
+bool decodeI2cTopology(int32_t stored, I2cTopology& topology);
+// One scan entry for the display, "<n>:<name>": "1:SSD1306", "2:INA219?" (unverified), "3:0x68" (unknown part)
+void formatI2cScanPage(char* out, size_t size, const I2cScanResult& scan, int page);
+
+// --- Bus probes ---
+// Identify a known part. A running INA219 driver is read through, so its register pointer stays right.
+I2cMatch i2cFingerprint(TwoWire& wire, I2cDeviceKind kind, Ina219* ina219 = nullptr);
+// Probe addresses 1..126 and identify what answers
+I2cScanResult i2cScanBus(TwoWire& wire, Ina219* ina219 = nullptr);
+// --- End I2C Topology ---
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stdint.h>
+
+class TwoWire;
+
+// --- INA219 Current Monitor ---
+// Register-level driver: the calibration register is programmed for our
+// shunt, so the chip reports current and power directly in fixed LSBs.
+// ADC averaging is chosen per use case, and the conversion-ready flag in the
+// bus voltage register decides whether the result registers need reading at
+// all. Everything after the I2C transfer is integer math.
+
+#ifndef INA219_SHUNT_MICROOHM // Current shunt on the controller PCB
+  #define INA219_SHUNT_MICROOHM 1000 // 1 mΩ: 10 µV/10 mA, so one shunt ADC step is 10 mA
+#endif
+
+const uint8_t ina219DefaultAddress = 0x40;
+
+// Registers
+const uint8_t INA219_REG_CONFIG = 0x00;
+const uint8_t INA219_REG_SHUNT_VOLTAGE = 0x01;
+const uint8_t INA219_REG_BUS_VOLTAGE = 0x02;
+const uint8_t INA219_REG_POWER = 0x03;
+const uint8_t INA219_REG_CURRENT = 0x04;
+const uint8_t INA219_REG_CALIBRATION = 0x05;
+
+// ADC setups per use case (shunt averaging / total conversion time)
+enum Ina219Profile {
+    INA219_PROFILE_MONITOR,     // 128x shunt + 128x bus, ~136 ms: steady readings for the sensor screen
+    INA219_PROFILE_CALIBRATION, // 32x shunt, ~18 ms: power calibration sweeps
+    INA219_PROFILE_PROBE,       // 16x shunt, ~9 ms: LED count probes and self-test
+    NUM_INA219_PROFILES
+};
+
+struct Ina219Sample {
+    uint32_t busMv = 0;
+    int32_t shuntUv = 0;    // Derived from current and the shunt value, not read
+    int32_t currentUa = 0;
+    uint32_t powerUw = 0;
+    bool overflow = false;  // Math overflow flag: current/power are not valid
+};
+
+struct Ina219Stats {
+    uint32_t registerReads = 0;
+    uint32_t registerWrites = 0; // Including pointer-only writes
+    uint32_t conversions = 0;    // Result sets read
+    uint32_t notReady = 0;       // Polls that found no new conversion
+};
+
+// --- Pure register math (no I/O) ---
+// Current LSB in µA: smallest 1-2-5 step that covers the ±320 mV shunt range
+uint32_t ina219CurrentLsbUa(uint32_t shuntMicroOhm);
+// Calibration register value: trunc(0.04096 / (Current_LSB * R_shunt))
+uint16_t ina219CalibrationValue(uint32_t currentLsbUa, uint32_t shuntMicroOhm);
+// Configuration register value for a profile (16 V bus, /8 gain, continuous shunt+bus)
+uint16_t ina219ConfigValue(Ina219Profile profile);
+// Time for one full shunt+bus conversion in a profile
+uint32_t ina219ConversionTimeUs(Ina219Profile profile);
+bool ina219ConversionReady(uint16_t busRaw);
+bool ina219MathOverflow(uint16_t busRaw);
+uint32_t ina219DecodeBusMv(uint16_t busRaw);
+int32_t ina219DecodeShuntUv(uint16_t shuntRaw);
+int32_t ina219DecodeCurrentUa(uint16_t currentRaw, uint32_t currentLsbUa);
+uint32_t ina219DecodePowerUw(uint16_t powerRaw, uint32_t currentLsbUa); // Saturates at UINT32_MAX
+// Decode one result set (bus, current and power registers) into a sample
+Ina219Sample ina219DecodeSample(uint16_t busRaw, uint16_t currentRaw, uint16_t powerRaw,
+                                uint32_t currentLsbUa, uint32_t shuntMicroOhm);
+
+// --- Driver ---
+class Ina219 {
+public:
+    explicit Ina219(uint8_t address = ina219DefaultAddress);
+    // Program calibration and the monitor profile; false if the chip does not answer
+    bool begin(TwoWire* wire, uint32_t shuntMicroOhm = INA219_SHUNT_MICROOHM);
+    bool setProfile(Ina219Profile profile);
+    Ina219Profile profile() const { return activeProfile; }
+    // Non-blocking: read the results only if a new conversion is ready. True if last() changed.
+    bool poll();
+    // Restart the conversion and wait for a result taken entirely after this call
+    bool measure();
+    // Configuration register, through the driver's register pointer (for fingerprinting a running chip)
+    bool readConfig(uint16_t& value);
+    bool started() const { return wire != nullptr; }
+    const Ina219Sample& last() const { return lastSample; }
+    Ina219Stats stats() const { return driverStats; }
+
+private:
+    bool readRegister(uint8_t reg, uint16_t& value);
+    bool writeRegister(uint8_t reg, uint16_t value);
+    bool readResults(uint16_t busRaw);
+
+    TwoWire* wire = nullptr;
+    uint8_t address;
+    uint8_t pointer = 0xFF; // Register pointer on the chip; reads of the same register skip the pointer write
+    uint32_t shuntMicroOhm = INA219_SHUNT_MICROOHM;
+    uint32_t currentLsbUa = 0;
+    Ina219Profile activeProfile = INA219_PROFILE_MONITOR;
+    Ina219Sample lastSample;
+    Ina219Stats driverStats;
+};
+// --- End INA219 Current Monitor ---
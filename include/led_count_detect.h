@@ -0,0 +1,20 @@
+#pragma once
+
+// --- LED Count Auto-Detection ---
+// A WS2812/SK6812 chain stops at its first dead pixel, so "pixel i lights
+// up" is true for every i below the working length and false from there on.
+// That makes the working length binary-searchable: light one pixel at a
+// time, look at the supply current delta, and halve the range each step.
+// 1000 LEDs need about 10 measurements instead of a linear sweep.
+
+// Light only pixel `index` and return the current rise over a dark strip, in mA
+typedef float (*LedProbeFn)(int index, void* context);
+
+struct LedCountDetectResult {
+    int workingLeds;   // Pixels that light up; also the index of the first dead pixel
+    int measurements;  // Probe calls made
+};
+
+// Search [0, maxLeds) for the first pixel whose delta stays below minLitDeltaMa
+LedCountDetectResult detectLedCount(int maxLeds, float minLitDeltaMa, LedProbeFn probe, void* context);
+// --- End LED Count Auto-Detection ---
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <stdint.h>
+#include <FastLED.h>
+#include "board.h"
+#include "led_segments.h"
+
+#ifndef MAX_LEDS // Max buffer size, from the board profile unless overridden by build flag
+  #define MAX_LEDS (Board::maxLeds)
+#endif
+
+#ifndef LED_INDEXED_FRAMEBUFFER // 1 = patterns render 8-bit palette indices (see below)
+  #define LED_INDEXED_FRAMEBUFFER 0
+#endif
+
+#ifndef LED_REFRESH_INTERVAL_MS // Resend an unchanged frame this often, 0 = never
+  #define LED_REFRESH_INTERVAL_MS 1000
+#endif
+
+// --- Double-Buffered LED Output ---
+// Frames are rendered into a back buffer while a dedicated output task
+// clocks the front buffer out through the RMT peripheral. present() swaps
+// the buffers at the frame boundary, so pattern compute time overlaps the
+// previous frame's wire time instead of adding to it.
+// A frame identical to the one last sent (pixels and brightness) is not sent
+// again, except as a periodic refresh for strips that need one.
+// The wire buffer can be split over several data pins (led_segments.h); the
+// segments are sent together, so a frame costs the longest segment's time.
+//
+// With LED_INDEXED_FRAMEBUFFER, patterns render one palette index per pixel
+// into a single index buffer plus a 256-entry palette, and present expands
+// them into the one CRGB buffer on the wire. That replaces the two CRGB
+// frame buffers (6 bytes/pixel) with 4 bytes/pixel + 768 bytes, and palette
+// animation only rewrites 256 entries. Direct CRGB frames (self-test,
+// calibration) still work but render into the wire buffer without overlap.
+
+const int ledOutputPaletteSize = 256;
+
+struct FramePipelineStats {
+    uint32_t frames = 0;        // present() calls
+    uint32_t sent = 0;          // Frames that changed and were transmitted
+    uint32_t skipped = 0;       // Frames identical to the last one sent
+    uint32_t refreshes = 0;     // Unchanged frames resent for the refresh interval
+    uint32_t transmissions = 0; // sent + refreshes, counted by the output task
+    uint64_t renderUs = 0;   // Time between beginFrame() and present()
+    uint64_t waitUs = 0;     // Time present() blocked on the previous transmission
+    uint64_t transmitUs = 0; // Time the output task spent in FastLED.show()
+    uint32_t maxRenderUs = 0;
+    uint32_t maxWaitUs = 0;
+    uint32_t maxTransmitUs = 0;
+    uint64_t windowStartUs = 0;
+};
+
+// Buffer on the wire (or last sent); before ledOutputBegin(), the one to register with FastLED.addLeds()
+CRGB* ledOutputFrontBuffer();
+// Global brightness the front buffer was sent with
+uint8_t ledOutputFrontBrightness();
+// Wire buffer to register for RGBW strips: rgbwWireLength(MAX_LEDS) entries, RGB order
+CRGB* ledOutputRgbwWireBuffer();
+// Take over the registered controllers, one per segment of the plan, and start
+// the output task. Each controller is pointed at its segment's slice of the
+// front buffer (or the RGBW wire buffer) before every transmission.
+// timing is the chipset's, for the wire time in the stats. With rgbw, frames
+// are converted to GRBW into the wire buffer as they are sent.
+void ledOutputBegin(CLEDController* const* controllers, const LedSegmentPlan& plan,
+                    const LedWireTiming& timing, bool rgbw = false);
+// Pixels sent per frame: the plan's total, or the last ledOutputSetLength()
+int ledOutputLength();
+// Re-slice the same controllers over n pixels (1..MAX_LEDS) once the wire is
+// free. Returns false and keeps the old length if a pin would get no pixels.
+bool ledOutputSetLength(int n);
+// Start a frame: returns the back buffer to render into (MAX_LEDS pixels)
+CRGB* ledOutputBeginFrame();
+// Finish a frame: wait for the previous transmission, swap, and send (unless unchanged)
+void ledOutputPresent(uint8_t brightness);
+// Abandon a frame started with ledOutputBeginFrame() without sending it
+void ledOutputCancelFrame();
+#if LED_INDEXED_FRAMEBUFFER
+// Start an indexed frame: returns the index buffer (MAX_LEDS entries)
+uint8_t* ledOutputBeginIndexedFrame();
+// Palette the indices refer to (ledOutputPaletteSize entries), read at present
+CRGB* ledOutputPalette();
+// Expand the first n indices (the rest go black) and send, unless unchanged
+void ledOutputPresentIndexed(uint8_t brightness, int n);
+#endif
+// Resend an unchanged frame after this many ms (0 = never)
+void ledOutputSetRefreshInterval(uint32_t intervalMs);
+// millis() deadline of the next periodic refresh; false if refresh is disabled
+bool ledOutputNextRefresh(unsigned long& due);
+// Resend the front buffer if the refresh interval has passed
+void ledOutputRefreshIfDue();
+// Render and present an all-black frame
+void ledOutputClear();
+// Block until the last presented frame has been fully transmitted
+void ledOutputFlush();
+// Print render/wait/transmit timings since the last report, then reset them
+void printFramePipelineStats();
+// --- End Double-Buffered LED Output ---
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdint.h>
+
+// --- Parallel LED Segments ---
+// A long strip is cut into runs, each on its own data pin. The frame buffer
+// stays one contiguous leds[]; segment k sends pixels [start, start + count)
+// on the board's k-th data pin. Every pin gets its own FastLED controller, and
+// FastLED's ESP32 RMT driver clocks all registered controllers out together.
+// A frame then takes as long as the longest segment, not the whole strip.
+//
+// RGBW strips send packed GRBW bytes from a CRGB wire buffer (3 bytes per
+// entry, 4 per pixel). A segment can only start on a whole entry, so RGBW
+// split points fall on multiples of 3 pixels.
+//
+// The encoding half models the bits FastLED puts on each pin: every byte MSB
+// first, each bit a high and a low time from the chipset's timing. It gives
+// the expected wire time per frame, and tools/segment_waveform.cpp uses it to
+// check segment plans against golden waveforms on the host. Pure code, no
+// FastLED or Arduino.
+
+// FastLED's RMT driver gives each channel 2 of the 8 memory blocks, so 4 run at once
+const int maxLedSegments = 4;
+
+struct LedSegment {
+    int start;     // First pixel in leds[]
+    int count;     // Pixels on this pin
+    int wireStart; // First entry of the buffer handed to this pin's controller
+    int wireCount; // Entries sent (3 bytes each); RGBW packs 4 bytes per pixel
+};
+
+struct LedSegmentPlan {
+    int numSegments;
+    LedSegment segments[maxLedSegments];
+    int longestWireBytes; // Bytes on the busiest pin, which sets the frame time
+};
+
+// Split numLeds pixels over up to numSegments pins as evenly as the alignment
+// allows. Segments that would be empty are dropped, so a plan may have fewer.
+LedSegmentPlan planLedSegments(int numLeds, int numSegments, bool rgbw);
+
+// Bit timings in ns, from FastLED's clockless chipset table (T1, T2, T3):
+// a 0 is high T1 then low T2 + T3, a 1 is high T1 + T2 then low T3
+struct LedWireTiming {
+    const char* name;
+    uint16_t zeroHighNs;
+    uint16_t zeroLowNs;
+    uint16_t oneHighNs;
+    uint16_t oneLowNs;
+    uint16_t latchUs; // Low time the strip needs before a new frame
+};
+extern const LedWireTiming ws2812WireTiming;
+extern const LedWireTiming sk6812WireTiming;
+
+struct LedWireSymbol {
+    uint16_t highNs;
+    uint16_t lowNs;
+};
+
+// Encode count bytes into 8 symbols each, MSB first
+void ledWireEncode(const uint8_t* bytes, int count, const LedWireTiming& timing, LedWireSymbol* out);
+// Decode symbols back into bytes the way a strip samples them: a bit is 1 when
+// it is still high halfway between the chipset's 0 and 1 high times.
+// Returns the bytes written; a trailing partial byte is dropped.
+int ledWireDecode(const LedWireSymbol* symbols, int count, const LedWireTiming& timing, uint8_t* out);
+// Time on the wire for one frame of the given bytes, latch included
+uint32_t ledWireFrameUs(int bytes, const LedWireTiming& timing);
+// --- End Parallel LED Segments ---
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+// --- Logging ---
+// LOG_ERROR/WARN/INFO/DEBUG format into a lock-free ring buffer and return
+// immediately; a low-priority task drains the ring to Serial. A full ring
+// drops the message and counts it instead of blocking. Each call site is
+// rate-limited on its own, and suppressed messages are counted into the
+// next one that gets through. Levels above LOG_LEVEL compile to nothing.
+
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL // Defined by build flag or default
+  #define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#ifndef LOG_MIN_INTERVAL_MS // Minimum time between two messages from one call site
+  #define LOG_MIN_INTERVAL_MS 50
+#endif
+
+// Shared by every task that reaches the call site, so both fields are atomic
+struct LogSite {
+    std::atomic<uint32_t> lastMs{0};     // When this site last logged; 0 = never
+    std::atomic<uint32_t> suppressed{0}; // Messages rate-limited since then
+};
+
+struct LogStats {
+    uint32_t written;     // Messages queued
+    uint32_t dropped;     // Lost because the ring was full
+    uint32_t rateLimited; // Suppressed by per-site rate limiting
+};
+
+// Start the drain task; before this, messages go straight to Serial
+void logBegin();
+// Queue a message (use the LOG_* macros rather than calling this directly)
+void logWrite(int level, LogSite* site, uint32_t minIntervalMs, const char* format, ...)
+    __attribute__((format(printf, 4, 5)));
+// Wait until everything queued so far has been written to Serial
+void logFlush();
+LogStats logStats();
+
+#define LOG_AT(level, minIntervalMs, format, ...) do { \
+        static LogSite logSite_; \
+        logWrite(level, &logSite_, minIntervalMs, format, ##__VA_ARGS__); \
+    } while (0)
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+  #define LOG_ERROR(format, ...) LOG_AT(LOG_LEVEL_ERROR, LOG_MIN_INTERVAL_MS, format, ##__VA_ARGS__)
+#else
+  #define LOG_ERROR(format, ...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+  #define LOG_WARN(format, ...) LOG_AT(LOG_LEVEL_WARN, LOG_MIN_INTERVAL_MS, format, ##__VA_ARGS__)
+#else
+  #define LOG_WARN(format, ...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+  #define LOG_INFO(format, ...) LOG_AT(LOG_LEVEL_INFO, LOG_MIN_INTERVAL_MS, format, ##__VA_ARGS__)
+#else
+  #define LOG_INFO(format, ...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+  #define LOG_DEBUG(format, ...) LOG_AT(LOG_LEVEL_DEBUG, LOG_MIN_INTERVAL_MS, format, ##__VA_ARGS__)
+#else
+  #define LOG_DEBUG(format, ...) do {} while (0)
+#endif
+// --- End Logging ---
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+
+// --- Loop Latency Watchdog ---
+// loop() marks the stage it is in as it runs. Two budgets are checked:
+// an input (encoder/button interrupt or serial byte) must be handled by the
+// end of the iteration that picks it up within LOOP_INPUT_BUDGET_MS of
+// arriving, and one iteration's busy time must stay under LOOP_FRAME_BUDGET_MS
+// so the next pattern frame is not held up. A blown budget is counted against
+// the stage that was running when the budget ran out.
+
+#ifndef LOOP_INPUT_BUDGET_MS
+  #define LOOP_INPUT_BUDGET_MS 20
+#endif
+#ifndef LOOP_FRAME_BUDGET_MS
+  #define LOOP_FRAME_BUDGET_MS 33 // ~30 fps
+#endif
+
+enum LoopStage {
+    LOOP_STAGE_IDLE,    // Between iterations (sleeping, or preempted before waking)
+    LOOP_STAGE_INPUT,   // Encoder, buttons and serial commands
+    LOOP_STAGE_UI,      // Menu/mode transitions and mode actions
+    LOOP_STAGE_PATTERN, // Pattern render and frame present
+    LOOP_STAGE_PWM,
+    LOOP_STAGE_SENSORS,
+    LOOP_STAGE_DISPLAY,
+    NUM_LOOP_STAGES
+};
+extern const char* const loopStageNames[NUM_LOOP_STAGES];
+
+struct LoopBudgetViolation {
+    LoopStage stage = LOOP_STAGE_IDLE; // Stage running when the budget ran out
+    uint32_t latencyUs = 0;
+    uint32_t atMs = 0;                 // millis() when it was detected (0 = never)
+};
+
+struct LoopWatchdogStats {
+    uint32_t iterations = 0;
+    uint32_t inputsHandled = 0;    // Iterations that picked up at least one input event
+    uint32_t inputViolations = 0;
+    uint32_t frameViolations = 0;
+    uint32_t maxInputUs = 0;       // Worst input-to-handled latency
+    uint32_t maxIterationUs = 0;   // Worst busy time of one iteration
+    uint32_t violationsByStage[NUM_LOOP_STAGES] = {};
+    LoopBudgetViolation lastInput;
+    LoopBudgetViolation lastFrame;
+};
+
+// Change the budgets at runtime
+void loopWatchdogSetBudgets(uint32_t inputMs, uint32_t frameMs);
+// Timestamp an input event; the first one since the last iteration is kept
+void loopWatchdogInputFromISR();
+void loopWatchdogInput();
+// Bracket one loop() iteration, marking each stage as it starts
+void loopWatchdogBeginIteration();
+void loopWatchdogStage(LoopStage stage);
+void loopWatchdogEndIteration();
+
+// Counters since boot
+LoopWatchdogStats loopWatchdogStats();
+// Time since the last completed iteration, and since the last input was handled
+uint32_t loopWatchdogMsSinceIteration();
+uint32_t loopWatchdogMsSinceInput();
+// Smallest free stack of the firmware's tasks, in bytes
+uint32_t loopWatchdogMinStackFree();
+// Print budgets, violations, and stack/heap high-water marks
+void printLoopWatchdog();
+// --- End Loop Latency Watchdog ---
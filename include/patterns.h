@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+#include <FastLED.h>
+
+// --- Time-Indexed Pattern API ---
+// Every pattern is a pure function of (t, n): rendering the same timestamp
+// into a buffer of the same length always produces the same pixels. There is
+// no hidden animation state, so patterns can be rendered at any moment,
+// faster than real time, or as several independent instances.
+
+// Available patterns (index into the patterns[] table)
+enum FastLedPattern {
+  RAINBOW,
+  RGB_CHECKER,
+  CHASE,
+  NUM_FASTLED_PATTERNS
+};
+
+struct PatternDescriptor {
+    const char* name;
+    // Render the frame for time t (ms since pattern start) into leds[0..n)
+    void (*render)(uint32_t t, CRGB* leds, int n);
+    // Earliest time after t at which the rendered frame may differ
+    uint32_t (*nextChange)(uint32_t t, int n);
+    // Indexed form: 8-bit palette indices into indices[0..n), and the palette
+    // for time t. Expanding indices through the palette gives render()'s frame.
+    void (*renderIndexed)(uint32_t t, uint8_t* indices, int n);
+    void (*updatePalette)(uint32_t t, CRGB* palette);
+};
+
+const int paletteSize = 256;
+
+extern const PatternDescriptor patterns[NUM_FASTLED_PATTERNS];
+
+void renderRainbow(uint32_t t, CRGB* leds, int n);
+void renderRgbChecker(uint32_t t, CRGB* leds, int n);
+void renderChase(uint32_t t, CRGB* leds, int n);
+void renderRainbowIndexed(uint32_t t, uint8_t* indices, int n);
+void updateRainbowPalette(uint32_t t, CRGB* palette);
+void renderRgbCheckerIndexed(uint32_t t, uint8_t* indices, int n);
+void updateRgbCheckerPalette(uint32_t t, CRGB* palette);
+void renderChaseIndexed(uint32_t t, uint8_t* indices, int n);
+void updateChasePalette(uint32_t t, CRGB* palette);
+
+// RGB Checker timeline position, used by the UI for logging color pulses
+struct RgbCheckerPhase {
+    uint8_t stage;       // 0=Red, 1=Green, 2=Blue
+    bool on;             // Strip lit during this segment
+    uint32_t start;      // Segment start time (ms since pattern start)
+    uint32_t end;        // Segment end time (exclusive)
+};
+RgbCheckerPhase rgbCheckerPhaseAt(uint32_t t);
+extern const char* const rgbCheckerColorNames[3];
+
+// --- Pattern Clock ---
+// Source of "now" for pattern time. Defaults to millis() on the device; host
+// builds, benchmarks or a synchronized timebase can inject their own.
+typedef uint32_t (*PatternClockFn)();
+void setPatternClock(PatternClockFn clock);
+uint32_t patternClockNow();
+// --- End Time-Indexed Pattern API ---
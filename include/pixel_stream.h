@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// --- Pixel Streaming ---
+// A PC pushes whole frames over the USB serial port in the Adalight format:
+//   'A' 'd' 'a' countHi countLo (countHi ^ countLo ^ 0x55)  then count + 1 RGB triplets
+// The parser never buffers pixel data itself. It hands out the place the next
+// bytes belong: its own 6-byte header slot, then the caller's frame buffer.
+// The caller reads the UART straight into that, so each pixel byte is copied
+// once, from the driver's ring into the back buffer.
+// A bad header checksum drops one byte and hunts for the next "Ada". Frames
+// longer than the strip are read past and counted. A frame that stalls mid-payload
+// is dropped after PIXEL_STREAM_FRAME_TIMEOUT_MS. Adalight carries no payload
+// checksum, so payload bytes lost in transit only show up as a bad next header.
+// Pure code: the time is passed in, and the same parser runs on the host behind a pty.
+
+#ifndef PIXEL_STREAM_BAUD // Console baud while streaming, 0 = keep the current one
+  #define PIXEL_STREAM_BAUD 2000000
+#endif
+
+#ifndef PIXEL_STREAM_RX_BUFFER_SIZE // UART driver ring; holds a 1000 LED frame while the previous one is sent
+  #define PIXEL_STREAM_RX_BUFFER_SIZE 4096
+#endif
+
+#ifndef PIXEL_STREAM_FRAME_TIMEOUT_MS // A frame that stalls this long mid-payload is dropped
+  #define PIXEL_STREAM_FRAME_TIMEOUT_MS 100
+#endif
+
+#ifndef PIXEL_STREAM_IDLE_EXIT_MS // Streaming ends after this long without data
+  #define PIXEL_STREAM_IDLE_EXIT_MS 5000
+#endif
+
+const size_t pixelStreamHeaderSize = 6;
+
+enum PixelStreamEvent {
+    PIXEL_STREAM_NONE,
+    PIXEL_STREAM_NEED_BUFFER, // Header accepted: call setFrameBuffer() before reading on
+    PIXEL_STREAM_FRAME,       // The frame buffer holds a complete frame of framePixels() pixels
+};
+
+struct PixelStreamStats {
+    uint32_t frames = 0;       // Complete frames
+    uint32_t badHeaders = 0;   // "Ada" with a wrong length checksum
+    uint32_t oversize = 0;     // Frames longer than the strip, read past
+    uint32_t timeouts = 0;     // Frames dropped after stalling mid-payload
+    uint32_t skippedBytes = 0; // Bytes thrown away while hunting for a header
+};
+
+class PixelStreamParser {
+public:
+    explicit PixelStreamParser(int maxPixels);
+
+    // Where the next bytes go and at most how many may be read there.
+    // nullptr with 0 while a frame buffer is needed.
+    uint8_t* writePointer(size_t& maxBytes);
+    // count bytes were written at writePointer()
+    PixelStreamEvent commit(size_t count, uint32_t nowMs);
+    // Buffer for the accepted frame, at least framePixels() * 3 bytes
+    void setFrameBuffer(uint8_t* pixels);
+    // Drop a frame stalled mid-payload. True if one was dropped; its buffer
+    // was handed out and is not going to be completed.
+    bool expire(uint32_t nowMs);
+    // Forget any partial frame, without counting it
+    void reset();
+
+    int framePixels() const { return pixels; }
+    // ms until expire() has something to do, or UINT32_MAX
+    uint32_t msUntilExpiry(uint32_t nowMs) const;
+    const PixelStreamStats& stats() const { return counters; }
+    void clearStats() { counters = PixelStreamStats(); }
+
+private:
+    enum State { HEADER, NEED_BUFFER, PAYLOAD, SKIP };
+
+    void dropHeaderByte();
+
+    int maxPixels;
+    State state = HEADER;
+    uint8_t header[pixelStreamHeaderSize];
+    size_t headerLength = 0;
+    uint8_t* frame = nullptr;
+    int pixels = 0;
+    size_t payloadDone = 0;
+    size_t payloadSize = 0;
+    uint8_t skipBuffer[64];
+    uint32_t lastByteMs = 0;
+    PixelStreamStats counters;
+};
+
+// One "<tag> fps=... frames=... ..." report line for the frames since the last one
+void formatPixelStreamReport(char* out, size_t size, const char* tag, const PixelStreamStats& stats,
+                             uint32_t windowFrames, uint32_t windowMs, uint32_t rxOverflows);
+// --- End Pixel Streaming ---
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <Arduino.h>
+#include "pixel_stream.h"
+
+// --- Pixel Stream Link ---
+// Streams Adalight frames (pixel_stream.h) from the USB serial console into
+// the LED output. While a stream is active, every byte on Serial is pixel
+// data: the console switches to PIXEL_STREAM_BAUD and the single-key
+// commands are off. Each frame is read straight into the output back buffer
+// and shown as soon as it is complete. Pixels past the end of a short frame
+// are black. Once a second a "STREAM fps=..." line reports the frame rate
+// and error counters. The stream ends after PIXEL_STREAM_IDLE_EXIT_MS
+// without data, or from pixelStreamEnd(), and prints a "STREAM END" line.
+
+// Call before Serial.begin(): the UART ring has to hold a whole frame
+void pixelStreamSetupSerial();
+// Switch the console to streaming; frames are shown at the given brightness
+void pixelStreamBegin(uint8_t brightness);
+void pixelStreamEnd();
+bool pixelStreamActive();
+// Read what has arrived and show completed frames; call from loop() while active
+void pixelStreamService();
+// Milliseconds until pixelStreamService() has a timeout or report due (maxMs if none)
+unsigned long pixelStreamMsUntilDue(unsigned long maxMs);
+// --- End Pixel Stream Link ---
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+#include <FastLED.h>
+
+// --- Per-Chipset Power Model ---
+// Supply current of a frame is modelled as a dark-strip baseline plus, per
+// color channel, a fixed draw for each unit of channel value on each pixel.
+// The per-unit draws are fitted from an INA219 sweep and stored per chipset.
+// Predicting a frame is a table-driven integer sum over the pixels.
+
+enum PowerChannel {
+    POWER_R,
+    POWER_G,
+    POWER_B,
+    POWER_W, // Only calibrated on RGBW parts
+    NUM_POWER_CHANNELS
+};
+
+struct PowerCalibration {
+    uint16_t version;                         // powerCalibrationVersion when valid, 0 if uncalibrated
+    uint16_t darkMa;                          // Board + dark strip current at calibration time
+    uint32_t naPerUnit[NUM_POWER_CHANNELS];   // nA per pixel per channel unit (0-255)
+};
+
+const uint16_t powerCalibrationVersion = 2; // 2: measured with the 1 mΩ shunt scale; older tables read 10x low
+
+// Predicted supply current in mA for n pixels shown at a global brightness.
+// With rgbw, pixels are split into RGB + W as the output stage sends them.
+uint32_t predictFrameMa(const CRGB* leds, int n, uint8_t brightness, const PowerCalibration& cal, bool rgbw = false);
+
+// Least-squares slope of current over channel level, per pixel, in nA per unit
+uint32_t fitNaPerUnit(const uint8_t* levels, const int32_t* currentMa, int points, int litLeds);
+// --- End Per-Chipset Power Model ---
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <stdint.h>
+
+// --- PWM Fade Sequencer ---
+// Turns brightness requests and effects into the commands the LEDC fade unit
+// runs on its own: "set duty now" or "fade to duty over N ms". The sequencer
+// only decides what to send and when; the hardware is reached through a
+// backend, so the same code runs against a command recorder on the host.
+// Nothing here reads a clock: callers pass the time in.
+
+#ifndef PWM_FADE_FULL_SCALE_MS // A 0 <-> 255 change fades over this long, smaller steps proportionally
+  #define PWM_FADE_FULL_SCALE_MS 400
+#endif
+
+#ifndef PWM_FADE_MAX_SEGMENT_MS // Longest single hardware fade; a new request waits at most this long
+  #define PWM_FADE_MAX_SEGMENT_MS 250
+#endif
+
+#ifndef PWM_BREATHE_PERIOD_MS // One full breath, up and down
+  #define PWM_BREATHE_PERIOD_MS 3000
+#endif
+
+#ifndef PWM_BLINK_ON_MS
+  #define PWM_BLINK_ON_MS 500
+#endif
+
+#ifndef PWM_BLINK_OFF_MS
+  #define PWM_BLINK_OFF_MS 500
+#endif
+
+const int pwmFadeMaxChannels = 8;
+
+enum PwmEffect {
+    PWM_EFFECT_STEADY,
+    PWM_EFFECT_BREATHE, // Linear ramps between brightness/8 and brightness
+    PWM_EFFECT_BLINK,   // Hard on/off at brightness
+    NUM_PWM_EFFECTS
+};
+extern const char* const pwmEffectNames[NUM_PWM_EFFECTS];
+
+// One step of a program: fade to duty over fadeMs (0 = jump), then stay for holdMs
+struct PwmLeg {
+    uint8_t duty;
+    uint32_t fadeMs;
+    uint32_t holdMs;
+};
+
+// Up to two legs, played once (a plain fade) or looped (an effect)
+struct PwmProgram {
+    PwmLeg legs[2];
+    uint8_t numLegs;
+    bool repeat;
+};
+
+// Fade time for a brightness change, proportional to its size
+uint32_t pwmFadeTimeMs(uint8_t from, uint8_t to);
+// Program that fades to duty and stays there
+PwmProgram pwmFadeProgram(uint8_t duty, uint32_t fadeMs);
+// Looping program for an effect at a brightness (a steady effect is a plain fade)
+PwmProgram pwmEffectProgram(PwmEffect effect, uint8_t brightness);
+
+// Hardware side of the sequencer
+struct PwmFadeBackend {
+    void (*setDuty)(int channel, uint8_t duty, void* context);
+    void (*startFade)(int channel, uint8_t duty, uint32_t fadeMs, void* context); // Must report the end via fadeEnded()
+    void* context;
+};
+
+struct PwmFadeStats {
+    uint32_t requests = 0;   // Programs handed in
+    uint32_t unchanged = 0;  // Requests equal to what was already playing or pending
+    uint32_t replaced = 0;   // Pending requests overwritten before they started
+    uint32_t dutySets = 0;   // Immediate duty writes issued
+    uint32_t fades = 0;      // Hardware fades started
+};
+
+class PwmFadeSequencer {
+public:
+    PwmFadeSequencer(int numChannels, const PwmFadeBackend& backend);
+    // Play a program on a channel: at once if the channel is not fading, else when its current segment ends
+    void request(int channel, const PwmProgram& program, uint32_t nowMs);
+    // The hardware finished the fade it was given on a channel
+    void fadeEnded(int channel, uint32_t nowMs);
+    // Start whatever is due; returns ms until the next hold ends (UINT32_MAX if none)
+    uint32_t poll(uint32_t nowMs);
+    // The channel was driven by someone else and now sits at duty: drop its program
+    void reset(int channel, uint8_t duty);
+    PwmFadeStats stats() const { return sequencerStats; }
+
+private:
+    struct Channel {
+        PwmProgram program;
+        PwmProgram pending;
+        bool hasProgram = false;
+        bool hasPending = false;
+        bool done = true;            // Program finished, nothing more to send
+        bool fading = false;         // Hardware fade running, the channel can't take commands
+        bool waiting = false;        // Letting time pass (hold or flat segment) until waitUntilMs
+        uint8_t leg = 0;
+        uint8_t duty = 0;            // Duty at the end of the last command
+        uint32_t legRemainingMs = 0; // Fade time left in the current leg
+        uint32_t legHoldMs = 0;      // Hold still to do after the fade
+        uint32_t waitUntilMs = 0;
+    };
+
+    void advance(int channel, uint32_t nowMs);
+    void startLeg(int channel, Channel& ch);
+    void continueProgram(int channel, Channel& ch, uint32_t nowMs);
+
+    Channel channels[pwmFadeMaxChannels];
+    int numChannels;
+    PwmFadeBackend backend;
+    PwmFadeStats sequencerStats;
+};
+// --- End PWM Fade Sequencer ---
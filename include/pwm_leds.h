@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+#include "pwm_fade.h"
+
+// --- PWM LED Fades ---
+// LED2-4 brightness changes, toggles and effects run on the LEDC hardware fade
+// unit. A small task owns the LEDC channels: callers post a request and return
+// at once, and the task starts the next fade segment when the hardware reports
+// the previous one done. A breathing or blinking LED costs one short wakeup per
+// segment or hold, and nothing in loop().
+
+struct PwmLedStats {
+    PwmFadeStats sequencer;
+    uint32_t fadeEndEvents = 0; // Fade-end interrupts received
+    uint32_t wakeups = 0;       // Times the fade task ran
+};
+
+// Install the LEDC fade service on already configured channels (ledcSetup/ledcAttachPin)
+void pwmLedsBegin(const int* ledcChannels, int numLeds);
+// Fade LED `index` to a duty over fadeMs (0 = at once); cancels any effect
+void pwmLedsFadeTo(int index, uint8_t duty, uint32_t fadeMs);
+// Loop an effect at a brightness until the next request
+void pwmLedsPlay(int index, PwmEffect effect, uint8_t brightness);
+// Stop sending fade commands so the channels can be written directly (ledcWrite);
+// waits for a running segment to end, false if it didn't in time
+bool pwmLedsPause();
+// Take the channels back, starting from the duty they were left at
+void pwmLedsResume();
+// Counters since boot
+PwmLedStats pwmLedsStats();
+// --- End PWM LED Fades ---
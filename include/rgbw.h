@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+#include <FastLED.h>
+
+// --- RGB to RGBW White Extraction ---
+// Patterns render plain RGB; for RGBW strips the common white part of each
+// pixel is moved to the W channel at output time. The W LED is not pure
+// white, so the extraction is done relative to its white point: W at level w
+// emits what RGB would at (w * wp.r / 255, w * wp.g / 255, w * wp.b / 255).
+// Both directions are precomputed as 256-entry tables per channel, so a
+// pixel costs six table lookups, two mins and three subtractions.
+
+#ifndef RGBW_WHITE_POINT // RGB equivalent of the W LED at full level, 0xRRGGBB
+  #define RGBW_WHITE_POINT 0xFFE4C8 // Neutral white (~4500K) SK6812 parts
+#endif
+
+// Bytes per RGBW pixel on the wire, and CRGB entries needed to hold n of them
+const int rgbwBytesPerPixel = 4;
+inline int rgbwWireLength(int n) { return (n * rgbwBytesPerPixel + 2) / 3; }
+
+// Rebuild the tables for a W LED with the given RGB equivalent (normalized to a 255 peak)
+void rgbwSetWhitePoint(CRGB whitePoint);
+CRGB rgbwWhitePoint();
+
+// Convert n RGB pixels into n GRBW byte quads (SK6812 RGBW wire order)
+void rgbwConvert(const CRGB* src, uint8_t* dst, int n);
+
+// Single-pixel form of rgbwConvert(), returning the channel values (w in the 4th slot)
+void rgbwExtract(const CRGB& in, uint8_t out[4]);
+
+// RGB color that converts to W at this level with (almost) no RGB residue
+CRGB rgbwWhiteColor(uint8_t level);
+// --- End RGB to RGBW White Extraction ---
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "board_drivers.h"
+
+// --- Board Self-Test ---
+// Runs every hardware check the board has back to back and prints one line per
+// step plus a summary, all as "SELFTEST <KIND> key=value ..." lines for bench scripts.
+
+struct SelfTestContext {
+    LightMeter& lightMeter;    // Stand-ins on boards without the part
+    CurrentSensor& ina219;
+    float (*readCurrentMa)();  // Strip current from a fresh INA219 conversion (nullptr without one)
+    const int* pwmChannels;    // LEDC channels of the PWM LEDs
+    int numPwmChannels;
+    bool pwmChannelsFree;      // The fade task let go of the channels (pwmLedsPause())
+    int numLeds;               // Pixels on the wire while the test runs
+};
+
+// Returns true if every step passed
+bool runSelfTest(const SelfTestContext& ctx);
+// --- End Board Self-Test ---
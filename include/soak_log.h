@@ -0,0 +1,137 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// --- Soak Log ---
+// Long unattended runs log one sample of the supply and the strip every
+// SOAK_LOG_INTERVAL_MS to flash, so nothing needs to be attached overnight.
+// Records are 16 bytes and live in a ring of preallocated segment files on
+// LittleFS, one flash block each. LittleFS copies a block on every change and
+// also rewrites every later block of the same file, so one big ring file
+// would rewrite its whole tail per write. With a block per file, a batch
+// costs one block copy plus a metadata commit.
+// The loop only appends to a RAM batch; a background task writes each full
+// batch (SOAK_LOG_BATCH_RECORDS, whole 256-byte pages) into the ring.
+// Segments fill in order, so after a reboot the ring resumes behind the
+// newest record. A dump prints the records oldest first as hex
+// "SOAK DATA" lines; tools/soak_log_csv.cpp turns them into CSV.
+
+#ifndef SOAK_LOG_INTERVAL_MS // Time between two records
+  #define SOAK_LOG_INTERVAL_MS 2000
+#endif
+
+#ifndef SOAK_LOG_SEGMENTS // Segment files in the ring; 256 x 4 KB holds 36 h at 2 s
+  #define SOAK_LOG_SEGMENTS 256
+#endif
+
+#ifndef SOAK_LOG_SEGMENT_BYTES // One LittleFS block
+  #define SOAK_LOG_SEGMENT_BYTES 4096
+#endif
+
+#ifndef SOAK_LOG_BATCH_RECORDS // Records per flash write, a multiple of 16 (one 256-byte page); lost on power cut at most
+  #define SOAK_LOG_BATCH_RECORDS 64
+#endif
+
+#ifndef SOAK_LOG_DUMP_BAUD // Console baud while dumping, 0 = keep the current one
+  #define SOAK_LOG_DUMP_BAUD 921600
+#endif
+
+const int soakRecordSize = 16;
+const int soakRecordsPerSegment = SOAK_LOG_SEGMENT_BYTES / soakRecordSize;
+const int soakRecordsPerBatch = SOAK_LOG_BATCH_RECORDS;
+const uint32_t soakRingSlots = (uint32_t)SOAK_LOG_SEGMENTS * soakRecordsPerSegment;
+const int soakDumpRecordsPerLine = 8;
+const uint16_t soakLuxNone = 0xFFFF;         // No light sensor reading
+const uint32_t soakEmptySequence = 0xFFFFFFFF; // Erased slot: all bytes 0xFF
+
+static_assert(SOAK_LOG_BATCH_RECORDS % 16 == 0, "soak log batches are whole 256-byte pages");
+static_assert(soakRecordsPerSegment % SOAK_LOG_BATCH_RECORDS == 0, "soak log batches must not cross a segment");
+
+// Wire format, little-endian: sequence[4] timeMs[4] busMv[2] currentMa[2] lux[2] pattern brightness
+struct SoakRecord {
+    uint32_t sequence = 0;  // Counts up across reboots
+    uint32_t timeMs = 0;    // millis() when sampled; drops back at a reboot
+    uint16_t busMv = 0;
+    int16_t currentMa = 0;
+    uint16_t lux = soakLuxNone;
+    uint8_t pattern = 0;
+    uint8_t brightness = 0; // 0 while the strip is off
+};
+
+// Where the ring continues after a reboot
+struct SoakResume {
+    uint32_t slot;          // Ring slot for the next batch (segment * soakRecordsPerSegment + index)
+    uint32_t sequence;      // Sequence number for the next record
+};
+
+void soakRecordEncode(const SoakRecord& record, uint8_t* out);
+// False for an empty slot
+bool soakRecordDecode(const uint8_t* in, SoakRecord& record);
+
+// Segment written last, from the first record of every segment (segments * soakRecordSize bytes); -1 if all are empty
+int soakLogNewestSegment(const uint8_t* firstRecords, int segments);
+// Resume point from the newest segment's contents (soakRecordsPerSegment records)
+SoakResume soakLogResume(int newestSegment, const uint8_t* segmentData);
+
+// "SOAK DATA <hex>" for up to soakDumpRecordsPerLine records
+void soakDumpFormatLine(char* out, size_t size, const uint8_t* records, int count);
+// Records in a "SOAK DATA" line, or -1 if the line isn't one or is malformed
+int soakDumpParseLine(const char* line, uint8_t* records, int maxRecords);
+uint32_t soakCrc32(uint32_t crc, const uint8_t* data, size_t length);
+
+// Turns ring slots, oldest first, into "SOAK DATA" lines and a closing
+// "SOAK DUMP END records=N crc32=X" line (CRC over the record bytes sent)
+class SoakDumpWriter {
+public:
+    typedef void (*LineSink)(const char* line, void* context);
+    SoakDumpWriter(LineSink sink, void* context) : sink(sink), context(context) {}
+    // Empty slots and batch padding are skipped
+    void addSlots(const uint8_t* slots, int count);
+    void finish();
+    uint32_t records() const { return sent; }
+
+private:
+    void emitLine();
+
+    LineSink sink;
+    void* context;
+    uint8_t lineRecords[soakDumpRecordsPerLine * soakRecordSize];
+    int lineCount = 0;
+    uint32_t sent = 0;
+    uint32_t crc = 0;
+};
+
+// Flash bytes programmed for one batch: the segment's block copy plus a metadata commit
+uint32_t soakLogFlashBytesPerBatch();
+// Days until the partition's blocks reach their rated erase cycles at one record per intervalMs
+uint32_t soakLogFlashLifetimeDays(uint32_t partitionBytes, uint32_t intervalMs);
+
+// --- Device side (LittleFS) ---
+struct SoakLogStats {
+    uint32_t appended = 0;      // Records put into a batch
+    uint32_t dropped = 0;       // Records lost because the writer was still busy with both batches
+    uint32_t batches = 0;       // Batches written to flash
+    uint32_t writeErrors = 0;
+    uint64_t appendUsTotal = 0; // Loop time per record: sensor reads plus append
+    uint32_t appendUsMax = 0;
+    uint64_t flushUsTotal = 0;  // Writer task time per batch (open, seek, write, close)
+    uint32_t flushUsMax = 0;
+};
+
+// Start the writer task. With enabled, it mounts LittleFS, preallocates the ring and finds where it left off.
+void soakLogBegin(bool enabled);
+void soakLogSetEnabled(bool enabled);
+bool soakLogEnabled();
+// The ring is mounted and records are accepted
+bool soakLogReady();
+// Add a record; sampleUs is what gathering its values cost the caller
+void soakLogAppend(SoakRecord& record, uint32_t sampleUs);
+// Write out the partial batch now
+void soakLogFlush();
+// Print every record, oldest first, between "SOAK DUMP BEGIN" and "SOAK DUMP END" lines
+void soakLogDump();
+SoakLogStats soakLogStats();
+// One "SOAK STATS ..." line with the costs and the modelled write amplification
+void soakLogPrintStats();
+// --- End Soak Log ---
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Arduino.h>
+#include "anim_sync.h"
+
+// --- Sync Link ---
+// Runs the animation sync protocol (anim_sync.h) on Serial2, using the board's
+// sync port pins. Wire each unit's TX to the next unit's RX; the first unit in
+// the chain is the leader. loop() is woken once per received beacon.
+
+#ifndef SYNC_RX_TIMEOUT_SYMBOLS // Idle time after a beacon before the receive callback fires
+  #define SYNC_RX_TIMEOUT_SYMBOLS 2
+#endif
+
+// Open the port and start in a role; loopTask is notified when a beacon arrives
+void syncLinkBegin(SyncRole role, TaskHandle_t loopTask);
+void syncLinkSetRole(SyncRole role);
+SyncRole syncLinkRole();
+// Handle received beacons and send the one that is due, if any; call from loop()
+void syncLinkService(const SyncPatternState& localState);
+// Milliseconds until syncLinkService() has a beacon to send (maxMs if none)
+unsigned long syncLinkMsUntilDue(unsigned long maxMs);
+// Pattern clock: leader time in ms while following, else millis()
+uint32_t syncLinkClockMs();
+// Pattern the leader last announced; false unless following
+bool syncLinkLeaderState(SyncPatternState& state);
+// Protocol and clock counters; the error peak restarts with every call
+void syncLinkStats(SyncNodeStats& node, SyncClockStats& clock, bool& following);
+// --- End Sync Link ---
@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""Run the kernel benchmarks ('k') on a board, or read a captured log, and compare
+the BENCH JSON line against scripts/bench_baseline.json.
+
+Prints one row per kernel and LED count with the baseline, the new time and the
+change, and exits 1 if any row is slower than its tolerance allows, if a
+baselined row is missing from the run, or if the board has no baseline at all
+(a run with nothing to compare against is not a pass).
+
+  scripts/bench_compare.py --port /dev/ttyUSB0          # sends 'k' and waits for BENCH END
+  scripts/bench_compare.py --log capture.txt            # or - for stdin
+  scripts/bench_compare.py --port /dev/ttyUSB0 --update # record the run as the board's baseline
+  pio test -e native -v | scripts/bench_compare.py --log -  # the same kernels built for the host, board "Host"
+
+--port needs pyserial, which PlatformIO already installs.
+"""
+
+import argparse
+import fnmatch
+import json
+import os
+import sys
+import time
+
+DEFAULT_BASELINE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "bench_baseline.json")
+RUN_TIMEOUT_S = 120  # The 4000 LED pass takes a few seconds; boot and menu noise come first
+
+
+def read_port(port, baud):
+    import serial  # Only needed for live runs
+
+    lines = []
+    with serial.Serial(port, baud, timeout=1) as link:
+        time.sleep(0.5)
+        link.reset_input_buffer()
+        link.write(b"k")
+        deadline = time.monotonic() + RUN_TIMEOUT_S
+        while time.monotonic() < deadline:
+            line = link.readline().decode("utf-8", "replace").rstrip()
+            if not line:
+                continue
+            lines.append(line)
+            if line.startswith("BENCH "):
+                print(line, file=sys.stderr)
+            if line == "BENCH END":
+                return lines
+    sys.exit(f"no BENCH END from {port} within {RUN_TIMEOUT_S} s")
+
+
+def read_log(path):
+    stream = sys.stdin if path == "-" else open(path, encoding="utf-8", errors="replace")
+    with stream:
+        return [line.rstrip() for line in stream]
+
+
+def parse_run(lines):
+    """Last BENCH JSON document in the output."""
+    runs = [line[len("BENCH JSON "):] for line in lines if line.startswith("BENCH JSON ")]
+    if not runs:
+        sys.exit("no BENCH JSON line in the output")
+    return json.loads(runs[-1])
+
+
+def tolerance_for(tolerances, name):
+    for tolerance in tolerances:
+        if fnmatch.fnmatchcase(name, tolerance["match"]):
+            return tolerance
+    return {"percent": 10, "floor_ns": 0}
+
+
+def row_key(name, leds):
+    return f"{name}@{leds}"
+
+
+def compare(baseline, run):
+    board = run["board"]
+    rows = baseline["boards"].get(board)
+    if not rows:
+        print(f"!!! no baseline for board {board}; record one with --update")
+        return 1
+
+    measured = {row_key(r["name"], r["leds"]): r["ns_per_frame"] for r in run["results"]}
+    keys = list(rows) + [key for key in measured if key not in rows]
+    failed = 0
+    print(f"board={board} cpu_mhz={run.get('cpu_mhz')}")
+    print(f"{'kernel':<32} {'leds':>5} {'base_ns':>10} {'new_ns':>10} {'change':>8} {'limit':>8}  result")
+    for key in keys:
+        name, leds = key.rsplit("@", 1)
+        base = rows.get(key)
+        new = measured.get(key)
+        tolerance = tolerance_for(baseline["tolerances"], name)
+        if base is None:
+            status, change, limit = "NEW", "", ""
+        elif new is None:
+            status, change, limit = "MISSING", "", ""
+            failed += 1
+        else:
+            allowed = max(base * tolerance["percent"] / 100, tolerance["floor_ns"])
+            change = f"{(new - base) * 100 / base:+.1f}%" if base else ""
+            limit = f"+{tolerance['percent']}%"
+            if new - base > allowed:
+                status = "SLOWER"
+                failed += 1
+            elif base - new > allowed:
+                status = "faster"  # Worth refreshing the baseline so the gain is kept
+            else:
+                status = "ok"
+        print(f"{name:<32} {leds:>5} {base if base is not None else '-':>10} {new if new is not None else '-':>10} "
+              f"{change:>8} {limit:>8}  {status}")
+    print(f"{failed} regression(s)" if failed else "no regressions")
+    return 1 if failed else 0
+
+
+def update(baseline, run, path):
+    rows = {row_key(r["name"], r["leds"]): r["ns_per_frame"] for r in run["results"]}
+    baseline["boards"][run["board"]] = rows
+    with open(path, "w", encoding="utf-8") as out:
+        json.dump(baseline, out, indent=2)
+        out.write("\n")
+    print(f"recorded {len(rows)} rows for board {run['board']} in {path}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="serial port of the board")
+    source.add_argument("--log", help="captured serial output, - for stdin")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--baseline", default=DEFAULT_BASELINE)
+    parser.add_argument("--update", action="store_true", help="write this run as the board's baseline")
+    args = parser.parse_args()
+
+    lines = read_port(args.port, args.baud) if args.port else read_log(args.log)
+    run = parse_run(lines)
+    with open(args.baseline, encoding="utf-8") as f:
+        baseline = json.load(f)
+
+    if args.update:
+        update(baseline, run, args.baseline)
+        return 0
+    return compare(baseline, run)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,34 @@
+#!/usr/bin/env bash
+# Build every board env and print a size table, CI style: exits non-zero if any
+# env fails to build. Usage: scripts/build_boards.sh [env ...] (default: all boards)
+set -u
+
+cd "$(dirname "$0")/.."
+
+ENVS=("$@")
+if [ ${#ENVS[@]} -eq 0 ]; then
+    ENVS=(knob miniclock)
+fi
+
+SIZE_TOOL="${SIZE_TOOL:-$HOME/.platformio/packages/toolchain-xtensa-esp32/bin/xtensa-esp32-elf-size}"
+failed=0
+report=""
+
+for env in "${ENVS[@]}"; do
+    echo "=== Building $env ==="
+    if ! pio run -e "$env"; then
+        echo "!!! $env failed to build"
+        report+=$(printf "%-12s %10s %10s %10s %10s" "$env" "FAILED" "-" "-" "-")$'\n'
+        failed=1
+        continue
+    fi
+    elf=".pio/build/$env/firmware.elf"
+    # Berkeley format: text data bss dec hex filename
+    read -r text data bss _ < <("$SIZE_TOOL" -B "$elf" | tail -n 1)
+    report+=$(printf "%-12s %10s %10s %10s %10s" "$env" "ok" "$text" "$data" "$bss")$'\n'
+done
+
+echo
+printf "%-12s %10s %10s %10s %10s\n" "env" "result" "text" "data" "bss"
+printf "%s" "$report"
+exit $failed
@@ -0,0 +1,34 @@
+#!/usr/bin/env bash
+# Build the encoder acceleration curves for the host and run them on synthetic
+# rotation traces: speed readings, slow single-unit steps, random traces and
+# the time a turning model needs to reach every value. It runs once with the
+# firmware's speed thresholds and once with a shorter window and lower
+# thresholds. Exits non-zero if a check fails or a value takes longer than the
+# budget.
+# Usage: scripts/encoder_accel_traces.sh [budget_ms]   (default: 4000)
+set -u
+
+cd "$(dirname "$0")/.."
+
+BUDGET_MS=${1:-4000}
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# name: extra build flags
+SETTINGS=(
+    "firmware:"
+    "twitchy: -DENCODER_VELOCITY_WINDOW_MS=150 -DENCODER_MEDIUM_FROM_SPS=14 -DENCODER_FAST_FROM_SPS=30"
+)
+
+failed=0
+for setting in "${SETTINGS[@]}"; do
+    name=${setting%%:*}
+    flags=${setting#*:}
+    # shellcheck disable=SC2086
+    g++ -std=gnu++17 -O2 -Wall -Iinclude $flags src/encoder_accel.cpp tools/encoder_accel_trace.cpp \
+        -o "$work/encoder_accel_trace_$name" || exit 1
+    echo "--- $name"
+    "$work/encoder_accel_trace_$name" --budget-ms "$BUDGET_MS" || failed=1
+done
+exit $failed
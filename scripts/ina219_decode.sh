@@ -0,0 +1,15 @@
+#!/usr/bin/env bash
+# Build the INA219 register math for the host and run it on the register
+# dumps in tools/golden/ina219_registers.txt: calibration values, profile
+# configurations, the conversion-ready and overflow flags, and currents and
+# powers, including negative shunt readings. Exits non-zero on any mismatch.
+# Usage: scripts/ina219_decode.sh [dump file]
+set -u
+
+cd "$(dirname "$0")/.."
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+g++ -std=gnu++17 -O2 -Wall -Iinclude src/ina219_decode.cpp tools/ina219_decode.cpp -o "$work/ina219_decode" || exit 1
+"$work/ina219_decode" "${1:-tools/golden/ina219_registers.txt}"
@@ -0,0 +1,32 @@
+#!/usr/bin/env bash
+# Build the LED count search for the host and run it against a simulated
+# strip: per-pixel draw, an INA219 model in the probe profile and the first
+# dead pixel at many positions. It runs once at typical noise and once with
+# three times the supply ripple. Exits non-zero if a length comes out wrong
+# or a search takes more than ceil(log2(n+1)) measurements.
+# Usage: scripts/led_count_detect.sh [random_cases]   (default: 1000)
+set -u
+
+cd "$(dirname "$0")/.."
+
+RANDOM_CASES=${1:-1000}
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+g++ -std=gnu++17 -O2 -Wall -Iinclude src/led_count_detect.cpp src/ina219_decode.cpp tools/led_count_detect.cpp \
+    -o "$work/led_count_detect" || exit 1
+
+# name: arguments
+NOISE=(
+    "typical: --adc-noise-uv 10 --ripple-ma 2"
+    "ripple: --adc-noise-uv 10 --ripple-ma 6"
+)
+
+failed=0
+for noise in "${NOISE[@]}"; do
+    echo "--- ${noise%%:*}"
+    # shellcheck disable=SC2086
+    "$work/led_count_detect" ${noise#*:} --random "$RANDOM_CASES" || failed=1
+done
+exit $failed
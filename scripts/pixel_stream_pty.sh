@@ -0,0 +1,86 @@
+#!/usr/bin/env bash
+# Stream Adalight frames through a pty into a host-built node running the
+# firmware's parser (Linux), twice. The clean run sends as fast as the pty
+# takes frames. The node must reach MIN_FPS_PERCENT of the frame rate its
+# modelled strip allows, with every frame intact and no error counted. The
+# injected run swaps some frames for bad headers, stalls and oversize frames,
+# at half the strip's frame rate so no backlog hides a stall. The node's
+# counters must match what was injected.
+# Usage: scripts/pixel_stream_pty.sh [leds] [seconds] [segments]   (default: 1000 LEDs, 5 s, 1 pin)
+set -u
+
+cd "$(dirname "$0")/.."
+
+LEDS=${1:-1000}
+RUN_SECONDS=${2:-5}
+SEGMENTS=${3:-1}
+MIN_FPS_PERCENT=${MIN_FPS_PERCENT:-95}
+
+work=$(mktemp -d)
+trap 'kill $(jobs -p) 2>/dev/null; rm -rf "$work"' EXIT
+
+g++ -std=gnu++17 -O2 -Wall -Iinclude src/pixel_stream.cpp src/led_segments.cpp tools/pixel_stream.cpp \
+    -o "$work/pixel_stream" || exit 1
+
+# Wait for the node to print its pty
+port_path() {
+    for _ in $(seq 50); do
+        path=$(sed -n 's/^PORT //p' "$1")
+        if [ -n "$path" ]; then echo "$path"; return 0; fi
+        sleep 0.1
+    done
+    return 1
+}
+
+# field NAME LINE
+field() {
+    sed -n "s/.* $1=\([0-9.]*\).*/\1/p" <<< "$2"
+}
+
+# run NAME [send options...]: stream into a fresh node, leave its STREAM END line in $work/NAME.end
+run() {
+    local name=$1
+    shift
+    "$work/pixel_stream" node --leds "$LEDS" --segments "$SEGMENTS" --idle-ms 1000 > "$work/$name.node" &
+    local node=$!
+    local port
+    port=$(port_path "$work/$name.node") || { echo "$name: node did not start"; return 1; }
+    "$work/pixel_stream" send --port "$port" --leds "$LEDS" --seconds "$RUN_SECONDS" "$@" > "$work/$name.send"
+    wait $node
+    grep '^SEND ' "$work/$name.send"
+    grep '^STREAM END' "$work/$name.node" | tee "$work/$name.end"
+}
+
+failed=0
+
+run clean || exit 1
+end=$(cat "$work/clean.end")
+max_fps=$(field max_fps "$(grep '^NODE ' "$work/clean.node")")
+fps=$(field fps "$end")
+if [ -z "$fps" ] || awk -v fps="$fps" -v max="$max_fps" -v pct="$MIN_FPS_PERCENT" 'BEGIN { exit !(fps * 100 < max * pct) }'; then
+    echo "!!! clean: ${fps:-no} fps, wire allows $max_fps"
+    failed=1
+fi
+for counter in bad_headers oversize timeouts skipped_bytes content_errors; do
+    if [ "$(field $counter "$end")" != "0" ]; then
+        echo "!!! clean: $counter=$(field $counter "$end")"
+        failed=1
+    fi
+done
+
+run injected --fps "$(awk -v max="$max_fps" 'BEGIN { print max / 2 }')" --bad-header-every 7 --stall-every 23 --oversize-every 31 || exit 1
+end=$(cat "$work/injected.end")
+sent=$(grep '^SEND ' "$work/injected.send")
+for pair in frames:frames bad_headers:bad_headers timeouts:stalls oversize:oversize; do
+    counter=${pair%%:*}
+    injected=${pair#*:}
+    if [ "$(field "$counter" "$end")" != "$(field "$injected" "$sent")" ]; then
+        echo "!!! injected: $counter=$(field "$counter" "$end"), sent $injected=$(field "$injected" "$sent")"
+        failed=1
+    fi
+done
+if [ "$(field content_errors "$end")" != "0" ]; then
+    echo "!!! injected: content_errors=$(field content_errors "$end")"
+    failed=1
+fi
+exit $failed
@@ -0,0 +1,15 @@
+#!/usr/bin/env bash
+# Build the PWM fade sequencer for the host and run it against a recording
+# backend. Checks the exact fade commands for a brightness change, an on/off
+# toggle, breathing and blinking, and that unchanged requests send nothing.
+# Exits non-zero if any command sequence differs.
+# Usage: scripts/pwm_fade_sequence.sh [--verbose]
+set -u
+
+cd "$(dirname "$0")/.."
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+g++ -std=gnu++17 -O2 -Wall -Iinclude src/pwm_fade.cpp tools/pwm_fade_sequence.cpp -o "$work/pwm_fade_sequence" || exit 1
+"$work/pwm_fade_sequence" "$@"
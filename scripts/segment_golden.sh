@@ -0,0 +1,52 @@
+#!/usr/bin/env bash
+# Build tools/segment_waveform.cpp for the host and check the parallel segment
+# plans and waveforms against tools/golden/. Every pin's waveform must decode
+# to its own pixels, and the output must match the golden file byte for byte.
+# Exits non-zero on any difference.
+# Usage: scripts/segment_golden.sh [--update]   (--update rewrites the golden files)
+set -u
+
+cd "$(dirname "$0")/.."
+
+UPDATE=0
+if [ "${1:-}" = "--update" ]; then UPDATE=1; fi
+
+# name: arguments
+CASES=(
+    "ws2812_10x3: --leds 10 --segments 3 --chipset ws2812"
+    "sk6812_10x2: --leds 10 --segments 2 --chipset sk6812"
+    "rgbw_10x3: --leds 10 --segments 3 --chipset sk6812 --rgbw"
+    "rgbw_4x4: --leds 4 --segments 4 --chipset sk6812 --rgbw"
+    "ws2812_1000x4: --leds 1000 --segments 4 --chipset ws2812 --no-wave"
+    "rgbw_1000x4: --leds 1000 --segments 4 --chipset sk6812 --rgbw --no-wave"
+    "ws2812_4000x4: --leds 4000 --segments 4 --chipset ws2812 --no-wave"
+)
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+g++ -std=gnu++17 -O2 -Wall -Iinclude src/led_segments.cpp tools/segment_waveform.cpp -o "$work/segment_waveform" || exit 1
+mkdir -p tools/golden
+
+failed=0
+for entry in "${CASES[@]}"; do
+    name=${entry%%:*}
+    read -r -a args <<< "${entry#*:}"
+    golden="tools/golden/segments_$name.txt"
+    if ! "$work/segment_waveform" "${args[@]}" > "$work/$name.txt"; then
+        echo "!!! $name: a pin's waveform does not carry its pixels"
+        grep 'result=FAIL' "$work/$name.txt"
+        failed=1
+        continue
+    fi
+    if [ "$UPDATE" = 1 ]; then
+        cp "$work/$name.txt" "$golden"
+        echo "updated $golden"
+    elif ! diff -u "$golden" "$work/$name.txt"; then
+        echo "!!! $name differs from $golden"
+        failed=1
+    else
+        echo "ok $name"
+    fi
+done
+exit $failed
@@ -0,0 +1,54 @@
+#!/usr/bin/env bash
+# Chain a host-built sync leader and N followers through ptys (Linux) and print
+# each follower's last report. Followers get different crystal errors and start
+# offsets, so the offset and drift estimates are both exercised. Exits non-zero
+# if a follower is unlocked or its true error exceeds MAX_ERROR_US.
+# Usage: scripts/sync_pty_chain.sh [followers] [seconds]   (default: 3 followers, 30 s)
+set -u
+
+cd "$(dirname "$0")/.."
+
+FOLLOWERS=${1:-3}
+RUN_SECONDS=${2:-30}
+MAX_ERROR_US=${MAX_ERROR_US:-1000}
+PPMS=(40 -35 80 -60 20)
+OFFSETS_MS=(2500 -1200 700 4000 -300)
+
+work=$(mktemp -d)
+trap 'kill $(jobs -p) 2>/dev/null; rm -rf "$work"' EXIT
+
+g++ -std=gnu++17 -O2 -Wall -Iinclude src/anim_sync.cpp tools/sync_node.cpp -o "$work/sync_node" || exit 1
+
+# Wait for a node to print the pty it transmits on
+tx_path() {
+    for _ in $(seq 50); do
+        path=$(sed -n 's/^TX //p' "$1")
+        if [ -n "$path" ]; then echo "$path"; return 0; fi
+        sleep 0.1
+    done
+    return 1
+}
+
+"$work/sync_node" --name leader --leader --seconds "$((RUN_SECONDS + 2))" > "$work/leader.log" &
+upstream=$(tx_path "$work/leader.log") || { echo "leader did not start"; exit 1; }
+
+for i in $(seq 1 "$FOLLOWERS"); do
+    k=$(( (i - 1) % ${#PPMS[@]} ))
+    "$work/sync_node" --name "f$i" --rx "$upstream" --ppm "${PPMS[$k]}" --offset-ms "${OFFSETS_MS[$k]}" \
+        --seconds "$RUN_SECONDS" > "$work/f$i.log" &
+    upstream=$(tx_path "$work/f$i.log") || { echo "f$i did not start"; exit 1; }
+done
+
+wait
+
+failed=0
+for i in $(seq 1 "$FOLLOWERS"); do
+    last=$(grep '^SYNC ' "$work/f$i.log" | tail -n 1)
+    echo "$last"
+    error=$(sed -n 's/.*true_error_us=\(-\?[0-9]*\).*/\1/p' <<< "$last")
+    if ! grep -q 'locked=1' <<< "$last" || [ -z "$error" ] || [ "${error#-}" -gt "$MAX_ERROR_US" ]; then
+        echo "!!! f$i not in sync"
+        failed=1
+    fi
+done
+exit $failed
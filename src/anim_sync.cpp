@@ -0,0 +1,229 @@
+#include "anim_sync.h"
+
+const char* const syncRoleNames[NUM_SYNC_ROLES] = {"Off", "Leader", "Follower"};
+
+const uint8_t syncMagic0 = 0xA5;
+const uint8_t syncMagic1 = 0x5A;
+
+// CRC-8, polynomial 0x07, over everything between the magic and the CRC byte
+static uint8_t crc8(const uint8_t* data, size_t length) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static void putLe(uint8_t* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) { out[i] = (uint8_t)(value >> (8 * i)); }
+}
+
+static uint64_t getLe(const uint8_t* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) { value |= (uint64_t)in[i] << (8 * i); }
+    return value;
+}
+
+void encodeSyncBeacon(const SyncBeacon& beacon, uint8_t* out) {
+    out[0] = syncMagic0;
+    out[1] = syncMagic1;
+    out[2] = beacon.seq;
+    out[3] = beacon.hops;
+    putLe(out + 4, beacon.leaderUs, 6);
+    out[10] = beacon.pattern;
+    putLe(out + 11, beacon.patternEpochMs, 4);
+    out[15] = crc8(out + 2, syncBeaconSize - 3);
+}
+
+uint32_t syncWireTimeUs(uint32_t baud) {
+    return (uint32_t)(syncBeaconSize * 10 * 1000000ULL / baud); // Start + 8 data + stop bits
+}
+
+bool SyncBeaconParser::push(uint8_t byte, SyncBeacon& beacon) {
+    if (length == 0 && byte != syncMagic0) return false;
+    if (length == 1 && byte != syncMagic1) {
+        length = byte == syncMagic0 ? 1 : 0;
+        return false;
+    }
+    frame[length++] = byte;
+    if (length < syncBeaconSize) return false;
+
+    length = 0;
+    if (crc8(frame + 2, syncBeaconSize - 3) != frame[15]) {
+        badFrames++;
+        return false;
+    }
+    beacon.seq = frame[2];
+    beacon.hops = frame[3];
+    beacon.leaderUs = getLe(frame + 4, 6);
+    beacon.pattern = frame[10];
+    beacon.patternEpochMs = (uint32_t)getLe(frame + 11, 4);
+    return true;
+}
+
+// --- Clock Estimate ---
+void SyncClock::reset() {
+    SyncClockStats kept = clockStats;
+    *this = SyncClock();
+    clockStats.samples = kept.samples;
+    clockStats.outliers = kept.outliers;
+    clockStats.steps = kept.steps;
+}
+
+int64_t SyncClock::predictedOffsetUs(uint64_t localUs) const {
+    int64_t sinceModelUs = (int64_t)(localUs - modelLocalUs);
+    return modelOffsetUs + sinceModelUs * driftPpb / 1000000000LL;
+}
+
+uint64_t SyncClock::leaderTimeUs(uint64_t localUs) const {
+    return localUs + predictedOffsetUs(localUs);
+}
+
+void SyncClock::addSample(uint64_t localUs, uint64_t leaderUs) {
+    clockStats.samples++;
+    int64_t offsetUs = (int64_t)(leaderUs - localUs);
+
+    if (locked()) {
+        int64_t errorUs = offsetUs - predictedOffsetUs(localUs);
+        if (errorUs > syncStepThresholdUs || errorUs < -syncStepThresholdUs) {
+            clockStats.outliers++;
+            if (++consecutiveOutliers < syncStepOutliers) return;
+            // Not a late beacon but a new clock: start over from this sample
+            clockStats.steps++;
+            reset();
+        } else {
+            consecutiveOutliers = 0;
+        }
+    }
+
+    if (windowCount == 0 || offsetUs > windowBestOffsetUs) {
+        windowBestOffsetUs = offsetUs;
+        windowBestLocalUs = localUs;
+    }
+    // The first sample locks at once; later points come from full windows
+    if (++windowCount >= syncFilterWindow || !locked()) {
+        addPoint(windowBestLocalUs, windowBestOffsetUs);
+        windowCount = 0;
+    }
+}
+
+// Least-squares line through the kept points, anchored at the newest one
+void SyncClock::addPoint(uint64_t localUs, int64_t offsetUs) {
+    if (locked()) {
+        int64_t errorUs = offsetUs - predictedOffsetUs(localUs);
+        clockStats.lastErrorUs = (int32_t)errorUs;
+        int32_t magnitude = errorUs < 0 ? (int32_t)-errorUs : (int32_t)errorUs;
+        if (magnitude > clockStats.worstErrorUs) { clockStats.worstErrorUs = magnitude; }
+    }
+
+    pointLocalUs[nextPoint] = localUs;
+    pointOffsetUs[nextPoint] = offsetUs;
+    nextPoint = (nextPoint + 1) % syncFitPoints;
+    if (numPoints < syncFitPoints) { numPoints++; }
+
+    if (numPoints >= 2) {
+        // Relative to the newest point so the sums stay small
+        double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+        for (int i = 0; i < numPoints; i++) {
+            double x = (double)(int64_t)(pointLocalUs[i] - localUs);
+            double y = (double)(pointOffsetUs[i] - offsetUs);
+            sumX += x; sumY += y; sumXX += x * x; sumXY += x * y;
+        }
+        double denominator = numPoints * sumXX - sumX * sumX;
+        if (denominator > 0) {
+            double slope = (numPoints * sumXY - sumX * sumY) / denominator;
+            double intercept = (sumY - slope * sumX) / numPoints;
+            double ppb = slope * 1e9;
+            if (ppb > syncMaxDriftPpb) { ppb = syncMaxDriftPpb; }
+            if (ppb < -syncMaxDriftPpb) { ppb = -syncMaxDriftPpb; }
+            driftPpb = (int32_t)ppb;
+            offsetUs += (int64_t)intercept;
+        }
+    }
+    modelLocalUs = localUs;
+    modelOffsetUs = offsetUs;
+    clockStats.offsetUs = modelOffsetUs;
+    clockStats.driftPpb = driftPpb;
+}
+// --- End Clock Estimate ---
+
+// --- Sync Node ---
+void SyncNode::setRole(SyncRole newRole) {
+    if (newRole == currentRole) return;
+    currentRole = newRole;
+    syncClock.reset();
+    haveLeaderState = false;
+    forwardPending = false;
+    nextSendUs = 0;
+}
+
+void SyncNode::receive(const uint8_t* data, size_t length, uint64_t rxLocalUs) {
+    SyncBeacon beacon;
+    for (size_t i = 0; i < length; i++) {
+        if (!parser.push(data[i], beacon)) continue;
+        if (currentRole != SYNC_ROLE_FOLLOWER) continue; // A leader ignores what comes back
+        if (beacon.hops >= syncMaxHops) { nodeStats.tooFar++; continue; }
+        nodeStats.received++;
+        nodeStats.hops = beacon.hops + 1;
+        // Beacons queued behind this one arrived earlier, but only the end of the burst is known;
+        // they just look late and lose in the filter
+        syncClock.addSample(rxLocalUs - linkDelayUs, beacon.leaderUs);
+        lastBeacon = beacon;
+        haveLeaderState = true;
+        forwardPending = true;
+    }
+}
+
+size_t SyncNode::poll(uint64_t localUs, const SyncPatternState& localState, uint8_t* out) {
+    SyncBeacon beacon;
+    if (currentRole == SYNC_ROLE_LEADER) {
+        if (nextSendUs != 0 && (int64_t)(localUs - nextSendUs) < 0) return 0;
+        // Keep the cadence, but don't burst to catch up after a stall
+        nextSendUs = (nextSendUs != 0 && localUs - nextSendUs < SYNC_BEACON_INTERVAL_MS * 1000ULL)
+                         ? nextSendUs + SYNC_BEACON_INTERVAL_MS * 1000ULL
+                         : localUs + SYNC_BEACON_INTERVAL_MS * 1000ULL;
+        beacon.seq = nextSeq++;
+        beacon.hops = 0;
+        beacon.leaderUs = localUs;
+        beacon.pattern = localState.pattern;
+        beacon.patternEpochMs = localState.epochMs;
+    } else if (currentRole == SYNC_ROLE_FOLLOWER && forwardPending && syncClock.locked()) {
+        forwardPending = false;
+        beacon = lastBeacon;
+        beacon.hops++;
+        beacon.leaderUs = syncClock.leaderTimeUs(localUs);
+    } else {
+        return 0;
+    }
+    encodeSyncBeacon(beacon, out);
+    nodeStats.sent++;
+    return syncBeaconSize;
+}
+
+uint64_t SyncNode::usUntilDue(uint64_t localUs) const {
+    if (currentRole == SYNC_ROLE_FOLLOWER && forwardPending) return 0;
+    if (currentRole != SYNC_ROLE_LEADER) return UINT64_MAX;
+    if (nextSendUs == 0 || (int64_t)(localUs - nextSendUs) >= 0) return 0;
+    return nextSendUs - localUs;
+}
+
+uint64_t SyncNode::sharedTimeUs(uint64_t localUs) const {
+    return following() ? syncClock.leaderTimeUs(localUs) : localUs;
+}
+
+bool SyncNode::leaderState(SyncPatternState& state) const {
+    if (!following() || !haveLeaderState) return false;
+    state.pattern = lastBeacon.pattern;
+    state.epochMs = lastBeacon.patternEpochMs;
+    return true;
+}
+
+SyncNodeStats SyncNode::stats() const {
+    SyncNodeStats stats = nodeStats;
+    stats.crcErrors = parser.crcErrors();
+    return stats;
+}
+// --- End Sync Node ---
@@ -0,0 +1,219 @@
+#include "bench.h"
+#include "board.h"
+#include "led_output.h"
+#include "rgbw.h"
+#include "patterns.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "log.h"
+#define benchPrintf Serial.printf
+static uint64_t benchNowUs() { return esp_timer_get_time(); }
+static const char* benchBoardName() { return Board::name; }
+static unsigned long benchCpuMhz() { return ESP.getCpuFreqMHz(); }
+static unsigned long benchFreeHeap() { return ESP.getFreeHeap(); }
+#else
+// Host runner (test/test_bench): the same kernels, timed by the host clock
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#define benchPrintf printf
+static uint64_t benchNowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+static const char* benchBoardName() { return "Host"; }
+static unsigned long benchCpuMhz() { return 0; } // Unknown; host rows only compare on the same machine
+static unsigned long benchFreeHeap() { return 0; }
+static void logFlush() {}
+#endif
+
+const int benchLedCounts[] = {1, 60, 300, 1000, 4000};
+const int numBenchLedCounts = sizeof(benchLedCounts) / sizeof(benchLedCounts[0]);
+const uint32_t benchMinTimeUs = 20000;     // Each kernel repeats until it has run at least this long
+const uint32_t benchFrameStepMs = 10;      // Pattern time between two timed frames
+const uint8_t benchBrightness = 128;
+const int maxBenchResults = 64;
+
+// Work buffers, allocated for the largest LED count that fits and freed afterwards
+static CRGB* benchInput = nullptr;
+static CRGB* benchFrame = nullptr;
+static uint8_t* benchOutput = nullptr;
+static uint8_t* benchReference = nullptr;
+static uint8_t* benchIndices = nullptr;
+static CRGB benchPalette[paletteSize];
+
+struct BenchResult {
+    char name[32];
+    int leds;
+    uint32_t iterations;
+    uint32_t nsPerFrame;
+};
+static BenchResult benchResults[maxBenchResults];
+static int numBenchResults = 0;
+
+// Straightforward RGBW extraction with per-pixel divisions, the baseline the tables replace
+static void rgbwConvertReference(const CRGB* src, uint8_t* dst, int n) {
+    CRGB wp = rgbwWhitePoint();
+    for (int i = 0; i < n; i++) {
+        uint32_t w = 255;
+        for (int c = 0; c < 3; c++) {
+            uint32_t channelW = wp[c] > 0 ? (uint32_t)src[i][c] * 255 / wp[c] : 255;
+            if (channelW < w) w = channelW;
+        }
+        dst[0] = src[i].g - (uint8_t)(w * wp.g / 255);
+        dst[1] = src[i].r - (uint8_t)(w * wp.r / 255);
+        dst[2] = src[i].b - (uint8_t)(w * wp.b / 255);
+        dst[3] = (uint8_t)w;
+        dst += rgbwBytesPerPixel;
+    }
+}
+
+static bool allocateBuffers(int leds) {
+    benchInput = (CRGB*)malloc(sizeof(CRGB) * leds);
+    benchFrame = (CRGB*)malloc(sizeof(CRGB) * leds);
+    benchOutput = (uint8_t*)malloc(rgbwBytesPerPixel * leds);
+    benchReference = (uint8_t*)malloc(rgbwBytesPerPixel * leds);
+    benchIndices = (uint8_t*)malloc(leds);
+    return benchInput && benchFrame && benchOutput && benchReference && benchIndices;
+}
+
+static void freeBuffers() {
+    free(benchInput); free(benchFrame); free(benchOutput); free(benchReference); free(benchIndices);
+    benchInput = benchFrame = nullptr;
+    benchOutput = benchReference = benchIndices = nullptr;
+}
+
+// Saturated rainbow with every other pixel washed out, so both the W and residual paths run
+static void fillBenchInput(int leds) {
+    fill_rainbow(benchInput, leds, 0, 7);
+    for (int i = 0; i < leds; i += 2) { benchInput[i] += CRGB(96, 96, 96); }
+}
+
+// "RGB Check" -> "rgb_check", so names stay key=value and JSON friendly
+static void benchName(char* out, size_t size, const char* prefix, const char* name, const char* suffix) {
+    size_t len = snprintf(out, size, "%s", prefix);
+    for (const char* c = name; *c && len < size - 1; c++) {
+        out[len++] = *c == ' ' ? '_' : (char)tolower(*c);
+    }
+    snprintf(out + len, size - len, "%s", suffix);
+}
+
+// Run a kernel in doubling batches until benchMinTimeUs has passed, then record and print
+// its time per frame. kernel(i) gets the iteration number, for pattern time.
+template <typename Kernel>
+static uint32_t benchKernel(const char* name, int leds, Kernel kernel) {
+    kernel(0); // Warm the cache and tables
+    uint32_t iterations = 0;
+    uint32_t batch = 1;
+    uint64_t startUs = benchNowUs();
+    uint64_t elapsedUs;
+    do {
+        for (uint32_t i = 0; i < batch; i++) { kernel(iterations + i); }
+        iterations += batch;
+        batch *= 2;
+    } while ((elapsedUs = benchNowUs() - startUs) < benchMinTimeUs);
+
+    uint32_t nsPerFrame = (uint32_t)(elapsedUs * 1000 / iterations);
+    benchPrintf("BENCH name=%s leds=%d iterations=%lu ns_per_frame=%lu ns_per_pixel=%lu\n", name, leds,
+                  (unsigned long)iterations, (unsigned long)nsPerFrame, (unsigned long)(leds > 0 ? nsPerFrame / leds : 0));
+    if (numBenchResults < maxBenchResults) {
+        BenchResult& result = benchResults[numBenchResults++];
+        snprintf(result.name, sizeof(result.name), "%s", name);
+        result.leds = leds;
+        result.iterations = iterations;
+        result.nsPerFrame = nsPerFrame;
+    }
+    return nsPerFrame;
+}
+
+// Every pattern, rendered directly and as indices + palette + expansion
+static void benchPatterns(int leds) {
+    char name[32];
+    for (int p = 0; p < NUM_FASTLED_PATTERNS; p++) {
+        const PatternDescriptor& pattern = patterns[p];
+        benchName(name, sizeof(name), "pattern_", pattern.name, "");
+        benchKernel(name, leds, [&](uint32_t i) { pattern.render(i * benchFrameStepMs, benchFrame, leds); });
+
+        benchName(name, sizeof(name), "pattern_", pattern.name, "_indexed");
+        benchKernel(name, leds, [&](uint32_t i) {
+            pattern.renderIndexed(i * benchFrameStepMs, benchIndices, leds);
+            pattern.updatePalette(i * benchFrameStepMs, benchPalette);
+            for (int px = 0; px < leds; px++) { benchFrame[px] = benchPalette[benchIndices[px]]; }
+        });
+    }
+}
+
+// One JSON document with every result, for scripts/bench_compare.py
+static void printJson() {
+    benchPrintf("BENCH JSON {\"board\":\"%s\",\"cpu_mhz\":%lu,\"min_time_us\":%lu,\"results\":[",
+                  benchBoardName(), benchCpuMhz(), (unsigned long)benchMinTimeUs);
+    for (int i = 0; i < numBenchResults; i++) {
+        const BenchResult& result = benchResults[i];
+        benchPrintf("%s{\"name\":\"%s\",\"leds\":%d,\"iterations\":%lu,\"ns_per_frame\":%lu}", i > 0 ? "," : "",
+                      result.name, result.leds, (unsigned long)result.iterations, (unsigned long)result.nsPerFrame);
+    }
+    benchPrintf("]}\n");
+}
+
+bool runBenchmarks(void (*formatDisplay)()) {
+    logFlush(); // Keep queued log lines ahead of the report
+    benchPrintf("BENCH BEGIN\n");
+    numBenchResults = 0;
+
+    // Largest LED count whose buffers fit in the heap right now
+    int maxLeds = 0;
+    for (int c = numBenchLedCounts - 1; c >= 0 && maxLeds == 0; c--) {
+        if (allocateBuffers(benchLedCounts[c])) { maxLeds = benchLedCounts[c]; }
+        else { freeBuffers(); }
+    }
+    if (maxLeds == 0) {
+        benchPrintf("BENCH name=alloc result=FAIL\n");
+        benchPrintf("BENCH END\n");
+        return false;
+    }
+
+    uint32_t tableNs = 0; // rgbw_convert at maxLeds, for the comparison below
+    for (int c = 0; c < numBenchLedCounts; c++) {
+        const int leds = benchLedCounts[c];
+        if (leds > maxLeds) {
+            benchPrintf("BENCH name=alloc leds=%d result=SKIPPED free_heap=%lu\n", leds, benchFreeHeap());
+            continue;
+        }
+        fillBenchInput(leds);
+        benchPatterns(leds);
+        // FastLED scales by the global brightness while it sends; this is the same pass on the CPU
+        benchKernel("brightness_scale", leds, [&](uint32_t) {
+            memcpy(benchFrame, benchInput, sizeof(CRGB) * leds);
+            nscale8_video(benchFrame, leds, benchBrightness);
+        });
+        tableNs = benchKernel("rgbw_convert", leds, [&](uint32_t) { rgbwConvert(benchInput, benchOutput, leds); });
+    }
+
+    // Table kernel against the division reference on the largest buffer, output must match
+    fillBenchInput(maxLeds);
+    uint32_t referenceNs = benchKernel("rgbw_convert_reference", maxLeds, [&](uint32_t) {
+        rgbwConvertReference(benchInput, benchReference, maxLeds);
+    });
+    rgbwConvert(benchInput, benchOutput, maxLeds);
+    bool matches = memcmp(benchOutput, benchReference, rgbwBytesPerPixel * maxLeds) == 0;
+    benchPrintf("BENCH name=rgbw_compare leds=%d speedup_x10=%lu output=%s\n", maxLeds,
+                  tableNs > 0 ? (unsigned long)(referenceNs * 10ULL / tableNs) : 0UL, matches ? "MATCH" : "MISMATCH");
+    freeBuffers();
+
+    // Menu and mode screen text, the formatting half of updateDisplay()
+    if (formatDisplay != nullptr) {
+        benchKernel("display_format", 0, [&](uint32_t) { formatDisplay(); });
+    }
+
+    // Direct: two CRGB frames. Indexed: index buffer, palette and the one CRGB wire buffer.
+    benchPrintf("BENCH name=framebuffer_memory leds=%d direct_bytes=%u indexed_bytes=%u render_buffer_bytes=%u/%u\n",
+                  MAX_LEDS, (unsigned)(2 * sizeof(CRGB) * MAX_LEDS),
+                  (unsigned)(MAX_LEDS + sizeof(CRGB) * (ledOutputPaletteSize + MAX_LEDS)),
+                  (unsigned)(sizeof(CRGB) * MAX_LEDS), (unsigned)MAX_LEDS);
+
+    printJson();
+    benchPrintf("BENCH END\n");
+    return matches;
+}
@@ -0,0 +1,54 @@
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "boot_timing.h"
+
+struct BootPhaseRecord {
+    const char* name;
+    char task[configMAX_TASK_NAME_LEN];
+    uint32_t startUs;
+    uint32_t endUs;
+};
+
+static BootPhaseRecord bootPhases[maxBootPhases];
+static int numBootPhases = 0;
+static int droppedBootPhases = 0;
+static portMUX_TYPE bootPhaseLock = portMUX_INITIALIZER_UNLOCKED;
+
+uint32_t bootNowUs() {
+    return (uint32_t)esp_timer_get_time();
+}
+
+void bootPhaseDone(const char* name, uint32_t& phaseStartUs) {
+    uint32_t nowUs = bootNowUs();
+    BootPhaseRecord record = {name, {}, phaseStartUs, nowUs};
+    strlcpy(record.task, pcTaskGetTaskName(nullptr), sizeof(record.task));
+    phaseStartUs = nowUs;
+
+    portENTER_CRITICAL(&bootPhaseLock);
+    if (numBootPhases < maxBootPhases) {
+        bootPhases[numBootPhases++] = record;
+    } else {
+        droppedBootPhases++;
+    }
+    portEXIT_CRITICAL(&bootPhaseLock);
+}
+
+static void printMs(const char* key, uint32_t us) {
+    Serial.printf(" %s=%lu.%lu", key, (unsigned long)(us / 1000), (unsigned long)(us % 1000 / 100));
+}
+
+void printBootReport(uint32_t firstFrameUs) {
+    uint32_t lastEndUs = 0;
+    for (int i = 0; i < numBootPhases; i++) {
+        const BootPhaseRecord& phase = bootPhases[i];
+        Serial.printf("BOOT PHASE name=%s task=%s", phase.name, phase.task);
+        printMs("at_ms", phase.endUs);
+        printMs("ms", phase.endUs - phase.startUs);
+        Serial.println();
+        if (phase.endUs > lastEndUs) { lastEndUs = phase.endUs; }
+    }
+    Serial.print("BOOT END");
+    printMs("first_frame_ms", firstFrameUs);
+    printMs("ready_ms", lastEndUs);
+    Serial.printf(" phases=%d dropped=%d\n", numBootPhases, droppedBootPhases);
+}
@@ -0,0 +1,80 @@
+#include <Arduino.h>
+#include "display_flush.h"
+
+// SSD1306 128x32: 16 tiles wide, 4 tile rows, 8 bytes per tile
+const size_t maxDisplayBufferSize = 128 * 64 / 8;
+
+static U8G2* flushDisplay = nullptr;
+static size_t displayBufferSize = 0;
+static uint8_t pendingFrame[maxDisplayBufferSize]; // Latest posted frame
+static uint8_t sendingFrame[maxDisplayBufferSize]; // Frame owned by the flush task
+static uint8_t lastPostedFrame[maxDisplayBufferSize];
+static bool pendingValid = false;
+static bool lastPostedValid = false;
+static portMUX_TYPE pendingLock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t flushTaskHandle = nullptr;
+static DisplayFlushStats flushStats;
+
+const uint32_t flushTaskStackSize = 3072;
+const UBaseType_t flushTaskPriority = 1; // Below the LED output task
+const BaseType_t flushTaskCore = 0;
+
+static void flushTask(void* param) {
+    u8x8_t* u8x8 = flushDisplay->getU8x8();
+    uint8_t tileWidth = flushDisplay->getBufferTileWidth();
+    uint8_t tileHeight = flushDisplay->getBufferTileHeight();
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        portENTER_CRITICAL(&pendingLock);
+        bool haveFrame = pendingValid;
+        if (haveFrame) {
+            memcpy(sendingFrame, pendingFrame, displayBufferSize);
+            pendingValid = false;
+        }
+        portEXIT_CRITICAL(&pendingLock);
+        if (!haveFrame) continue;
+
+        // Same transfer as U8G2::sendBuffer(), but from our own copy
+        uint32_t startUs = micros();
+        for (uint8_t row = 0; row < tileHeight; row++) {
+            u8x8_DrawTile(u8x8, 0, row, tileWidth, sendingFrame + row * tileWidth * 8);
+        }
+        u8x8_RefreshDisplay(u8x8);
+        flushStats.lastFlushUs = micros() - startUs;
+        flushStats.flushed++;
+    }
+}
+
+void displayFlushBegin(U8G2& display) {
+    flushDisplay = &display;
+    displayBufferSize = (size_t)display.getBufferTileWidth() * display.getBufferTileHeight() * 8;
+    if (displayBufferSize > maxDisplayBufferSize) { displayBufferSize = maxDisplayBufferSize; }
+    xTaskCreatePinnedToCore(flushTask, "oledFlush", flushTaskStackSize, nullptr,
+                            flushTaskPriority, &flushTaskHandle, flushTaskCore);
+}
+
+void displayPost() {
+    if (flushTaskHandle == nullptr) return;
+    flushStats.posted++;
+
+    const uint8_t* frame = flushDisplay->getBufferPtr();
+    if (lastPostedValid && memcmp(frame, lastPostedFrame, displayBufferSize) == 0) {
+        flushStats.unchanged++;
+        return;
+    }
+    memcpy(lastPostedFrame, frame, displayBufferSize);
+    lastPostedValid = true;
+
+    portENTER_CRITICAL(&pendingLock);
+    if (pendingValid) { flushStats.dropped++; } // Task hasn't picked up the previous post
+    memcpy(pendingFrame, frame, displayBufferSize);
+    pendingValid = true;
+    portEXIT_CRITICAL(&pendingLock);
+    xTaskNotifyGive(flushTaskHandle);
+}
+
+DisplayFlushStats displayFlushStats() {
+    return flushStats;
+}
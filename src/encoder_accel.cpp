@@ -0,0 +1,99 @@
+#include "encoder_accel.h"
+
+#include <math.h>
+
+// CIE L* knee: below it lightness is linear in luminance
+const float lightnessKnee = 8.0f;
+const float lightnessLinearSlope = 903.3f;
+const float gridTolerance = 1e-3f; // A value this close to a grid level counts as on it
+
+float EncoderVelocity::update(uint32_t nowMs, long steps) {
+    if (steps == 0) return speed(nowMs);
+    int sign = steps > 0 ? 1 : -1;
+    if (sign != direction) { count = 0; } // Turning back starts slow
+    direction = sign;
+    events[head] = {nowMs, steps > 0 ? steps : -steps};
+    head = (head + 1) % encoderVelocityEvents;
+    if (count < encoderVelocityEvents) { count++; }
+    return speed(nowMs);
+}
+
+float EncoderVelocity::speed(uint32_t nowMs) const {
+    long steps = 0;
+    for (int i = 1; i <= count; i++) {
+        const Event& event = events[(head - i + encoderVelocityEvents) % encoderVelocityEvents];
+        if ((int32_t)(nowMs - event.timeMs) >= ENCODER_VELOCITY_WINDOW_MS) break; // Older ones are out too
+        steps += event.steps;
+    }
+    return steps * 1000.0f / ENCODER_VELOCITY_WINDOW_MS;
+}
+
+EncoderSpeedTier encoderSpeedTier(const EncoderCurve& curve, float stepsPerSec) {
+    if (stepsPerSec >= curve.fastFromSps) return ENCODER_SPEED_FAST;
+    if (stepsPerSec >= curve.mediumFromSps) return ENCODER_SPEED_MEDIUM;
+    return ENCODER_SPEED_SLOW;
+}
+
+int encoderDecadeStep(const EncoderCurve& curve, EncoderSpeedTier tier) {
+    int step = 1;
+    for (int t = ENCODER_SPEED_SLOW; t < tier && step * 100 <= curve.maxValue - curve.minValue + 1; t++) { step *= 10; }
+    return step;
+}
+
+float encoderPerceivedLevel(const EncoderCurve& curve, int value) {
+    float luminance = (float)(value - curve.minValue) / (curve.maxValue - curve.minValue);
+    if (luminance <= lightnessKnee / lightnessLinearSlope) return luminance * lightnessLinearSlope;
+    return 116.0f * cbrtf(luminance) - 16.0f;
+}
+
+int encoderValueForLevel(const EncoderCurve& curve, float level) {
+    float luminance;
+    if (level <= lightnessKnee) {
+        luminance = level / lightnessLinearSlope;
+    } else {
+        float root = (level + 16.0f) / 116.0f;
+        luminance = root * root * root;
+    }
+    return curve.minValue + (int)lroundf(luminance * (curve.maxValue - curve.minValue));
+}
+
+// Next multiple of step past value, in the direction turned
+static int decadeStep(int value, int direction, int step) {
+    int below = value >= 0 ? value / step * step : -((-value + step - 1) / step * step); // Floor to a multiple
+    if (direction > 0) return below + step;
+    return below == value ? value - step : below;
+}
+
+// Next grid level past value that also changes it, `levels` grid steps away
+static int perceptualStep(const EncoderCurve& curve, int value, int direction, int levels) {
+    float gridStep = 100.0f / curve.coarseSteps;
+    float position = encoderPerceivedLevel(curve, value) / gridStep;
+    int grid = direction > 0 ? (int)floorf(position + gridTolerance) + levels
+                             : (int)ceilf(position - gridTolerance) - levels;
+    for (;;) {
+        if (grid < 0) { grid = 0; }
+        if (grid > curve.coarseSteps) { grid = curve.coarseSteps; }
+        int next = encoderValueForLevel(curve, grid * gridStep);
+        if (direction > 0 ? next > value : next < value) return next;
+        if (grid == 0 || grid == curve.coarseSteps) return value + direction; // Grid used up: one unit
+        grid += direction; // Low levels share a value; move to the first that differs
+    }
+}
+
+int encoderAccelApply(const EncoderCurve& curve, int value, long steps, float stepsPerSec) {
+    EncoderSpeedTier tier = encoderSpeedTier(curve, stepsPerSec);
+    int direction = steps > 0 ? 1 : -1;
+    for (long i = 0; i < (steps > 0 ? steps : -steps); i++) {
+        if (direction > 0 ? value >= curve.maxValue : value <= curve.minValue) break;
+        if (tier == ENCODER_SPEED_SLOW) {
+            value += direction;
+        } else if (curve.kind == ENCODER_CURVE_DECADE) {
+            value = decadeStep(value, direction, encoderDecadeStep(curve, tier));
+        } else {
+            value = perceptualStep(curve, value, direction, tier == ENCODER_SPEED_FAST ? encoderPerceptualFastLevels : 1);
+        }
+        if (value < curve.minValue) { value = curve.minValue; }
+        if (value > curve.maxValue) { value = curve.maxValue; }
+    }
+    return value;
+}
@@ -0,0 +1,68 @@
+#include "i2c_topology.h"
+#include "ina219.h"
+
+#include <stdio.h>
+
+const I2cKnownDevice i2cKnownDevices[NUM_I2C_DEVICE_KINDS] = {
+    {0x3C, "SSD1306"},
+    {0x23, "BH1750"},
+    {0x40, "INA219"},
+};
+const char* const i2cMatchNames[3] = {"absent", "ok", "unverified"};
+
+const uint16_t ina219ResetConfig = 0x399F;
+const int32_t i2cTopologyVersion = 1; // Bump when kinds are added or reordered
+
+bool ssd1306StatusMatches(uint8_t status) {
+    uint8_t id = status & 0x0F;
+    return id == 0x03 || id == 0x06 || id == 0x07;
+}
+
+bool bh1750ReadMatches(int bytesRead) {
+    return bytesRead == 2;
+}
+
+bool ina219ConfigMatches(uint16_t config) {
+    if (config == ina219ResetConfig) return true;
+    for (int p = 0; p < NUM_INA219_PROFILES; p++) {
+        if (config == ina219ConfigValue((Ina219Profile)p)) return true;
+    }
+    return false;
+}
+
+int i2cKnownDeviceAt(uint8_t address) {
+    for (int k = 0; k < NUM_I2C_DEVICE_KINDS; k++) {
+        if (i2cKnownDevices[k].address == address) return k;
+    }
+    return -1;
+}
+
+// Two bits per kind, version in the top byte
+int32_t encodeI2cTopology(const I2cTopology& topology) {
+    int32_t stored = i2cTopologyVersion << 24;
+    for (int k = 0; k < NUM_I2C_DEVICE_KINDS; k++) { stored |= (int32_t)topology.devices[k] << (2 * k); }
+    return stored;
+}
+
+bool decodeI2cTopology(int32_t stored, I2cTopology& topology) {
+    if ((stored >> 24) != i2cTopologyVersion) return false; // Also the "never saved" default
+    for (int k = 0; k < NUM_I2C_DEVICE_KINDS; k++) {
+        int match = (stored >> (2 * k)) & 3;
+        if (match > I2C_MATCH_UNVERIFIED) return false;
+        topology.devices[k] = (I2cMatch)match;
+    }
+    return true;
+}
+
+void formatI2cScanPage(char* out, size_t size, const I2cScanResult& scan, int page) {
+    if (scan.count == 0) {
+        snprintf(out, size, "None");
+        return;
+    }
+    int i = page % scan.count;
+    if (scan.kinds[i] < 0) {
+        snprintf(out, size, "%d:0x%02X", i + 1, scan.addresses[i]);
+    } else {
+        snprintf(out, size, "%d:%s%s", i + 1, i2cKnownDevices[scan.kinds[i]].name, scan.matches[i] == I2C_MATCH_OK ? "" : "?");
+    }
+}
@@ -0,0 +1,63 @@
+#include <Arduino.h>
+#include <Wire.h>
+#include "i2c_topology.h"
+#include "ina219.h"
+
+static bool acknowledges(TwoWire& wire, uint8_t address) {
+    wire.beginTransmission(address);
+    return wire.endTransmission() == 0;
+}
+
+I2cMatch i2cFingerprint(TwoWire& wire, I2cDeviceKind kind, Ina219* ina219) {
+    uint8_t address = i2cKnownDevices[kind].address;
+    bool matches = false;
+    switch (kind) {
+        case I2C_DEVICE_SSD1306:
+            if (wire.requestFrom(address, (uint8_t)1) != 1) return acknowledges(wire, address) ? I2C_MATCH_UNVERIFIED : I2C_MATCH_ABSENT;
+            matches = ssd1306StatusMatches(wire.read());
+            break;
+        case I2C_DEVICE_BH1750: {
+            int bytesRead = wire.requestFrom(address, (uint8_t)2);
+            while (wire.available() > 0) { wire.read(); }
+            if (bytesRead == 0) return acknowledges(wire, address) ? I2C_MATCH_UNVERIFIED : I2C_MATCH_ABSENT;
+            matches = bh1750ReadMatches(bytesRead);
+            break;
+        }
+        case I2C_DEVICE_INA219: {
+            uint16_t config = 0;
+            bool read;
+            if (ina219 != nullptr && ina219->started()) {
+                read = ina219->readConfig(config);
+            } else {
+                // Raw: point at the configuration register and read it
+                wire.beginTransmission(address);
+                wire.write(INA219_REG_CONFIG);
+                read = wire.endTransmission() == 0 && wire.requestFrom(address, (uint8_t)2) == 2;
+                if (read) {
+                    config = (uint16_t)(wire.read() << 8);
+                    config |= (uint16_t)wire.read();
+                }
+            }
+            if (!read) return acknowledges(wire, address) ? I2C_MATCH_UNVERIFIED : I2C_MATCH_ABSENT;
+            matches = ina219ConfigMatches(config);
+            break;
+        }
+        default:
+            return I2C_MATCH_ABSENT;
+    }
+    return matches ? I2C_MATCH_OK : I2C_MATCH_UNVERIFIED;
+}
+
+I2cScanResult i2cScanBus(TwoWire& wire, Ina219* ina219) {
+    I2cScanResult scan;
+    for (uint8_t address = 1; address < 127 && scan.count < maxI2cScanDevices; address++) {
+        if (!acknowledges(wire, address)) continue;
+        int kind = i2cKnownDeviceAt(address);
+        scan.addresses[scan.count] = address;
+        scan.kinds[scan.count] = kind;
+        scan.matches[scan.count] = kind >= 0 ? i2cFingerprint(wire, (I2cDeviceKind)kind, ina219) : I2C_MATCH_UNVERIFIED;
+        if (scan.matches[scan.count] == I2C_MATCH_ABSENT) { scan.matches[scan.count] = I2C_MATCH_UNVERIFIED; } // It did ACK
+        scan.count++;
+    }
+    return scan;
+}
@@ -0,0 +1,85 @@
+#include <Arduino.h>
+#include <Wire.h>
+#include "ina219.h"
+
+const uint32_t conversionTimeoutSlackMs = 5; // On top of two conversion times
+
+Ina219::Ina219(uint8_t address) : address(address) {}
+
+bool Ina219::readRegister(uint8_t reg, uint16_t& value) {
+    if (pointer != reg) {
+        wire->beginTransmission(address);
+        wire->write(reg);
+        driverStats.registerWrites++;
+        if (wire->endTransmission() != 0) { pointer = 0xFF; return false; }
+        pointer = reg;
+    }
+    driverStats.registerReads++;
+    if (wire->requestFrom(address, (uint8_t)2) != 2) return false;
+    value = (uint16_t)(wire->read() << 8);
+    value |= (uint16_t)wire->read();
+    return true;
+}
+
+bool Ina219::writeRegister(uint8_t reg, uint16_t value) {
+    wire->beginTransmission(address);
+    wire->write(reg);
+    wire->write((uint8_t)(value >> 8));
+    wire->write((uint8_t)(value & 0xFF));
+    driverStats.registerWrites++;
+    pointer = reg;
+    return wire->endTransmission() == 0;
+}
+
+bool Ina219::begin(TwoWire* bus, uint32_t shunt) {
+    wire = bus;
+    shuntMicroOhm = shunt;
+    currentLsbUa = ina219CurrentLsbUa(shuntMicroOhm);
+    if (!writeRegister(INA219_REG_CALIBRATION, ina219CalibrationValue(currentLsbUa, shuntMicroOhm))) return false;
+    return setProfile(INA219_PROFILE_MONITOR);
+}
+
+bool Ina219::setProfile(Ina219Profile profile) {
+    activeProfile = profile;
+    return writeRegister(INA219_REG_CONFIG, ina219ConfigValue(profile)); // Also restarts the conversion
+}
+
+bool Ina219::readConfig(uint16_t& value) {
+    if (wire == nullptr) return false;
+    return readRegister(INA219_REG_CONFIG, value);
+}
+
+// The ready flag was seen in busRaw: fetch current, then power (which clears the flag)
+bool Ina219::readResults(uint16_t busRaw) {
+    uint16_t currentRaw, powerRaw;
+    if (!readRegister(INA219_REG_CURRENT, currentRaw)) return false;
+    if (!readRegister(INA219_REG_POWER, powerRaw)) return false;
+    lastSample = ina219DecodeSample(busRaw, currentRaw, powerRaw, currentLsbUa, shuntMicroOhm);
+    driverStats.conversions++;
+    return true;
+}
+
+bool Ina219::poll() {
+    if (wire == nullptr) return false;
+    uint16_t busRaw;
+    if (!readRegister(INA219_REG_BUS_VOLTAGE, busRaw)) return false;
+    if (!ina219ConversionReady(busRaw)) {
+        driverStats.notReady++;
+        return false;
+    }
+    return readResults(busRaw);
+}
+
+bool Ina219::measure() {
+    if (wire == nullptr) return false;
+    // Rewriting the configuration aborts the running conversion and clears the ready flag
+    if (!setProfile(activeProfile)) return false;
+    uint32_t conversionMs = (ina219ConversionTimeUs(activeProfile) + 999) / 1000;
+    unsigned long startMs = millis();
+    delay(conversionMs);
+    for (;;) {
+        if (poll()) return true;
+        if (millis() - startMs > 2 * conversionMs + conversionTimeoutSlackMs) return false;
+        delay(1);
+    }
+}
@@ -0,0 +1,98 @@
+#include "ina219.h"
+
+// Register math from the INA219 datasheet (SBOS448), kept free of I/O
+
+const uint32_t shuntFullScaleUv = 320000;   // PGA /8
+const int32_t currentRegisterMax = 32767;
+const uint32_t powerLsbPerCurrentLsb = 20;
+
+// Config register fields
+const uint16_t configBusRange16V = 0 << 13;
+const uint16_t configGainDiv8 = 3 << 11;
+const uint16_t configModeShuntBusContinuous = 7;
+const int configBusAdcShift = 7;
+const int configShuntAdcShift = 3;
+
+// ADC setting codes: 12-bit single conversion, or 2^n-sample averaging
+const uint16_t adc12Bit = 0x3;
+const uint16_t adcAverage16 = 0xC;
+const uint16_t adcAverage32 = 0xD;
+const uint16_t adcAverage128 = 0xF;
+const uint32_t adcSampleUs = 532; // One 12-bit conversion
+
+struct ProfileSetup {
+    uint16_t shuntAdc;
+    uint16_t busAdc;
+    uint32_t conversionUs; // Shunt then bus, back to back
+};
+static const ProfileSetup profileSetups[NUM_INA219_PROFILES] = {
+    {adcAverage128, adcAverage128, 128 * adcSampleUs * 2}, // INA219_PROFILE_MONITOR
+    {adcAverage32, adc12Bit, 33 * adcSampleUs},            // INA219_PROFILE_CALIBRATION
+    {adcAverage16, adc12Bit, 17 * adcSampleUs},            // INA219_PROFILE_PROBE
+};
+
+uint32_t ina219CurrentLsbUa(uint32_t shuntMicroOhm) {
+    if (shuntMicroOhm == 0) return 0;
+    uint64_t maxCurrentUa = (uint64_t)shuntFullScaleUv * 1000000 / shuntMicroOhm;
+    uint64_t minLsbUa = (maxCurrentUa + currentRegisterMax - 1) / currentRegisterMax;
+    static const uint32_t steps[] = {1, 2, 5};
+    for (uint64_t decade = 1; ; decade *= 10) {
+        for (uint32_t step : steps) {
+            if (decade * step >= minLsbUa) return (uint32_t)(decade * step);
+        }
+    }
+}
+
+uint16_t ina219CalibrationValue(uint32_t currentLsbUa, uint32_t shuntMicroOhm) {
+    uint64_t divisor = (uint64_t)currentLsbUa * shuntMicroOhm;
+    if (divisor == 0) return 0;
+    uint64_t cal = 40960000000ULL / divisor; // 0.04096 / (A * Ω) with both in micro units
+    if (cal > 0xFFFE) cal = 0xFFFE;
+    return (uint16_t)(cal & 0xFFFE); // Bit 0 is read-only
+}
+
+uint16_t ina219ConfigValue(Ina219Profile profile) {
+    const ProfileSetup& setup = profileSetups[profile];
+    return configBusRange16V | configGainDiv8 | (setup.busAdc << configBusAdcShift) |
+           (setup.shuntAdc << configShuntAdcShift) | configModeShuntBusContinuous;
+}
+
+uint32_t ina219ConversionTimeUs(Ina219Profile profile) {
+    return profileSetups[profile].conversionUs;
+}
+
+bool ina219ConversionReady(uint16_t busRaw) {
+    return (busRaw & 0x0002) != 0;
+}
+
+bool ina219MathOverflow(uint16_t busRaw) {
+    return (busRaw & 0x0001) != 0;
+}
+
+uint32_t ina219DecodeBusMv(uint16_t busRaw) {
+    return (uint32_t)(busRaw >> 3) * 4; // 4 mV LSB above the two flag bits
+}
+
+int32_t ina219DecodeShuntUv(uint16_t shuntRaw) {
+    return (int32_t)(int16_t)shuntRaw * 10; // 10 µV LSB, two's complement
+}
+
+int32_t ina219DecodeCurrentUa(uint16_t currentRaw, uint32_t currentLsbUa) {
+    return (int32_t)(int16_t)currentRaw * (int32_t)currentLsbUa;
+}
+
+uint32_t ina219DecodePowerUw(uint16_t powerRaw, uint32_t currentLsbUa) {
+    uint64_t powerUw = (uint64_t)powerRaw * powerLsbPerCurrentLsb * currentLsbUa;
+    return powerUw > UINT32_MAX ? UINT32_MAX : (uint32_t)powerUw; // 200 mW steps at 1 mΩ pass 4294 W near full scale
+}
+
+Ina219Sample ina219DecodeSample(uint16_t busRaw, uint16_t currentRaw, uint16_t powerRaw,
+                                uint32_t currentLsbUa, uint32_t shuntMicroOhm) {
+    Ina219Sample sample;
+    sample.busMv = ina219DecodeBusMv(busRaw);
+    sample.overflow = ina219MathOverflow(busRaw);
+    sample.currentUa = ina219DecodeCurrentUa(currentRaw, currentLsbUa);
+    sample.powerUw = ina219DecodePowerUw(powerRaw, currentLsbUa);
+    sample.shuntUv = (int32_t)((int64_t)sample.currentUa * shuntMicroOhm / 1000000);
+    return sample;
+}
@@ -0,0 +1,20 @@
+#include "led_count_detect.h"
+
+LedCountDetectResult detectLedCount(int maxLeds, float minLitDeltaMa, LedProbeFn probe, void* context) {
+    LedCountDetectResult result = {0, 0};
+    // Invariant: pixels below `lo` light up, pixels at or above `hi` don't
+    int lo = 0;
+    int hi = maxLeds;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        float deltaMa = probe(mid, context);
+        result.measurements++;
+        if (deltaMa >= minLitDeltaMa) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    result.workingLeds = lo;
+    return result;
+}
@@ -0,0 +1,292 @@
+#include <Arduino.h>
+#include "led_output.h"
+#include "log.h"
+#include "rgbw.h"
+#include "led_segments.h"
+
+#if LED_INDEXED_FRAMEBUFFER
+// Patterns render into the index buffer while the previous frame is on the
+// wire; present expands it into the one CRGB buffer FastLED sends from.
+static CRGB ledBuffers[1][MAX_LEDS];
+static CRGB* frontBuffer = ledBuffers[0]; // Being transmitted (or last transmitted)
+static uint8_t indexBuffer[MAX_LEDS];
+static CRGB palette[ledOutputPaletteSize];
+#else
+static CRGB ledBuffers[2][MAX_LEDS];
+static CRGB* frontBuffer = ledBuffers[0]; // Being transmitted (or last transmitted)
+static CRGB* backBuffer = ledBuffers[1];  // Being rendered
+#endif
+static uint8_t frontBrightness = 0;
+// GRBW bytes for RGBW strips, registered with FastLED as plain RGB pixels
+static CRGB rgbwWireBuffer[(MAX_LEDS * rgbwBytesPerPixel + 2) / 3];
+static bool rgbwOutput = false;
+
+static CLEDController* outputControllers[maxLedSegments] = {};
+static int numOutputControllers = 0;
+static LedSegmentPlan segmentPlan = {};
+static int outputLeds = 0;         // Pixels on the wire: the planned strip length
+static const LedWireTiming* wireTiming = nullptr;
+static uint32_t segmentWireUs = 0; // Modelled wire time of the longest segment
+static TaskHandle_t outputTaskHandle = nullptr;
+static SemaphoreHandle_t outputIdle = nullptr; // Given when the wire is free
+static uint64_t renderStartUs = 0;
+static uint32_t lastSendMs = 0;          // When the front buffer was last put on the wire
+static bool forceNextSend = true;        // First frame always goes out
+static uint32_t refreshIntervalMs = LED_REFRESH_INTERVAL_MS;
+
+static FramePipelineStats pipelineStats;
+
+const uint32_t outputTaskStackSize = 4096;
+const UBaseType_t outputTaskPriority = 3; // Above loop() so a new frame starts immediately
+const BaseType_t outputTaskCore = 0;      // loop() runs on core 1
+
+static void outputTask(void* param) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        uint64_t startUs = esp_timer_get_time();
+        if (rgbwOutput) {
+            rgbwConvert(frontBuffer, (uint8_t*)rgbwWireBuffer, outputLeds); // Single pass, off the render path
+        }
+        // Each pin's controller sends its slice; FastLED clocks them out together
+        CRGB* wire = rgbwOutput ? rgbwWireBuffer : frontBuffer;
+        for (int s = 0; s < segmentPlan.numSegments; s++) {
+            const LedSegment& segment = segmentPlan.segments[s];
+            outputControllers[s]->setLeds(wire + segment.wireStart, segment.wireCount);
+        }
+        FastLED.show(frontBrightness);
+        uint32_t transmitUs = (uint32_t)(esp_timer_get_time() - startUs);
+        pipelineStats.transmissions++;
+        pipelineStats.transmitUs += transmitUs;
+        if (transmitUs > pipelineStats.maxTransmitUs) pipelineStats.maxTransmitUs = transmitUs;
+        xSemaphoreGive(outputIdle);
+    }
+}
+
+CRGB* ledOutputFrontBuffer() {
+    return frontBuffer;
+}
+
+uint8_t ledOutputFrontBrightness() {
+    return frontBrightness;
+}
+
+CRGB* ledOutputRgbwWireBuffer() {
+    return rgbwWireBuffer;
+}
+
+static void usePlan(const LedSegmentPlan& plan) {
+    segmentPlan = plan;
+    outputLeds = 0;
+    for (int s = 0; s < plan.numSegments; s++) { outputLeds += plan.segments[s].count; }
+    segmentWireUs = ledWireFrameUs(plan.longestWireBytes, *wireTiming);
+}
+
+void ledOutputBegin(CLEDController* const* controllers, const LedSegmentPlan& plan, const LedWireTiming& timing, bool rgbw) {
+    wireTiming = &timing;
+    usePlan(plan);
+    numOutputControllers = plan.numSegments;
+    rgbwOutput = rgbw;
+    for (int s = 0; s < plan.numSegments; s++) {
+        outputControllers[s] = controllers[s];
+        if (rgbw) { controllers[s]->setDither(DISABLE_DITHER); } // Dither would treat W bytes as color channels
+    }
+    outputIdle = xSemaphoreCreateBinary();
+    xSemaphoreGive(outputIdle);
+    xTaskCreatePinnedToCore(outputTask, "ledOutput", outputTaskStackSize, nullptr,
+                            outputTaskPriority, &outputTaskHandle, outputTaskCore);
+    pipelineStats.windowStartUs = esp_timer_get_time();
+}
+
+int ledOutputLength() {
+    return outputLeds;
+}
+
+bool ledOutputSetLength(int n) {
+    if (n < 1 || n > MAX_LEDS) return false;
+    LedSegmentPlan plan = planLedSegments(n, numOutputControllers, rgbwOutput);
+    if (plan.numSegments != numOutputControllers) return false; // Too short to keep every pin busy
+    xSemaphoreTake(outputIdle, portMAX_DELAY); // The output task reads the plan while sending
+    usePlan(plan);
+    forceNextSend = true; // Pixels newly on the wire haven't been sent yet
+    xSemaphoreGive(outputIdle);
+    return true;
+}
+
+// Hand the front buffer to the output task; the caller holds outputIdle
+static void startTransmission(uint8_t brightness) {
+    frontBrightness = brightness;
+    forceNextSend = false;
+    lastSendMs = millis();
+    pipelineStats.sent++;
+    xTaskNotifyGive(outputTaskHandle);
+}
+
+static void recordWait(uint32_t waitUs) {
+    pipelineStats.waitUs += waitUs;
+    if (waitUs > pipelineStats.maxWaitUs) pipelineStats.maxWaitUs = waitUs;
+}
+
+static void recordRender(uint32_t renderUs) {
+    pipelineStats.frames++;
+    pipelineStats.renderUs += renderUs;
+    if (renderUs > pipelineStats.maxRenderUs) pipelineStats.maxRenderUs = renderUs;
+}
+
+#if LED_INDEXED_FRAMEBUFFER
+// Direct CRGB frames write the wire buffer itself, so they wait for it up front
+CRGB* ledOutputBeginFrame() {
+    uint64_t waitStartUs = esp_timer_get_time();
+    xSemaphoreTake(outputIdle, portMAX_DELAY);
+    renderStartUs = esp_timer_get_time();
+    recordWait((uint32_t)(renderStartUs - waitStartUs));
+    return frontBuffer;
+}
+
+void ledOutputPresent(uint8_t brightness) {
+    recordRender((uint32_t)(esp_timer_get_time() - renderStartUs));
+    startTransmission(brightness);
+}
+
+// The wire buffer was never sent, so frontBuffer now differs from what is on the strip
+void ledOutputCancelFrame() {
+    forceNextSend = true;
+    xSemaphoreGive(outputIdle);
+}
+
+uint8_t* ledOutputBeginIndexedFrame() {
+    renderStartUs = esp_timer_get_time();
+    return indexBuffer;
+}
+
+CRGB* ledOutputPalette() {
+    return palette;
+}
+
+void ledOutputPresentIndexed(uint8_t brightness, int n) {
+    uint64_t renderEndUs = esp_timer_get_time();
+    xSemaphoreTake(outputIdle, portMAX_DELAY); // Previous frame fully on the wire
+    uint64_t waitEndUs = esp_timer_get_time();
+    recordWait((uint32_t)(waitEndUs - renderEndUs));
+
+    // Expand in one pass, noting whether any pixel differs from the frame last sent
+    bool changed = forceNextSend || brightness != frontBrightness;
+    for (int i = 0; i < n; i++) {
+        const CRGB& color = palette[indexBuffer[i]];
+        if (frontBuffer[i] != color) {
+            frontBuffer[i] = color;
+            changed = true;
+        }
+    }
+    for (int i = n; i < MAX_LEDS; i++) {
+        if (frontBuffer[i] != CRGB(CRGB::Black)) {
+            frontBuffer[i] = CRGB::Black;
+            changed = true;
+        }
+    }
+    // Expansion is part of producing the frame
+    recordRender((uint32_t)(renderEndUs - renderStartUs + (esp_timer_get_time() - waitEndUs)));
+
+    if (!changed) {
+        pipelineStats.skipped++;
+        xSemaphoreGive(outputIdle);
+        return;
+    }
+    startTransmission(brightness);
+}
+
+void ledOutputClear() {
+    memset(ledOutputBeginIndexedFrame(), 0, MAX_LEDS);
+    palette[0] = CRGB::Black;
+    ledOutputPresentIndexed(0, MAX_LEDS);
+}
+#else
+CRGB* ledOutputBeginFrame() {
+    renderStartUs = esp_timer_get_time();
+    return backBuffer;
+}
+
+void ledOutputPresent(uint8_t brightness) {
+    uint64_t renderEndUs = esp_timer_get_time();
+    recordRender((uint32_t)(renderEndUs - renderStartUs));
+
+    // The front buffer is only read by the transmission, so it can be compared while on the wire
+    bool unchanged = !forceNextSend && brightness == frontBrightness &&
+                     memcmp(backBuffer, frontBuffer, sizeof(ledBuffers[0])) == 0;
+    if (unchanged) {
+        pipelineStats.skipped++;
+        return;
+    }
+
+    xSemaphoreTake(outputIdle, portMAX_DELAY); // Previous frame fully on the wire
+    uint64_t waitEndUs = esp_timer_get_time();
+
+    CRGB* finished = frontBuffer;
+    frontBuffer = backBuffer;
+    backBuffer = finished;
+    recordWait((uint32_t)(waitEndUs - renderEndUs));
+    startTransmission(brightness);
+}
+
+// The back buffer is simply rendered over by the next frame
+void ledOutputCancelFrame() {}
+
+void ledOutputClear() {
+    fill_solid(ledOutputBeginFrame(), MAX_LEDS, CRGB::Black);
+    ledOutputPresent(0);
+}
+#endif
+
+void ledOutputSetRefreshInterval(uint32_t intervalMs) {
+    refreshIntervalMs = intervalMs;
+}
+
+bool ledOutputNextRefresh(unsigned long& due) {
+    if (refreshIntervalMs == 0 || outputTaskHandle == nullptr) return false;
+    due = lastSendMs + refreshIntervalMs;
+    return true;
+}
+
+void ledOutputRefreshIfDue() {
+    if (refreshIntervalMs == 0 || outputTaskHandle == nullptr) return;
+    if (millis() - lastSendMs < refreshIntervalMs) return;
+    if (xSemaphoreTake(outputIdle, 0) != pdTRUE) return; // Still sending, which counts as a refresh
+    lastSendMs = millis();
+    pipelineStats.refreshes++;
+    xTaskNotifyGive(outputTaskHandle);
+}
+
+void ledOutputFlush() {
+    xSemaphoreTake(outputIdle, portMAX_DELAY);
+    xSemaphoreGive(outputIdle);
+}
+
+void printFramePipelineStats() {
+    FramePipelineStats stats = pipelineStats;
+    uint64_t nowUs = esp_timer_get_time();
+    logFlush(); // Keep queued log lines ahead of the report
+    uint64_t windowUs = nowUs - stats.windowStartUs;
+    uint32_t frames = stats.frames > 0 ? stats.frames : 1;
+    uint32_t sent = stats.sent > 0 ? stats.sent : 1;
+    uint32_t transmissions = stats.transmissions > 0 ? stats.transmissions : 1;
+
+    Serial.println("--- Frame Pipeline ---");
+    Serial.printf("Frames: %lu in %lu ms (%lu.%lu fps)\n", (unsigned long)stats.frames, (unsigned long)(windowUs / 1000),
+                  windowUs > 0 ? (unsigned long)(stats.frames * 1000000ULL / windowUs) : 0UL,
+                  windowUs > 0 ? (unsigned long)(stats.frames * 10000000ULL / windowUs % 10) : 0UL);
+    Serial.printf("Render:   avg %lu us, max %lu us\n", (unsigned long)(stats.renderUs / frames), (unsigned long)stats.maxRenderUs);
+    Serial.printf("Sent: %lu, skipped unchanged: %lu, refreshes: %lu\n",
+                  (unsigned long)stats.sent, (unsigned long)stats.skipped, (unsigned long)stats.refreshes);
+    Serial.printf("Wait:     avg %lu us, max %lu us\n", (unsigned long)(stats.waitUs / sent), (unsigned long)stats.maxWaitUs);
+    Serial.printf("Transmit: avg %lu us, max %lu us\n", (unsigned long)(stats.transmitUs / transmissions), (unsigned long)stats.maxTransmitUs);
+    Serial.printf("Segments: %d, longest %d bytes, wire time %lu us\n", segmentPlan.numSegments,
+                  segmentPlan.longestWireBytes, (unsigned long)segmentWireUs);
+    // Render time that ran while the previous frame was still on the wire
+    uint64_t hiddenUs = stats.transmitUs > stats.waitUs ? stats.transmitUs - stats.waitUs : 0;
+    if (hiddenUs > stats.renderUs) hiddenUs = stats.renderUs;
+    Serial.printf("Render hidden behind transmit: %lu%%\n",
+                  stats.renderUs > 0 ? (unsigned long)(hiddenUs * 100 / stats.renderUs) : 100UL);
+    Serial.println("----------------------");
+
+    pipelineStats = FramePipelineStats();
+    pipelineStats.windowStartUs = nowUs;
+}
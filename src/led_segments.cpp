@@ -0,0 +1,76 @@
+#include "led_segments.h"
+
+// WS2812: C_NS(250), C_NS(625), C_NS(375). Current WS2812B parts latch after 280 µs.
+const LedWireTiming ws2812WireTiming = {"ws2812", 250, 1000, 875, 375, 280};
+// SK6812: C_NS(300), C_NS(300), C_NS(600)
+const LedWireTiming sk6812WireTiming = {"sk6812", 300, 900, 600, 600, 80};
+
+// Entries needed for n packed GRBW pixels, as rgbwWireLength()
+static int rgbwEntries(int n) {
+    return (n * 4 + 2) / 3;
+}
+
+LedSegmentPlan planLedSegments(int numLeds, int numSegments, bool rgbw) {
+    LedSegmentPlan plan = {};
+    if (numLeds <= 0) return plan;
+    if (numSegments < 1) numSegments = 1;
+    if (numSegments > maxLedSegments) numSegments = maxLedSegments;
+
+    // Split in units that keep every segment start on a whole wire entry
+    const int unit = rgbw ? 3 : 1;
+    const int units = (numLeds + unit - 1) / unit;
+    if (numSegments > units) numSegments = units;
+
+    int start = 0;
+    for (int s = 0; s < numSegments; s++) {
+        // The first (units % numSegments) segments take one unit more
+        int segmentUnits = units / numSegments + (s < units % numSegments ? 1 : 0);
+        int end = start + segmentUnits * unit;
+        if (end > numLeds) end = numLeds;
+
+        LedSegment& segment = plan.segments[s];
+        segment.start = start;
+        segment.count = end - start;
+        if (rgbw) {
+            segment.wireStart = start / 3 * 4;
+            segment.wireCount = rgbwEntries(end) - segment.wireStart; // The last one takes the padding
+        } else {
+            segment.wireStart = start;
+            segment.wireCount = segment.count;
+        }
+        if (segment.wireCount * 3 > plan.longestWireBytes) plan.longestWireBytes = segment.wireCount * 3;
+        start = end;
+    }
+    plan.numSegments = numSegments;
+    return plan;
+}
+
+void ledWireEncode(const uint8_t* bytes, int count, const LedWireTiming& timing, LedWireSymbol* out) {
+    for (int i = 0; i < count; i++) {
+        for (int bit = 7; bit >= 0; bit--) {
+            bool one = (bytes[i] >> bit) & 1;
+            *out++ = one ? LedWireSymbol{timing.oneHighNs, timing.oneLowNs}
+                         : LedWireSymbol{timing.zeroHighNs, timing.zeroLowNs};
+        }
+    }
+}
+
+int ledWireDecode(const LedWireSymbol* symbols, int count, const LedWireTiming& timing, uint8_t* out) {
+    const uint16_t sampleNs = (timing.zeroHighNs + timing.oneHighNs) / 2;
+    int bytes = count / 8;
+    for (int i = 0; i < bytes; i++) {
+        uint8_t value = 0;
+        for (int bit = 0; bit < 8; bit++) {
+            const LedWireSymbol& symbol = symbols[i * 8 + bit];
+            value = (uint8_t)(value << 1 | (symbol.highNs > sampleNs ? 1 : 0));
+        }
+        out[i] = value;
+    }
+    return bytes;
+}
+
+uint32_t ledWireFrameUs(int bytes, const LedWireTiming& timing) {
+    // Both bit shapes of a chipset have the same period
+    uint32_t bitNs = timing.zeroHighNs + timing.zeroLowNs;
+    return (uint32_t)((uint64_t)bytes * 8 * bitNs / 1000) + timing.latchUs;
+}
@@ -0,0 +1,118 @@
+#include <Arduino.h>
+#include <atomic>
+#include "log.h"
+
+const uint32_t logSlotCount = 32;    // Power of two, messages buffered before dropping
+const size_t logSlotSize = 128;      // Longest message incl. prefix and newline
+
+struct LogSlot {
+    std::atomic<uint32_t> sequence;  // Index + 1 once the slot holds a complete message
+    uint16_t length;
+    char text[logSlotSize];
+};
+
+static LogSlot logSlots[logSlotCount];
+static std::atomic<uint32_t> logHead(0); // Next index to reserve (writers)
+static std::atomic<uint32_t> logTail(0); // Next index to drain (drain task)
+static std::atomic<uint32_t> droppedCount(0);
+static std::atomic<uint32_t> writtenCount(0);
+static std::atomic<uint32_t> rateLimitedCount(0);
+static TaskHandle_t drainTaskHandle = nullptr;
+
+const uint32_t drainTaskStackSize = 3072;
+const UBaseType_t drainTaskPriority = 1; // Lowest application priority
+const TickType_t drainPollTicks = pdMS_TO_TICKS(100);
+
+static const char* levelPrefix(int level) {
+    switch (level) {
+        case LOG_LEVEL_ERROR: return "E: ";
+        case LOG_LEVEL_WARN: return "W: ";
+        case LOG_LEVEL_DEBUG: return "D: ";
+        default: return "";
+    }
+}
+
+static void drainTask(void* param) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, drainPollTicks);
+        uint32_t tail = logTail.load(std::memory_order_relaxed);
+        while (tail != logHead.load(std::memory_order_acquire)) {
+            LogSlot& slot = logSlots[tail % logSlotCount];
+            if (slot.sequence.load(std::memory_order_acquire) != tail + 1) break; // Writer still formatting
+            Serial.write((const uint8_t*)slot.text, slot.length); // May block, but only this task
+            tail++;
+            logTail.store(tail, std::memory_order_release);
+        }
+    }
+}
+
+void logBegin() {
+    xTaskCreatePinnedToCore(drainTask, "logDrain", drainTaskStackSize, nullptr,
+                            drainTaskPriority, &drainTaskHandle, 0);
+}
+
+void logWrite(int level, LogSite* site, uint32_t minIntervalMs, const char* format, ...) {
+    uint32_t now = millis();
+    if (now == 0) now = 1; // 0 marks a site that never logged
+    // Claim this interval for the site; of two tasks racing for it, one logs and one is suppressed
+    uint32_t last = site->lastMs.load(std::memory_order_relaxed);
+    do {
+        if (last != 0 && now - last < minIntervalMs) {
+            site->suppressed.fetch_add(1, std::memory_order_relaxed);
+            rateLimitedCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    } while (!site->lastMs.compare_exchange_weak(last, now, std::memory_order_relaxed));
+    uint32_t suppressed = site->suppressed.exchange(0, std::memory_order_relaxed);
+
+    // Reserve a slot without locking; give up rather than wait if the ring is full
+    uint32_t index = logHead.load(std::memory_order_relaxed);
+    do {
+        if (index - logTail.load(std::memory_order_acquire) >= logSlotCount) {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    } while (!logHead.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+    LogSlot& slot = logSlots[index % logSlotCount];
+    const size_t room = logSlotSize - 2; // Keep space for "\r\n"
+    int length = snprintf(slot.text, room, "%s", levelPrefix(level));
+    va_list args;
+    va_start(args, format);
+    length += vsnprintf(slot.text + length, room - length, format, args);
+    va_end(args);
+    if (suppressed > 0 && (size_t)length < room) {
+        length += snprintf(slot.text + length, room - length, " (+%lu suppressed)", (unsigned long)suppressed);
+    }
+    if ((size_t)length >= room) length = room - 1; // Truncated
+    slot.text[length++] = '\r';
+    slot.text[length++] = '\n';
+    slot.length = length;
+    writtenCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (drainTaskHandle == nullptr) {
+        // Early boot: no drain task yet, write through
+        Serial.write((const uint8_t*)slot.text, slot.length);
+        slot.sequence.store(index + 1, std::memory_order_release);
+        logTail.fetch_add(1, std::memory_order_acq_rel);
+        return;
+    }
+    slot.sequence.store(index + 1, std::memory_order_release);
+    xTaskNotifyGive(drainTaskHandle);
+}
+
+void logFlush() {
+    if (drainTaskHandle == nullptr) return;
+    while (logTail.load(std::memory_order_acquire) != logHead.load(std::memory_order_acquire)) {
+        xTaskNotifyGive(drainTaskHandle);
+        vTaskDelay(1);
+    }
+}
+
+LogStats logStats() {
+    LogStats stats;
+    stats.written = writtenCount.load(std::memory_order_relaxed);
+    stats.dropped = droppedCount.load(std::memory_order_relaxed);
+    stats.rateLimited = rateLimitedCount.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,209 @@
+#include <Arduino.h>
+#include "loop_watchdog.h"
+#include "log.h"
+
+const char* const loopStageNames[NUM_LOOP_STAGES] = {
+    "idle", "input", "ui", "pattern", "pwm", "sensors", "display",
+};
+
+// Stage start times of one iteration, kept for the current and the previous
+// one: an input that arrives mid-iteration can blow its budget in either.
+struct StageMark {
+    uint8_t stage;
+    uint32_t startUs;
+};
+const int maxStageMarks = 12;
+struct StageTimeline {
+    StageMark marks[maxStageMarks];
+    int count = 0;
+    uint32_t endUs = 0;
+};
+static StageTimeline timelines[2];
+static StageTimeline* current = &timelines[0];
+static StageTimeline* previous = &timelines[1];
+
+static uint32_t inputBudgetUs = LOOP_INPUT_BUDGET_MS * 1000UL;
+static uint32_t frameBudgetUs = LOOP_FRAME_BUDGET_MS * 1000UL;
+
+// First input event not yet picked up by an iteration (µs, low 32 bits of esp_timer)
+static portMUX_TYPE inputLock = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool inputPending = false;
+static volatile uint32_t inputPendingUs = 0;
+static bool iterationHasInput = false;
+static uint32_t iterationInputUs = 0;
+
+static uint32_t lastIterationMs = 0;
+static uint32_t lastInputHandledMs = 0;
+static LoopWatchdogStats watchdogStats;
+
+// Tasks whose stack high-water marks are reported
+static const char* const watchedTasks[] = {"loopTask", "ledOutput", "oledFlush", "logDrain", "pwmFade", "soakLog"};
+
+static uint32_t nowUs() {
+    return (uint32_t)esp_timer_get_time();
+}
+
+// Wrap-safe "a is at or after b" for 32-bit µs timestamps
+static bool atOrAfter(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) >= 0;
+}
+
+void loopWatchdogSetBudgets(uint32_t inputMs, uint32_t frameMs) {
+    inputBudgetUs = inputMs * 1000;
+    frameBudgetUs = frameMs * 1000;
+}
+
+void IRAM_ATTR loopWatchdogInputFromISR() {
+    portENTER_CRITICAL_ISR(&inputLock);
+    if (!inputPending) {
+        inputPendingUs = (uint32_t)esp_timer_get_time();
+        inputPending = true;
+    }
+    portEXIT_CRITICAL_ISR(&inputLock);
+}
+
+void loopWatchdogInput() {
+    portENTER_CRITICAL(&inputLock);
+    if (!inputPending) {
+        inputPendingUs = nowUs();
+        inputPending = true;
+    }
+    portEXIT_CRITICAL(&inputLock);
+}
+
+void loopWatchdogBeginIteration() {
+    portENTER_CRITICAL(&inputLock);
+    iterationHasInput = inputPending;
+    iterationInputUs = inputPendingUs;
+    inputPending = false;
+    portEXIT_CRITICAL(&inputLock);
+
+    current->count = 0;
+    loopWatchdogStage(LOOP_STAGE_INPUT); // Every iteration starts by reading inputs
+}
+
+void loopWatchdogStage(LoopStage stage) {
+    if (current->count >= maxStageMarks) return; // Later stages are charged to the last mark
+    if (current->count > 0 && current->marks[current->count - 1].stage == stage) return;
+    current->marks[current->count].stage = stage;
+    current->marks[current->count].startUs = nowUs();
+    current->count++;
+}
+
+// Stage running at time t, looking through the previous and current iteration
+static LoopStage stageAt(uint32_t t) {
+    const StageTimeline* searched[] = {previous, current};
+    for (const StageTimeline* timeline : searched) {
+        if (timeline->count == 0) continue;
+        if (!atOrAfter(t, timeline->marks[0].startUs) || atOrAfter(t, timeline->endUs)) continue;
+        int found = 0;
+        for (int i = 1; i < timeline->count && atOrAfter(t, timeline->marks[i].startUs); i++) {
+            found = i;
+        }
+        return (LoopStage)timeline->marks[found].stage;
+    }
+    return LOOP_STAGE_IDLE;
+}
+
+static void recordViolation(LoopBudgetViolation& violation, uint32_t deadlineUs, uint32_t latencyUs) {
+    violation.stage = stageAt(deadlineUs);
+    violation.latencyUs = latencyUs;
+    violation.atMs = millis();
+    watchdogStats.violationsByStage[violation.stage]++;
+}
+
+void loopWatchdogEndIteration() {
+    if (current->count == 0) return;
+    uint32_t endUs = nowUs();
+    current->endUs = endUs;
+    watchdogStats.iterations++;
+    lastIterationMs = millis();
+
+    uint32_t startUs = current->marks[0].startUs;
+    uint32_t busyUs = endUs - startUs;
+    if (busyUs > watchdogStats.maxIterationUs) watchdogStats.maxIterationUs = busyUs;
+    if (busyUs > frameBudgetUs) {
+        watchdogStats.frameViolations++;
+        recordViolation(watchdogStats.lastFrame, startUs + frameBudgetUs, busyUs);
+        LOG_WARN("Loop iteration took %lu us (budget %lu us), over in stage %s", (unsigned long)busyUs,
+                 (unsigned long)frameBudgetUs, loopStageNames[watchdogStats.lastFrame.stage]);
+    }
+
+    if (iterationHasInput) {
+        uint32_t latencyUs = endUs - iterationInputUs;
+        watchdogStats.inputsHandled++;
+        lastInputHandledMs = lastIterationMs;
+        if (latencyUs > watchdogStats.maxInputUs) watchdogStats.maxInputUs = latencyUs;
+        if (latencyUs > inputBudgetUs) {
+            watchdogStats.inputViolations++;
+            recordViolation(watchdogStats.lastInput, iterationInputUs + inputBudgetUs, latencyUs);
+            LOG_WARN("Input handled after %lu us (budget %lu us), over in stage %s", (unsigned long)latencyUs,
+                     (unsigned long)inputBudgetUs, loopStageNames[watchdogStats.lastInput.stage]);
+        }
+    }
+
+    StageTimeline* finished = current;
+    current = previous;
+    previous = finished;
+}
+
+LoopWatchdogStats loopWatchdogStats() {
+    return watchdogStats;
+}
+
+uint32_t loopWatchdogMsSinceIteration() {
+    return millis() - lastIterationMs;
+}
+
+uint32_t loopWatchdogMsSinceInput() {
+    return millis() - lastInputHandledMs;
+}
+
+uint32_t loopWatchdogMinStackFree() {
+    uint32_t minFree = UINT32_MAX;
+    for (const char* name : watchedTasks) {
+        TaskHandle_t task = xTaskGetHandle(name);
+        if (task == nullptr) continue;
+        uint32_t freeBytes = uxTaskGetStackHighWaterMark(task); // ESP-IDF reports bytes
+        if (freeBytes < minFree) minFree = freeBytes;
+    }
+    return minFree == UINT32_MAX ? 0 : minFree;
+}
+
+static void printViolation(const char* kind, const LoopBudgetViolation& violation) {
+    if (violation.atMs == 0) {
+        Serial.printf("Last %s violation: none\n", kind);
+    } else {
+        Serial.printf("Last %s violation: %lu us in stage %s, %lu ms ago\n", kind, (unsigned long)violation.latencyUs,
+                      loopStageNames[violation.stage], (unsigned long)(millis() - violation.atMs));
+    }
+}
+
+void printLoopWatchdog() {
+    LoopWatchdogStats stats = watchdogStats;
+    logFlush(); // Keep queued log lines ahead of the report
+    Serial.println("--- Loop Watchdog ---");
+    Serial.printf("Budgets: input %lu ms, frame %lu ms\n", (unsigned long)(inputBudgetUs / 1000), (unsigned long)(frameBudgetUs / 1000));
+    Serial.printf("Iterations: %lu, max %lu us, %lu over budget, last %lu ms ago\n", (unsigned long)stats.iterations,
+                  (unsigned long)stats.maxIterationUs, (unsigned long)stats.frameViolations, (unsigned long)loopWatchdogMsSinceIteration());
+    Serial.printf("Inputs: %lu handled, max %lu us, %lu over budget, last %lu ms ago\n", (unsigned long)stats.inputsHandled,
+                  (unsigned long)stats.maxInputUs, (unsigned long)stats.inputViolations, (unsigned long)loopWatchdogMsSinceInput());
+    printViolation("frame", stats.lastFrame);
+    printViolation("input", stats.lastInput);
+    Serial.print("Violations by stage:");
+    for (int stage = 0; stage < NUM_LOOP_STAGES; stage++) {
+        Serial.printf(" %s=%lu", loopStageNames[stage], (unsigned long)stats.violationsByStage[stage]);
+    }
+    Serial.println();
+
+    Serial.print("Stack free (min since start):");
+    for (const char* name : watchedTasks) {
+        TaskHandle_t task = xTaskGetHandle(name);
+        if (task == nullptr) continue;
+        Serial.printf(" %s=%lu", name, (unsigned long)uxTaskGetStackHighWaterMark(task));
+    }
+    Serial.println(" bytes");
+    Serial.printf("Heap: %lu free, %lu min free, %lu largest block\n", (unsigned long)ESP.getFreeHeap(),
+                  (unsigned long)ESP.getMinFreeHeap(), (unsigned long)ESP.getMaxAllocHeap());
+    Serial.println("---------------------");
+}
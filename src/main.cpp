@@ -1,13 +1,32 @@
 #include <Arduino.h>
 #include <FastLED.h>
 #include <Wire.h>
-#include <BH1750.h>
-#include <Adafruit_INA219.h>
 #include <U8g2lib.h>
 #include <ESP32Encoder.h>
 #include <Preferences.h>
+#include <utility>
 
 #include "fastled.h"
+#include "patterns.h"
+#include "led_output.h"
+#include "self_test.h"
+#include "led_count_detect.h"
+#include "power_model.h"
+#include "display_flush.h"
+#include "log.h"
+#include "board_drivers.h"
+#include "rgbw.h"
+#include "bench.h"
+#include "loop_watchdog.h"
+#include "board.h"
+#include "pwm_leds.h"
+#include "sync_link.h"
+#include "boot_timing.h"
+#include "led_segments.h"
+#include "pixel_stream_link.h"
+#include "soak_log.h"
+#include "i2c_topology.h"
+#include "encoder_accel.h"
 
 // --- Logo Bitmap ---
 // 'favicon-32x32, 32x32px
@@ -27,28 +46,14 @@ const unsigned char logo_bitmap_32x32[] PROGMEM = {
 #define PROGRAM_VERSION "1.1.0"
 // --- End Program Info ---
 
-#define SDA_PIN 14
-#define SCL_PIN 13
-#define USER_BUTTON_PIN 33
-#ifndef LED1_PIN // Add default if not defined by build flag (for linter)
-  #define LED1_PIN 21
-#endif
-#define LED2_PIN 22
-#define LED3_PIN 19
-#define LED4_PIN 23
-#define ROT_ENC_A_PIN 26
-#define ROT_ENC_B_PIN 27
-#define ROT_ENC_BUTTON_PIN 18
-#define BOOT_BUTTON_PIN 0
-
-#ifndef MAX_LEDS // Max buffer size, defined by build flag or default (linter)
-  #define MAX_LEDS 1000 // Increased buffer size
-#endif
-CRGB leds[MAX_LEDS];
-BH1750 lightMeter; // Default address 0x23
-Adafruit_INA219 ina219; // Default address 0x40
+// Pins and peripherals come from the board profile (see board.h)
+
+// LED frame buffers live in led_output.cpp (double-buffered, MAX_LEDS each)
+LightMeter lightMeter; // Default address 0x23; a stand-in on boards without one (board_drivers.h)
+CurrentSensor ina219; // Default address 0x40, calibrated for the strip shunt
 int numLedsConfigured = MAX_LEDS; // Active LED count, default to max
 int numLedsProposed = MAX_LEDS;   // Temp variable for selection screen
+int numLedsDetected = -1;         // Result of the last LED count auto-detect (-1 if not run)
 
 // U8g2 Display Setup (using Hardware I2C)
 // Choose constructor based on display: https://github.com/olikraus/u8g2/wiki/u8g2setupcpp
@@ -56,6 +61,15 @@ int numLedsProposed = MAX_LEDS;   // Temp variable for selection screen
 U8G2_SSD1306_128X32_UNIVISION_F_HW_I2C u8g2(U8G2_R0, /* reset=*/ U8X8_PIN_NONE);
 bool displayAvailable = false; // Flag to track if display is detected
 
+// Timed display overlay (e.g. "Saved! Reboot!"), drawn instead of the normal UI until it expires
+bool overlayActive = false;
+unsigned long overlayUntil = 0;
+const char* overlayLine1 = "";
+const char* overlayLine2 = "";
+const unsigned long savedOverlayDuration = 2000; // Show save confirmations for 2 seconds
+const unsigned long espInfoPageMs = 2000; // ESP Info screen page duration
+const unsigned long i2cScanPageMs = 2000; // I2C Scanner: time each found device is shown
+
 // --- State Management Structs ---
 struct InputState {
     // Rotary Encoder - REMOVED, using ESP32Encoder library
@@ -82,12 +96,12 @@ struct InputState {
 struct LedPwmState {
     bool isOn = false;
     int brightness = 50; // 0-255
+    PwmEffect effect = PWM_EFFECT_STEADY; // Breathe/blink run on the LEDC fade unit
 };
 
 struct FastLedState {
     bool isOn = true; // Default FastLED strip to on
     int brightness = 30; // Default brightness set to 30
-    uint8_t hue = 0; // For animation state
 };
 
 InputState inputState;
@@ -97,46 +111,37 @@ FastLedState fastLedState;
 // long encoderAccumulator = 0; // REMOVED, using ESP32Encoder library
 ESP32Encoder encoder; // Encoder library object
 long lastEncoderCount = 0; // Track last count from encoder library
+EncoderVelocity encoderVelocity; // Turning speed from the count changes
+float encoderSpeed = 0; // Steps per second of this loop's encoder change; 0 for serial and button steps
+// Acceleration per value type (encoder_accel.h)
+const EncoderCurve ledCountCurve = {ENCODER_CURVE_DECADE, 1, MAX_LEDS, 0};
+const EncoderCurve brightnessCurve = {ENCODER_CURVE_PERCEPTUAL, 0, 255, 64};
 Preferences preferences; // Preferences object for NVM storage
 
-// Define Chipset Types
-const int CHIPSET_TYPE_WS2812 = 0;
-const int CHIPSET_TYPE_SK6812 = 1;
-const int NUM_CHIPSET_TYPES = 2; // Total number of options
-const char* chipsetNames[] = {"WS2812", "SK6812"};
-int savedChipsetType = CHIPSET_TYPE_WS2812; // Variable to hold loaded/saved type, default WS2812
+// Chipset types are numbered in board.h
+const char* chipsetNames[] = {"WS2812", "SK6812", "SK6812 RGBW"};
+int savedChipsetType = Board::defaultChipset; // Variable to hold loaded/saved type
 int chipsetSelectionProposed = 0; // Temp variable for selection screen
+int savedLedSegments = 1; // Data pins the strip is split over (1..Board::numLedDataPins), saved in NVS
 
-// Define FastLED Patterns
-enum FastLedPattern {
-  RAINBOW,
-  RGB_CHECKER,
-  CHASE // Added Chase pattern
-};
-const int NUM_FASTLED_PATTERNS = 3; // Increased count
-const char* patternNames[] = {"Rainbow", "RGB Check", "Chase"}; // Added Chase
+// Power calibration table for the saved chipset (see power_model.h)
+PowerCalibration powerCalibration = {};         // Loaded from NVS, version 0 if uncalibrated
+PowerCalibration powerCalibrationProposed = {}; // Result of the last calibration run
+int powerCalibrationErrorPct = -1;              // Verification error of the proposed table (-1 if not run)
+bool powerCalibrationPassed = false;            // Proposed table is within tolerance and may be saved
+
+// FastLED Patterns (see patterns.h, each pattern is a pure function of time)
 FastLedPattern currentFastLedPattern = RAINBOW; // Default pattern
 int patternSelectionProposed = 0; // Temp variable for pattern selection screen
+uint32_t patternEpoch = 0; // Pattern clock value when the current pattern was started
+uint32_t lastCheckerPulseLogged = UINT32_MAX; // Start time of the last RGB Check pulse logged
+SyncRole savedSyncRole = SYNC_ROLE_OFF; // Role on the controller chain, saved in NVS
+bool savedSoakLog = false; // Log sensor and power records to flash, saved in NVS
 
-// State for RGB Checker Pattern
-int rgbCheckerStage = 0; // 0=Red, 1=Green, 2=Blue
-int rgbCheckerPulseCount = 0;
-unsigned long lastRgbCheckerActionTime = 0;
-const int pulseOnTime = 500; // ms
-const int pulseOffTime = 250; // ms
-const int interColorDelay = 600; // ms
-bool rgbCheckerLedState = false; // false = off, true = on
-
-// State for Chase Pattern
-// int chasePixelIndex = 0; // REMOVED - Not used in wave logic
-// int chaseBrightness = 0; // REMOVED - Not used in wave logic
-// bool chaseFadingUp = true; // REMOVED - Not used in wave logic
-unsigned long lastChaseUpdateTime = 0;
-const int chaseStepDelay = 2; // ms between position updates (was 10)
-float chasePosition = 0.0;    // Floating point position for smooth movement
-const int chaseFadeRate = 100; // Brightness decrease per pixel distance (Higher = narrower wave)
-
-int lastI2cDeviceCount = -1; // Store result of last I2C scan (-1 if not scanned)
+I2cScanResult lastI2cScan; // Result of the last I2C scan
+bool i2cScanned = false;   // lastI2cScan holds a scan
+int i2cScanPage = 0;       // Device the I2C Scanner screen shows
+int32_t savedI2cTopology = -1; // Parts found at the last boot (i2c_topology.h), saved in NVS
 
 unsigned long lastInteractionTime = 0; // Track time of last user interaction
 const unsigned long idleTimeoutDuration = 60000; // 1 minute in milliseconds
@@ -163,23 +168,26 @@ enum AppMode {
   LED_CHIPSET_SELECT, // Added mode for selecting LED chipset
   FASTLED_PATTERN, // Added mode for selecting FastLED pattern
   LED_COUNT_SELECT, // Added mode for selecting LED count
-  ESP_INFO // Moved to last
+  LED_COUNT_DETECT, // Auto-detect LED count from INA219 current
+  POWER_CALIBRATION, // Fit the per-chipset power table from an INA219 sweep
+  ESP_INFO, // Moved to last
+  NUM_APP_MODES
 };
 
-const char* modeNames[] = {
-  "FastLED Test", // Updated order
-  "LED2 Brightness",
-  "LED3 Brightness",
-  "LED4 Brightness",
-  "BH1750 Sensor", 
-  "INA219 Sensor", 
-  "I2C Scanner",
-  "LED Chipset", // Name for the new mode
-  "LED Pattern", // Name for the new mode
-  "LED Count",   // Name for the LED count mode
-  "ESP Info" // Updated order
+// Everything a mode does, in one place. loop() and updateDisplay() dispatch
+// through modeTable[currentMode]; a null hook means the mode has nothing to do.
+struct ModeDescriptor {
+  const char* name;                                    // Menu entry and line 1 of the action screen
+  bool available;                                      // Board has the hardware (see board.h); else left off the menu
+  void (*enter)();                                     // On selection from the menu
+  void (*encoder)(long steps);                         // Encoder turned while active
+  void (*button)();                                    // Encoder button pressed, before returning to the menu
+  void (*render)(char* line1, char* line2, size_t size); // Fill the action screen; line1 starts as the name
+  void (*tick)();                                      // Every refreshMs while active, before the redraw
+  unsigned long refreshMs;                             // Redraw period while active (0 = only on change)
 };
-const int numModes = sizeof(modeNames) / sizeof(modeNames[0]);
+extern const ModeDescriptor modeTable[NUM_APP_MODES]; // Defined with the mode handlers below
+const int numModes = NUM_APP_MODES;
 
 UIState currentState = MENU;
 AppMode currentMode = FASTLED_TEST; // Default mode changed to FastLED Test
@@ -194,6 +202,7 @@ const int pwmResolution = 8; // 8-bit resolution (0-255)
 const int ledcChannel2 = 0;
 const int ledcChannel3 = 1;
 const int ledcChannel4 = 2;
+const int pwmLedChannels[] = {ledcChannel2, ledcChannel3, ledcChannel4};
 
 // Rotary Encoder State
 // volatile long encoderValue = 0; // Removed
@@ -207,14 +216,67 @@ const int ledcChannel4 = 2;
 unsigned long debounceDelay = 50;    // debounce time; increase if bouncing seen
 
 // Light Sensor Timer
-unsigned long lastSensorReadTime = 0; // Renamed from lastLightReadTime
-const unsigned long sensorReadInterval = 2000; // 2 seconds
+const unsigned long sensorReadInterval = 2000; // 2 seconds, the sensor screens' refresh period
 float lastLuxValue = -1.0; // Store last sensor value for display
 float lastBusVoltage = 0.0, lastCurrentMa = 0.0; // Store last INA values for display
 // --- End Restore Deleted Declarations ---
 
+// --- Event Loop State ---
+// loop() blocks on a task notification until an input ISR fires, serial data
+// arrives, or the next deadline (pattern frame, sensor sample, debounce, idle
+// timeout) is due. Nothing is polled in the steady state.
+TaskHandle_t loopTaskHandle = nullptr; // Task running setup()/loop(), target of notifications
+const unsigned long maxLoopSleepMs = 1000; // Upper bound on a single wait, keeps the loop alive
+unsigned long nextPatternFrameTime = 0; // millis() when the active pattern wants its next frame
+unsigned long nextModeRefreshTime = 0; // millis() when the active mode is next ticked and redrawn
+unsigned long nextSoakSampleTime = 0; // millis() when the next soak log record is due
+
+struct LoopStats {
+    uint32_t iterations = 0;      // loop() passes since last report
+    uint32_t eventWakeups = 0;    // Woken by an input/serial notification
+    uint32_t deadlineWakeups = 0; // Woken because a deadline expired
+    uint32_t patternFrames = 0;   // Pattern functions invoked
+    uint32_t pwmWrites = 0;       // Fade/effect requests actually issued
+    uint64_t idleUs = 0;          // Time spent blocked waiting for work
+    uint64_t windowStartUs = 0;   // Start of the current reporting window
+};
+LoopStats loopStats;
+
+int lastPwmDuty[3] = {-1, -1, -1}; // Last duty requested per PWM LED (-1 = never requested)
+PwmEffect lastPwmEffect[3] = {PWM_EFFECT_STEADY, PWM_EFFECT_STEADY, PWM_EFFECT_STEADY};
+// --- End Event Loop State ---
+
+// --- Boot ---
+// With FAST_BOOT the strip is lit from the saved settings first, and the
+// display and sensors are initialized by a background task while setup() and
+// loop() carry on. FAST_BOOT=0 initializes everything in order and waits for
+// the serial monitor, for reading the whole boot log.
+#ifndef FAST_BOOT
+  #define FAST_BOOT 1
+#endif
+
+const uint32_t bootInitTaskStackSize = 4096;
+const UBaseType_t bootInitTaskPriority = 1;
+const BaseType_t bootInitTaskCore = 0;
+volatile bool peripheralsReady = false; // Display and sensors are initialized
+bool bootFinished = false;              // loop() has printed the boot report
+bool bootSelfTestRequested = false;     // User button held at power-up
+uint32_t firstFrameUs = 0;              // When the first pattern frame was handed to the strip
+
+const unsigned long splashAnimationMs = 2000; // Static noise before the logo
+const unsigned long splashFrameMs = 30;
+bool splashAnimationActive = false;
+unsigned long splashAnimationUntil = 0;
+unsigned long nextSplashFrameTime = 0;
+
+void waitForPeripherals();
+void updateDisplay();
+void showOverlay(const char* line1, const char* line2, unsigned long durationMs);
+// --- End Boot ---
+
 // --- Helper Functions ---
 void printEspInfo() {
+    logFlush(); // Keep queued log lines ahead of the report
     Serial.println("--- ESP Chip Info ---");
     Serial.printf("Chip ID: %04X", (uint16_t)(ESP.getEfuseMac()>>32));
     Serial.printf("%08X\n", (uint32_t)ESP.getEfuseMac());
@@ -224,114 +286,239 @@ void printEspInfo() {
     Serial.println("---------------------");
 }
 
+// Wakes loop() from a GPIO interrupt (encoder edges, buttons)
+void IRAM_ATTR notifyLoopFromISR() {
+    loopWatchdogInputFromISR(); // Input latency is measured from here
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(loopTaskHandle, &higherPriorityTaskWoken);
+    if (higherPriorityTaskWoken) { portYIELD_FROM_ISR(); }
+}
+
+// Wakes loop() when the UART driver has received data (runs in the UART event task)
+void notifyLoopFromSerial() {
+    loopWatchdogInput();
+    xTaskNotifyGive(loopTaskHandle);
+}
+
+// Print loop counters for the window since the last report, then start a new window
+void printLoopStats() {
+    uint64_t nowUs = esp_timer_get_time();
+    uint64_t windowUs = nowUs - loopStats.windowStartUs;
+    unsigned long idlePermille = windowUs > 0 ? (unsigned long)(loopStats.idleUs * 1000 / windowUs) : 0;
+    LogStats log = logStats();
+    logFlush(); // Keep queued log lines ahead of the report
+    Serial.println("--- Loop Stats ---");
+    Serial.printf("Window: %lu ms\n", (unsigned long)(windowUs / 1000));
+    Serial.printf("Iterations: %lu (%lu/s)\n", (unsigned long)loopStats.iterations,
+                  windowUs > 0 ? (unsigned long)(loopStats.iterations * 1000000ULL / windowUs) : 0UL);
+    Serial.printf("Wakeups: %lu event, %lu deadline\n", (unsigned long)loopStats.eventWakeups, (unsigned long)loopStats.deadlineWakeups);
+    Serial.printf("Pattern frames: %lu, PWM writes: %lu\n", (unsigned long)loopStats.patternFrames, (unsigned long)loopStats.pwmWrites);
+    if constexpr (Board::hasPwmLeds) {
+        PwmLedStats pwm = pwmLedsStats();
+        Serial.printf("PWM fades: %lu requests (%lu unchanged, %lu replaced), %lu duty sets, %lu fades, %lu fade ends, %lu task wakeups\n",
+                      (unsigned long)pwm.sequencer.requests, (unsigned long)pwm.sequencer.unchanged,
+                      (unsigned long)pwm.sequencer.replaced, (unsigned long)pwm.sequencer.dutySets,
+                      (unsigned long)pwm.sequencer.fades, (unsigned long)pwm.fadeEndEvents, (unsigned long)pwm.wakeups);
+    }
+    Serial.printf("Idle: %lu.%lu%%\n", idlePermille / 10, idlePermille % 10);
+    if (displayAvailable) {
+        DisplayFlushStats display = displayFlushStats();
+        Serial.printf("Display: %lu posted, %lu unchanged, %lu dropped, %lu sent (last %lu us)\n",
+                      (unsigned long)display.posted, (unsigned long)display.unchanged, (unsigned long)display.dropped,
+                      (unsigned long)display.flushed, (unsigned long)display.lastFlushUs);
+    }
+    if constexpr (Board::hasCurrentSensor) {
+        Ina219Stats ina = ina219.stats();
+        Serial.printf("INA219: %lu conversions read, %lu polls not ready, %lu register reads, %lu writes\n",
+                      (unsigned long)ina.conversions, (unsigned long)ina.notReady,
+                      (unsigned long)ina.registerReads, (unsigned long)ina.registerWrites);
+    }
+    if constexpr (Board::hasSyncPort) {
+        if (syncLinkRole() != SYNC_ROLE_OFF) {
+            SyncNodeStats node;
+            SyncClockStats clock;
+            bool following;
+            syncLinkStats(node, clock, following);
+            Serial.printf("Sync: %s, %lu beacons in, %lu out, %lu CRC errors, %lu too far\n", syncRoleNames[syncLinkRole()],
+                          (unsigned long)node.received, (unsigned long)node.sent, (unsigned long)node.crcErrors, (unsigned long)node.tooFar);
+            if (syncLinkRole() == SYNC_ROLE_FOLLOWER) {
+                Serial.printf("Sync clock: %s, hops %u, offset %lld us, drift %.3f ppm, error last %ld us, worst %ld us, %lu outliers, %lu steps\n",
+                              following ? "locked" : "searching", node.hops, (long long)clock.offsetUs, clock.driftPpb / 1000.0f,
+                              (long)clock.lastErrorUs, (long)clock.worstErrorUs, (unsigned long)clock.outliers, (unsigned long)clock.steps);
+            }
+        }
+    }
+    if (soakLogEnabled()) { soakLogPrintStats(); }
+    Serial.printf("Log: %lu queued, %lu dropped, %lu rate-limited\n",
+                  (unsigned long)log.written, (unsigned long)log.dropped, (unsigned long)log.rateLimited);
+    Serial.println("------------------");
+    loopStats = LoopStats();
+    loopStats.windowStartUs = nowUs;
+}
+
+// Request a PWM LED change only if its duty or effect actually changed. Brightness
+// steps and toggles fade in hardware, over a time proportional to the step.
+void writePwmIfChanged(int ledIndex, const LedPwmState& state) {
+    int duty = state.isOn ? state.brightness : 0;
+    PwmEffect effect = duty > 0 ? state.effect : PWM_EFFECT_STEADY;
+    if (duty == lastPwmDuty[ledIndex] && effect == lastPwmEffect[ledIndex]) return;
+
+    if (effect == PWM_EFFECT_STEADY) {
+        uint8_t fromDuty = lastPwmDuty[ledIndex] < 0 ? 0 : lastPwmDuty[ledIndex];
+        pwmLedsFadeTo(ledIndex, duty, pwmFadeTimeMs(fromDuty, duty));
+    } else {
+        pwmLedsPlay(ledIndex, effect, duty);
+    }
+    lastPwmDuty[ledIndex] = duty;
+    lastPwmEffect[ledIndex] = effect;
+    loopStats.pwmWrites++;
+}
+
+// Bring LED2-4 in line with their states (nothing on boards without them)
+void writePwmLeds() {
+    if constexpr (Board::hasPwmLeds) {
+        writePwmIfChanged(0, led2State);
+        writePwmIfChanged(1, led3State);
+        writePwmIfChanged(2, led4State);
+    }
+}
+
+// Returns true if a debounced button still has an unsettled reading to resolve
+bool debouncePending(int lastReading, int settledState, unsigned long lastDebounceTime, unsigned long& deadline) {
+    if (lastReading == settledState) return false;
+    deadline = lastDebounceTime + debounceDelay + 1;
+    return true;
+}
+
+// Milliseconds until loop() has scheduled work to do (0 = run again immediately)
+unsigned long msUntilNextDeadline() {
+    unsigned long now = millis();
+    unsigned long wait = maxLoopSleepMs;
+    unsigned long deadline;
+
+    // Fold a deadline into the wait, treating past-due deadlines as immediate
+    auto consider = [&](unsigned long due) {
+        long remaining = (long)(due - now);
+        if (remaining <= 0) { wait = 0; }
+        else if ((unsigned long)remaining < wait) { wait = remaining; }
+    };
+
+    if (fastLedState.isOn && !pixelStreamActive()) { consider(nextPatternFrameTime); }
+    if (ledOutputNextRefresh(deadline)) { consider(deadline); }
+    if (Board::hasEncoder && debouncePending(inputState.rotLastButtonState, inputState.rotButtonState, inputState.rotLastDebounceTime, deadline)) { consider(deadline); }
+    if (debouncePending(inputState.userLastButtonState, inputState.userButtonState, inputState.userLastDebounceTime, deadline)) { consider(deadline); }
+    if (debouncePending(inputState.bootLastButtonState, inputState.bootButtonState, inputState.bootLastDebounceTime, deadline)) { consider(deadline); }
+    if (currentState == MENU) { consider(lastInteractionTime + idleTimeoutDuration + 1); }
+    if (overlayActive) { consider(overlayUntil); }
+    if (splashAnimationActive) { consider(nextSplashFrameTime); }
+    if (currentState == ACTION && modeTable[currentMode].refreshMs > 0) { consider(nextModeRefreshTime); }
+    if (Board::hasSyncPort && syncLinkRole() == SYNC_ROLE_LEADER) { consider(now + syncLinkMsUntilDue(maxLoopSleepMs)); }
+    if (pixelStreamActive()) { consider(now + pixelStreamMsUntilDue(maxLoopSleepMs)); }
+    if (soakLogReady()) { consider(nextSoakSampleTime); }
+    return wait;
+}
+
+// Block until an input notification arrives or the next deadline is due
+void waitForNextEvent() {
+    unsigned long waitMs = msUntilNextDeadline();
+    if (waitMs == 0) return;
+    uint64_t startUs = esp_timer_get_time();
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs)) > 0) {
+        loopStats.eventWakeups++;
+    } else {
+        loopStats.deadlineWakeups++;
+    }
+    loopStats.idleUs += esp_timer_get_time() - startUs;
+}
+
 void readAndPrintLightSensor() {
-    if (millis() - lastSensorReadTime >= sensorReadInterval) {
+    if constexpr (Board::hasLightSensor) { // Mode is not on this board's menu otherwise
         lastLuxValue = lightMeter.readLightLevel(); // Store value
-        if (lastLuxValue < 0) { Serial.println(F("Error reading BH1750")); }
-        else { Serial.print("Light: "); Serial.print(lastLuxValue); Serial.println(" lx"); }
-        lastSensorReadTime = millis();
+        if (lastLuxValue < 0) { LOG_ERROR("Error reading BH1750"); }
+        else { LOG_INFO("Light: %.2f lx", lastLuxValue); }
     }
 }
 
+// Strip current in mA from a fresh conversion, averaged on-chip per the active profile
+float readCurrentMa() {
+    if (!ina219.measure()) { LOG_WARN("INA219 conversion timed out"); }
+    return ina219.last().currentUa / 1000.0f;
+}
+
 void readAndPrintIna219() {
-    if (millis() - lastSensorReadTime >= sensorReadInterval) {
-        lastBusVoltage = ina219.getBusVoltage_V(); // Store for display
-        float shuntvoltage = ina219.getShuntVoltage_mV();  // in mV
-        lastCurrentMa = shuntvoltage * 100.0; // Store for display (crude calculation for example)
-        float loadvoltage = lastBusVoltage + (shuntvoltage / 1000.0); // in V
-        float power_mW = lastBusVoltage * lastCurrentMa;          // V * mA = mW
-
-        // Format Bus Voltage (already in V)
-        Serial.print("Bus: ");
-        Serial.print(lastBusVoltage, 2);
-        Serial.print("V");
-
-        // Format Shunt Voltage (always in mV for INA219)
-        Serial.print(" | Shunt: ");
-        Serial.print(shuntvoltage, 2);
-        Serial.print("mV");
-
-        // Format Load Voltage (already in V)
-        Serial.print(" | Load: ");
-        Serial.print(loadvoltage, 2);
-        Serial.print("V");
+    if constexpr (Board::hasCurrentSensor) { // Mode is not on this board's menu otherwise
+        ina219.poll(); // Only reads the results if a conversion finished since the last read
+        const Ina219Sample& sample = ina219.last();
+        lastBusVoltage = sample.busMv / 1000.0f; // Store for display
+        lastCurrentMa = sample.currentUa / 1000.0f; // Store for display
+        float shuntvoltage = sample.shuntUv / 1000.0f;  // in mV
+        float loadvoltage = ((int64_t)sample.busMv * 1000 + sample.shuntUv) / 1e6f; // in V; signed, the shunt can read negative
+        float power_mW = sample.powerUw / 1000.0f;      // From the chip's power register
+
+        // Format the whole reading into one line, then queue it in one go
+        char line[112];
+        int len = snprintf(line, sizeof(line), "Bus: %.2fV | Shunt: %.2fmV | Load: %.2fV", lastBusVoltage, shuntvoltage, loadvoltage);
 
         // Format Current with adaptive units (mA or A)
-        Serial.print(" | Current: ");
         if (abs(lastCurrentMa) >= 500.0) {
-            Serial.print(lastCurrentMa / 1000.0, 2); // Convert to A with 2 decimal places
-            Serial.print("A");
+            len += snprintf(line + len, sizeof(line) - len, " | Current: %.2fA", lastCurrentMa / 1000.0);
         } else {
-            Serial.print(lastCurrentMa, 1); // Keep as mA with 1 decimal place
-            Serial.print("mA");
+            len += snprintf(line + len, sizeof(line) - len, " | Current: %.1fmA", lastCurrentMa);
         }
 
         // Format Power with adaptive units (mW or W)
-        Serial.print(" | Power: ");
         if (abs(power_mW) >= 500.0) {
-            Serial.print(power_mW / 1000.0, 2); // Convert to W with 2 decimal places
-            Serial.print("W");
+            len += snprintf(line + len, sizeof(line) - len, " | Power: %.2fW", power_mW / 1000.0);
         } else {
-            Serial.print(power_mW, 1); // Keep as mW with 1 decimal place
-            Serial.print("mW");
+            len += snprintf(line + len, sizeof(line) - len, " | Power: %.1fmW", power_mW);
         }
 
-        Serial.println();
-        lastSensorReadTime = millis();
+        // Model prediction for the frame currently on the strip
+        if (powerCalibration.version == powerCalibrationVersion && len < (int)sizeof(line)) {
+            snprintf(line + len, sizeof(line) - len, " | Predicted: %lumA",
+                     (unsigned long)predictFrameMa(ledOutputFrontBuffer(), numLedsConfigured, ledOutputFrontBrightness(), powerCalibration,
+                                                    savedChipsetType == CHIPSET_TYPE_SK6812_RGBW));
+        }
+
+        LOG_INFO("%s", line);
     }
 }
 
-int scanI2CBus() {
-  byte error, address;
-  int nDevices;
+// Save the I2C topology if it changed; callable from the boot task, so it uses its own handle
+void saveI2cTopology(const I2cTopology& topology) {
+  int32_t stored = encodeI2cTopology(topology);
+  if (stored == savedI2cTopology) return;
+  Preferences topologyPrefs;
+  topologyPrefs.begin("led-config", false);
+  topologyPrefs.putInt("i2cTopology", stored);
+  topologyPrefs.end();
+  savedI2cTopology = stored;
+}
 
+I2cScanResult scanI2CBus() {
+  logFlush(); // Keep queued log lines ahead of the report
   Serial.println("Scanning I2C bus...");
-
-  nDevices = 0;
-  for(address = 1; address < 127; address++ ) {
-    // The i2c_scanner uses the return value of
-    // the Write.endTransmisstion to see if
-    // a device did acknowledge to the address.
-    Wire.beginTransmission(address);
-    error = Wire.endTransmission();
-
-    if (error == 0) {
-      Serial.print("I2C device found at address 0x");
-      if (address < 16)
-        Serial.print("0");
-      Serial.print(address, HEX);
-      Serial.println(" !");
-      nDevices++;
-    } else if (error == 4) {
-      Serial.print("Unknown error at address 0x");
-      if (address < 16)
-        Serial.print("0");
-      Serial.println(address, HEX);
-    }    
+  I2cScanResult scan = i2cScanBus(Wire, currentSensorDriver(ina219));
+
+  I2cTopology topology;
+  for (int i = 0; i < scan.count; i++) {
+    const char* name = scan.kinds[i] >= 0 ? i2cKnownDevices[scan.kinds[i]].name : "unknown";
+    Serial.printf("I2C DEVICE address=0x%02X name=%s signature=%s\n", scan.addresses[i], name,
+                  scan.kinds[i] >= 0 ? i2cMatchNames[scan.matches[i]] : "none");
+    if (scan.kinds[i] >= 0) { topology.devices[scan.kinds[i]] = scan.matches[i]; }
   }
-  if (nDevices == 0)
-    Serial.println("No I2C devices found\n");
-  else
-    Serial.println("Scan complete.\n");
-
-  return nDevices;
+  Serial.printf("I2C SCAN devices=%d\n", scan.count);
+  saveI2cTopology(topology); // The next boot starts from what is on the bus now
+  return scan;
 }
 
-// Function to play startup static animation
-void playStaticAnimation() {
-    if (!displayAvailable) return;
-
-    Serial.println("Playing static animation...");
-    unsigned long startTime = millis();
-    while (millis() - startTime < 2000) { // Animate for 2 seconds
-        u8g2.clearBuffer();
-        for (int i = 0; i < 100; i++) { // Draw 100 random pixels per frame
-            u8g2.drawPixel(random(u8g2.getDisplayWidth()), random(u8g2.getDisplayHeight()));
-        }
-        u8g2.sendBuffer();
-        delay(30); // Frame delay
+// One frame of the startup static animation
+void drawStaticFrame() {
+    u8g2.clearBuffer();
+    for (int i = 0; i < 100; i++) { // Draw 100 random pixels per frame
+        u8g2.drawPixel(random(u8g2.getDisplayWidth()), random(u8g2.getDisplayHeight()));
     }
-    Serial.println("Static animation complete.");
+    displayPost();
 }
 
 // Function to display the splash screen
@@ -351,335 +538,946 @@ void displaySplashScreen() {
     u8g2.drawStr(textX, textY1, "Solid");
     u8g2.drawStr(textX, textY2, "Difference");
     
-    u8g2.sendBuffer(); // Send splash screen to display
+    displayPost(); // Send splash screen to display
 }
 
-// --- End Helper Functions ---
+// Run the batch board self-test, then hand LEDs back to the normal outputs
+bool runBoardSelfTest() {
+    waitForPeripherals();
+    if (displayAvailable) {
+        u8g2.clearBuffer();
+        u8g2.setFont(u8g2_font_profont22_tf);
+        u8g2.drawStr(0, 14, "Self Test");
+        u8g2.drawStr(0, 30, "Running...");
+        displayPost();
+    }
 
-// --- Forward Declarations for Pattern Functions ---
-void runRainbowPattern();
-void runRgbCheckerPattern();
-void runChasePattern();
-// --- End Forward Declarations ---
+    logFlush(); // The report is written straight to Serial
+    int savedLength = ledOutputLength();
+    ledOutputSetLength(MAX_LEDS); // Check the whole buffer, not only the saved count
+    bool pwmPaused = true;
+    if constexpr (Board::hasPwmLeds) { pwmPaused = pwmLedsPause(); } // The sweep writes the channels directly
+    if (!pwmPaused) { LOG_WARN("Self-test: PWM fade task didn't pause, skipping the sweep"); }
+    SelfTestContext ctx = {lightMeter, ina219, Board::hasCurrentSensor ? readCurrentMa : nullptr,
+                           pwmLedChannels, Board::hasPwmLeds ? 3 : 0, pwmPaused, ledOutputLength()};
+    if constexpr (Board::hasCurrentSensor) { ina219.setProfile(INA219_PROFILE_PROBE); }
+    bool passed = runSelfTest(ctx);
+    if constexpr (Board::hasCurrentSensor) { ina219.setProfile(INA219_PROFILE_MONITOR); }
+    ledOutputSetLength(savedLength);
+
+    // The sweep and strip check drove the outputs directly; force a rewrite
+    if constexpr (Board::hasPwmLeds) { pwmLedsResume(); }
+    for (int i = 0; i < 3; i++) { lastPwmDuty[i] = -1; }
+    writePwmLeds();
+    nextPatternFrameTime = millis();
+    return passed;
+}
 
-void setup() {
-  Serial.begin(115200);
-  delay(1000); // Wait for serial monitor
-  Serial.println("\n\n--- Solid Difference Clock Controller Test Program ---");
-  Serial.print("Version: "); Serial.println(PROGRAM_VERSION);
-  Serial.print("Build Date: "); Serial.print(__DATE__); Serial.print(" "); Serial.println(__TIME__);
-  Serial.println("-------------------------------------------------");
-  Serial.println("Setup starting...");
+// --- LED Count Auto-Detection ---
+const float autoDetectMinLitDeltaMa = 20.0; // Two INA219 steps at 1 mΩ; a lit full-white pixel draws 35 mA or more
+const unsigned long autoDetectSettleMs = 10; // Supply settle time after the frame is on the wire
+const int autoDetectBaselineReads = 4;       // Every probe is judged against the baseline, so it gets the averaging
+float autoDetectBaselineMa = 0;              // Current with the whole strip dark
+
+// Light only one pixel at full white and return the current rise over the dark strip
+float probeSinglePixel(int index, void* context) {
+    CRGB* frame = ledOutputBeginFrame();
+    fill_solid(frame, MAX_LEDS, CRGB::Black);
+    frame[index] = CRGB::White;
+    ledOutputPresent(255);
+    ledOutputFlush();
+    delay(autoDetectSettleMs);
+    float deltaMa = readCurrentMa() - autoDetectBaselineMa;
+    LOG_AT(LOG_LEVEL_INFO, 0, "Probe LED %d: %.1f mA", index + 1, deltaMa);
+    return deltaMa;
+}
+
+// Binary-search the working strip length; returns the number of LEDs that light up
+int runLedCountDetect() {
+    LOG_INFO("Auto-detecting LED count...");
+    unsigned long startTime = millis();
+    int savedLength = ledOutputLength();
+    ledOutputSetLength(MAX_LEDS); // Send the whole buffer so a strip longer than the saved count is found
+    int searchLeds = ledOutputLength();
+    ledOutputClear();
+    ledOutputFlush();
+    delay(autoDetectSettleMs);
+    ina219.setProfile(INA219_PROFILE_PROBE); // 16x on-chip averaging, ~9 ms per probe
+    autoDetectBaselineMa = 0;
+    for (int i = 0; i < autoDetectBaselineReads; i++) { autoDetectBaselineMa += readCurrentMa() / autoDetectBaselineReads; }
+
+    LedCountDetectResult result = detectLedCount(searchLeds, autoDetectMinLitDeltaMa, probeSinglePixel, nullptr);
+    ina219.setProfile(INA219_PROFILE_MONITOR);
+
+    ledOutputClear();
+    ledOutputSetLength(savedLength);
+    nextPatternFrameTime = millis(); // Give the strip back to the active pattern
+    if (result.workingLeds < searchLeds) {
+        LOG_INFO("Detected %d working LEDs in %d measurements (%lu ms), first dead LED: %d",
+                 result.workingLeds, result.measurements, millis() - startTime, result.workingLeds + 1);
+    } else {
+        LOG_INFO("Detected %d working LEDs in %d measurements (%lu ms)", result.workingLeds, result.measurements, millis() - startTime);
+    }
+    return result.workingLeds;
+}
+// --- End LED Count Auto-Detection ---
+
+// --- Power Calibration ---
+const int powerCalLeds = 20;                                  // Pixels lit during the sweep; a channel at full draws ~40 INA219 steps
+const uint8_t powerCalLevels[] = {0, 64, 128, 192, 255};      // Channel levels measured
+const int numPowerCalLevels = sizeof(powerCalLevels) / sizeof(powerCalLevels[0]);
+const unsigned long powerCalSettleMs = 20;
+const int powerCalTolerancePct = 10;   // Prediction must match the verification frame within this
+const int powerCalToleranceMa = 2 * ina219CurrentLsbUa(INA219_SHUNT_MICROOHM) / 1000; // ...or within two INA219 steps, whichever is larger
+
+// NVS key for a chipset's table, stored next to "chipset" in "led-config"
+void powerCalibrationKey(int chipsetType, char* key, size_t size) {
+    snprintf(key, size, "pwrcal%d", chipsetType);
+}
+
+// Call with the "led-config" namespace open
+void loadPowerCalibration(int chipsetType) {
+    char key[12];
+    powerCalibrationKey(chipsetType, key, sizeof(key));
+    powerCalibration = PowerCalibration();
+    if (preferences.getBytesLength(key) == sizeof(PowerCalibration)) {
+        preferences.getBytes(key, &powerCalibration, sizeof(PowerCalibration));
+    }
+    if (powerCalibration.version != powerCalibrationVersion) { powerCalibration = PowerCalibration(); }
+}
+
+void savePowerCalibration(int chipsetType, const PowerCalibration& cal) {
+    char key[12];
+    powerCalibrationKey(chipsetType, key, sizeof(key));
+    preferences.begin("led-config", false);
+    preferences.putBytes(key, &cal, sizeof(PowerCalibration));
+    preferences.end();
+}
+
+// Show a frame at full brightness and return the settled supply current
+int32_t measureFrameMa(uint8_t brightness) {
+    ledOutputPresent(brightness);
+    ledOutputFlush();
+    delay(powerCalSettleMs);
+    return (int32_t)(readCurrentMa() + 0.5f);
+}
 
-  // --- Read Saved Settings Early ---
-  preferences.begin("led-config", false); // Open NVM namespace, read-write
-  // Read saved chipset type, default to WS2812 (0) if not found
-  savedChipsetType = preferences.getInt("chipset", CHIPSET_TYPE_WS2812);
-  preferences.end(); // Close preferences for now
-  Serial.print("Saved Chipset Type loaded: "); Serial.println(savedChipsetType == CHIPSET_TYPE_SK6812 ? "SK6812" : "WS2812");
+// Sweep R, G and B (and W on RGBW parts) on a few pixels, fit the table and check it on a mixed frame.
+// Returns true if the prediction is within tolerance; errorPct gets the verification error.
+bool runPowerCalibration(PowerCalibration& cal, int& errorPct) {
+    LOG_INFO("Power calibration for %s on %d LEDs...", chipsetNames[savedChipsetType], powerCalLeds);
+    int litLeds = min(powerCalLeds, numLedsConfigured);
+    cal = PowerCalibration();
+    cal.version = powerCalibrationVersion;
+    bool rgbw = savedChipsetType == CHIPSET_TYPE_SK6812_RGBW;
+    int lastChannel = rgbw ? POWER_W : POWER_B;
+    ina219.setProfile(INA219_PROFILE_CALIBRATION); // 32x on-chip averaging per point
+
+    for (int channel = POWER_R; channel <= lastChannel; channel++) {
+        int32_t currentMa[numPowerCalLevels];
+        for (int level = 0; level < numPowerCalLevels; level++) {
+            CRGB* frame = ledOutputBeginFrame();
+            fill_solid(frame, MAX_LEDS, CRGB::Black);
+            CRGB color = CRGB::Black;
+            if (channel == POWER_W) {
+                color = rgbwWhiteColor(powerCalLevels[level]); // Extracts to pure W
+            } else {
+                color[channel] = powerCalLevels[level];
+            }
+            fill_solid(frame, litLeds, color);
+            currentMa[level] = measureFrameMa(255);
+        }
+        if (channel == POWER_R) { cal.darkMa = (uint16_t)max((int32_t)0, currentMa[0]); }
+        cal.naPerUnit[channel] = fitNaPerUnit(powerCalLevels, currentMa, numPowerCalLevels, litLeds);
+        LOG_AT(LOG_LEVEL_INFO, 0, "Channel %c: %ld..%ld mA, %lu nA/unit/LED", "RGBW"[channel],
+                      (long)currentMa[0], (long)currentMa[numPowerCalLevels - 1], (unsigned long)cal.naPerUnit[channel]);
+    }
 
-  // Read saved LED count, default to MAX_LEDS if not found or invalid
-  preferences.begin("led-config", true); // Open read-only first to check
+    // Verify against a frame that mixes all channels
+    CRGB* frame = ledOutputBeginFrame();
+    fill_solid(frame, MAX_LEDS, CRGB::Black);
+    fill_rainbow(frame, litLeds, 0, 255 / max(litLeds, 1));
+    if (rgbw) {
+        // Pastel half of the frame so the W channel takes part in the check
+        for (int i = 0; i < litLeds; i += 2) { frame[i] += CRGB(96, 96, 96); }
+    }
+    uint32_t predictedMa = predictFrameMa(frame, litLeds, 255, cal, rgbw);
+    int32_t measuredMa = measureFrameMa(255);
+    ina219.setProfile(INA219_PROFILE_MONITOR);
+
+    ledOutputClear();
+    nextPatternFrameTime = millis(); // Give the strip back to the active pattern
+
+    int32_t errorMa = abs((int32_t)predictedMa - measuredMa);
+    errorPct = measuredMa > 0 ? (int)(errorMa * 100 / measuredMa) : 100;
+    bool withinTolerance = errorPct <= powerCalTolerancePct || errorMa <= powerCalToleranceMa;
+    LOG_INFO("Dark: %u mA, verify frame predicted %lu mA, measured %ld mA (%d%%) -> %s",
+                  cal.darkMa, (unsigned long)predictedMa, (long)measuredMa, errorPct, withinTolerance ? "OK" : "OUT OF TOLERANCE");
+    return withinTolerance;
+}
+// --- End Power Calibration ---
+
+// --- Boot Sequence ---
+// Saved settings, read in one pass over the NVS namespace
+void loadSavedSettings() {
+  preferences.begin("led-config", true); // Read-only; a missing namespace just yields the defaults
+  savedChipsetType = preferences.getInt("chipset", Board::defaultChipset);
+  if (savedChipsetType < 0 || savedChipsetType >= NUM_CHIPSET_TYPES) { savedChipsetType = Board::defaultChipset; }
+  loadPowerCalibration(savedChipsetType);
   numLedsConfigured = preferences.getInt("ledCount", MAX_LEDS);
+  savedLedSegments = preferences.getInt("ledSegments", 1);
+  savedSyncRole = (SyncRole)preferences.getInt("syncRole", SYNC_ROLE_OFF);
+  savedSoakLog = preferences.getInt("soakLog", 0) != 0;
+  savedI2cTopology = preferences.getInt("i2cTopology", -1);
   preferences.end();
-  // Validate loaded value
+
+  Serial.print("Saved Chipset Type loaded: "); Serial.println(chipsetNames[savedChipsetType]);
+  Serial.print("Power calibration: "); Serial.println(powerCalibration.version == powerCalibrationVersion ? "loaded" : "none");
   if (numLedsConfigured <= 0 || numLedsConfigured > MAX_LEDS) {
     Serial.print("Invalid saved LED count ("); Serial.print(numLedsConfigured); Serial.println("), defaulting to MAX_LEDS.");
     numLedsConfigured = MAX_LEDS;
-    // Optionally: Save the corrected default value back?
-    // preferences.begin("led-config", false); 
-    // preferences.putInt("ledCount", numLedsConfigured);
-    // preferences.end();
   }
   Serial.print("Saved LED Count loaded: "); Serial.println(numLedsConfigured);
+  if (savedSyncRole < 0 || savedSyncRole >= NUM_SYNC_ROLES) { savedSyncRole = SYNC_ROLE_OFF; }
+  savedLedSegments = constrain(savedLedSegments, 1, (int)Board::numLedDataPins); // Also covers a board with fewer pins
+}
 
-  // --- Initialize I2C First ---
-  Wire.begin(SDA_PIN, SCL_PIN);
+// Bring up one known part; false if it failed to start
+bool initI2cDevice(I2cDeviceKind kind) {
+  switch (kind) {
+    case I2C_DEVICE_SSD1306:
+      u8g2.begin();
+      displayFlushBegin(u8g2); // Frames are sent from a background task from here on
+      LOG_INFO("SSD1306 Display Initialized (Found at 0x3C)");
+      return true;
+    case I2C_DEVICE_BH1750:
+      if constexpr (Board::hasLightSensor) {
+        if (lightMeter.begin(BH1750::CONTINUOUS_HIGH_RES_MODE)) {
+          LOG_INFO("BH1750 Initialized");
+          return true;
+        }
+        LOG_ERROR("Error initialising BH1750");
+      }
+      return false;
+    case I2C_DEVICE_INA219:
+      if constexpr (Board::hasCurrentSensor) {
+        if (ina219.begin(&Wire)) {
+          LOG_INFO("INA219 Initialized");
+          return true;
+        }
+        LOG_ERROR("Error initialising INA219");
+      }
+      return false;
+    default:
+      return false;
+  }
+}
 
-  // --- Initialize Display Early for Splash ---
-  displayAvailable = u8g2.begin(); 
-  if (displayAvailable) {
-      Serial.println("SSD1306 Display Initialized (Found at 0x3C)");
-  } else {
-      Serial.println("SSD1306 Display not found at 0x3C.");
+bool boardFitsI2cDevice(I2cDeviceKind kind) {
+  switch (kind) {
+    case I2C_DEVICE_SSD1306: return Board::hasDisplay;
+    case I2C_DEVICE_BH1750: return Board::hasLightSensor;
+    case I2C_DEVICE_INA219: return Board::hasCurrentSensor;
+    default: return false;
   }
+}
 
-  // --- Initialize Input Pins ---
-  pinMode(ROT_ENC_A_PIN, INPUT);
-  pinMode(ROT_ENC_B_PIN, INPUT);
-  pinMode(ROT_ENC_BUTTON_PIN, INPUT_PULLUP); // Encoder button often needs pullup
-  pinMode(USER_BUTTON_PIN, INPUT_PULLUP); 
-  pinMode(BOOT_BUTTON_PIN, INPUT_PULLUP); 
+// Display, then sensors. They share the I2C bus, so they come up one after
+// another, but alongside the rest of the boot when run from bootInitTask.
+// Only the parts found at the last boot are started (a first boot probes
+// for them instead). Every known address is then checked again: a part that
+// has appeared is started late, and a changed topology is saved for next time.
+void initI2cPeripherals() {
+  static const char* const phaseNames[NUM_I2C_DEVICE_KINDS] = {"display", "bh1750", "ina219"};
+  uint32_t phaseUs = bootNowUs();
+  if constexpr (Board::hasI2cBus) { Wire.begin(Board::sdaPin, Board::sclPin); } // Without one, no part fits below
+  I2cTopology cached;
+  bool haveCache = decodeI2cTopology(savedI2cTopology, cached);
+
+  bool started[NUM_I2C_DEVICE_KINDS] = {};
+  for (int k = 0; k < NUM_I2C_DEVICE_KINDS; k++) {
+    I2cDeviceKind kind = (I2cDeviceKind)k;
+    if (!boardFitsI2cDevice(kind)) continue;
+    bool expected = haveCache ? cached.devices[k] != I2C_MATCH_ABSENT : i2cFingerprint(Wire, kind) != I2C_MATCH_ABSENT;
+    if (expected) {
+      started[k] = initI2cDevice(kind);
+    } else {
+      LOG_INFO("%s not found%s, skipped", i2cKnownDevices[k].name, haveCache ? " at last boot" : "");
+    }
+    bootPhaseDone(phaseNames[k], phaseUs);
+  }
 
-  // --- Initialize Encoder Library ---
-  // Pullups enabled by default
-  encoder.attachHalfQuad(ROT_ENC_A_PIN, ROT_ENC_B_PIN);
-  encoder.setCount(0); 
-  lastEncoderCount = 0;
-  Serial.println("ESP32Encoder Initialized.");
-
-  // --- Display Initial Animation & Splash Screen ---
-  if (displayAvailable) {
-      playStaticAnimation(); // Play static first
-      displaySplashScreen(); // Then show the logo/text splash screen
-      Serial.println("Showing startup splash screen...");
+  // Check again what is really there, now that the expected parts are up
+  I2cTopology found;
+  for (int k = 0; k < NUM_I2C_DEVICE_KINDS; k++) {
+    I2cDeviceKind kind = (I2cDeviceKind)k;
+    if (!boardFitsI2cDevice(kind)) continue;
+    found.devices[k] = i2cFingerprint(Wire, kind, currentSensorDriver(ina219));
+    if (!started[k] && found.devices[k] != I2C_MATCH_ABSENT) {
+      LOG_INFO("%s appeared since the last boot", i2cKnownDevices[k].name);
+      started[k] = initI2cDevice(kind);
+    } else if (started[k] && found.devices[k] == I2C_MATCH_ABSENT) {
+      LOG_WARN("%s does not answer", i2cKnownDevices[k].name);
+      started[k] = false;
+    }
   }
-  currentState = STARTUP_SPLASH; // Set initial state
+  LOG_INFO("I2C TOPOLOGY cached=%d ssd1306=%s bh1750=%s ina219=%s", haveCache ? 1 : 0,
+           i2cMatchNames[found.devices[I2C_DEVICE_SSD1306]], i2cMatchNames[found.devices[I2C_DEVICE_BH1750]],
+           i2cMatchNames[found.devices[I2C_DEVICE_INA219]]);
+  saveI2cTopology(found);
+  bootPhaseDone("i2c_verify", phaseUs);
+
+  // loop() only touches the display and sensors from here on
+  displayAvailable = started[I2C_DEVICE_SSD1306];
+  peripheralsReady = true;
+}
+
+void bootInitTask(void* param) {
+  initI2cPeripherals();
+  xTaskNotifyGive(loopTaskHandle); // loop() finishes the boot
+  vTaskDelete(nullptr);
+}
+
+// Hold off until the display and sensors are up (anything that uses the I2C bus)
+void waitForPeripherals() {
+  while (!peripheralsReady) { delay(1); }
+}
 
-  // --- Initialize Sensors ---
-  if (lightMeter.begin(BH1750::CONTINUOUS_HIGH_RES_MODE)) {
-    Serial.println(F("BH1750 Initialized"));
+// First loop() pass after the background init: report boot timing, then the
+// self-test if it was requested, else the splash animation
+void finishBoot() {
+  bootFinished = true;
+  logFlush(); // The report is written straight to Serial
+  printBootReport(firstFrameUs);
+  soakLogBegin(savedSoakLog); // Mounting and the ring scan run in the writer task, after the boot
+  if (bootSelfTestRequested) {
+      Serial.println("User button held at boot, running self-test.");
+      runBoardSelfTest();
+      displaySplashScreen();
+  } else if (currentState == STARTUP_SPLASH) {
+      splashAnimationActive = displayAvailable;
+      splashAnimationUntil = millis() + splashAnimationMs;
+      nextSplashFrameTime = millis();
   } else {
-    Serial.println(F("Error initialising BH1750"));
+      updateDisplay(); // Input left the splash before the display was up
   }
-  if (ina219.begin()) {
-    Serial.println(F("INA219 Initialized"));
-  } else {
-    Serial.println(F("Error initialising INA219"));
+}
+
+// One frame of static per call, then the logo once the animation has run its time
+void stepSplashAnimation() {
+  if (currentState != STARTUP_SPLASH) { splashAnimationActive = false; return; } // Skipped by interaction
+  if ((long)(millis() - splashAnimationUntil) >= 0) {
+      splashAnimationActive = false;
+      displaySplashScreen();
+      return;
+  }
+  drawStaticFrame();
+  nextSplashFrameTime = millis() + splashFrameMs;
+}
+// --- End Boot Sequence ---
+
+// --- LED Segment Controllers ---
+// FastLED takes the data pin as a template argument, so every board pin gets its
+// own instantiation. The output task points each one at its slice before a show.
+static_assert(Board::numLedDataPins >= 1 && Board::numLedDataPins <= maxLedSegments, "1 to maxLedSegments data pins");
+
+template <int Pin>
+CLEDController* addLedController(int chipset, CRGB* leds, int count) {
+  if (chipset == CHIPSET_TYPE_SK6812 || chipset == CHIPSET_TYPE_SK6812_RGBW) {
+    return &FastLED.addLeds<SK6812, Pin, RGB>(leds, count);
+  }
+  return &FastLED.addLeds<WS2812, Pin, GRB>(leds, count);
+}
+
+// One controller per segment of the plan, on the board's pins in order
+template <size_t... Segment>
+void addSegmentControllers(int chipset, CRGB* wire, const LedSegmentPlan& plan, CLEDController** controllers,
+                           std::index_sequence<Segment...>) {
+  ((Segment < (size_t)plan.numSegments
+        ? (void)(controllers[Segment] = addLedController<Board::ledDataPins[Segment]>(
+              chipset, wire + plan.segments[Segment].wireStart, plan.segments[Segment].wireCount))
+        : (void)0), ...);
+}
+
+const LedWireTiming& wireTimingForChipset(int chipset) {
+  return chipset == CHIPSET_TYPE_WS2812 ? ws2812WireTiming : sk6812WireTiming;
+}
+
+// Expected wire time per pin, against the same strip on one pin
+void printLedSegments(const LedSegmentPlan& plan, const LedWireTiming& timing, bool rgbw) {
+  LedSegmentPlan singlePin = planLedSegments(numLedsConfigured, 1, rgbw);
+  Serial.printf("LED SEGMENTS n=%d chipset=%s frame_us=%lu single_pin_us=%lu\n", plan.numSegments, timing.name,
+                (unsigned long)ledWireFrameUs(plan.longestWireBytes, timing),
+                (unsigned long)ledWireFrameUs(singlePin.longestWireBytes, timing));
+  for (int s = 0; s < plan.numSegments; s++) {
+    const LedSegment& segment = plan.segments[s];
+    Serial.printf("LED SEGMENT index=%d pin=%d start=%d count=%d wire_us=%lu\n", s, Board::ledDataPins[s],
+                  segment.start, segment.count, (unsigned long)ledWireFrameUs(segment.wireCount * 3, timing));
+  }
+}
+
+// Serial 'g': step the number of data pins; controllers are set up at boot, so it takes a reboot
+void cycleLedSegments() {
+  savedLedSegments = savedLedSegments % Board::numLedDataPins + 1;
+  preferences.begin("led-config", false);
+  preferences.putInt("ledSegments", savedLedSegments);
+  preferences.end();
+  LOG_INFO("** LED segments saved: %d. Reboot required for change to take effect. **", savedLedSegments);
+  showOverlay("Saved!", "Reboot!", savedOverlayDuration);
+}
+// --- End LED Segment Controllers ---
+
+// --- Soak Log ---
+// One record of the supply, the light level and what the strip shows
+void sampleSoakLog() {
+  uint32_t startUs = micros();
+  SoakRecord record;
+  record.timeMs = millis();
+  if constexpr (Board::hasCurrentSensor) {
+    ina219.poll(); // Monitor profile: a new conversion every ~136 ms, read only if there is one
+    const Ina219Sample& sample = ina219.last();
+    record.busMv = (uint16_t)min(sample.busMv, (uint32_t)UINT16_MAX);
+    record.currentMa = (int16_t)constrain(sample.currentUa / 1000, (int32_t)INT16_MIN, (int32_t)INT16_MAX);
+  }
+  if constexpr (Board::hasLightSensor) {
+    float lux = lightMeter.readLightLevel();
+    if (lux >= 0) { record.lux = (uint16_t)min(lux, (float)(soakLuxNone - 1)); }
   }
-  // --- End Sensor Init ---
+  record.pattern = (uint8_t)currentFastLedPattern;
+  record.brightness = fastLedState.isOn ? (uint8_t)fastLedState.brightness : 0;
+  soakLogAppend(record, micros() - startUs);
+}
+
+// Serial 'l': soak logging on/off, saved so a soak test keeps logging across resets
+void toggleSoakLog() {
+  savedSoakLog = !savedSoakLog;
+  preferences.begin("led-config", false);
+  preferences.putInt("soakLog", savedSoakLog ? 1 : 0);
+  preferences.end();
+  soakLogSetEnabled(savedSoakLog);
+  nextSoakSampleTime = millis();
+  LOG_INFO("Soak log %s", savedSoakLog ? "on" : "off");
+  logFlush();
+  soakLogPrintStats();
+}
+// --- End Soak Log ---
+
+// --- End Helper Functions ---
+
+// --- Forward Declarations for Pattern Functions ---
+void runActivePattern();
+void serviceAnimationSync();
+void cycleSyncRole();
+// --- End Forward Declarations ---
+
+void setup() {
+  uint32_t phaseUs = 0; // The first phase covers app start up to setup()
+  bootPhaseDone("startup", phaseUs);
+  pixelStreamSetupSerial(); // Larger RX ring, only settable before begin()
+  Serial.begin(115200);
+#if !FAST_BOOT
+  delay(1000); // Wait for serial monitor
+#endif
+  logBegin(); // Loop-path logging is queued and drained by a background task
+  loopTaskHandle = xTaskGetCurrentTaskHandle(); // Notified by ISRs and the boot init task
+  Serial.println("\n\n--- Solid Difference Clock Controller Test Program ---");
+  Serial.print("Version: "); Serial.println(PROGRAM_VERSION);
+  Serial.print("Board: "); Serial.println(Board::name);
+  Serial.print("Build Date: "); Serial.print(__DATE__); Serial.print(" "); Serial.println(__TIME__);
+  Serial.println("-------------------------------------------------");
+  Serial.println("Setup starting...");
+  bootPhaseDone("serial", phaseUs);
+
+  loadSavedSettings();
+  bootPhaseDone("settings", phaseUs);
 
   // --- Initialize FastLED ---
+  // The strip comes first: it shows the saved pattern before anything else is up
   Serial.print("Configuring FastLED for type: ");
   if (savedChipsetType == CHIPSET_TYPE_WS2812) {
     Serial.println("WS2812 (GRB)");
-    FastLED.addLeds<WS2812, LED1_PIN, GRB>(leds, MAX_LEDS);
   } else if (savedChipsetType == CHIPSET_TYPE_SK6812) {
     Serial.println("SK6812 (RGB)");
-    // Note: Add RGBW logic here if needed based on another preference
-    FastLED.addLeds<SK6812, LED1_PIN, RGB>(leds, MAX_LEDS); 
+  } else if (savedChipsetType == CHIPSET_TYPE_SK6812_RGBW) {
+    Serial.println("SK6812 (RGBW, GRBW on the wire)");
   } else {
-    // Fallback / Error case
+    // Fallback / Error case, addLedController() treats it as WS2812
     Serial.println("Unknown type! Defaulting to WS2812 (GRB)");
-    FastLED.addLeds<WS2812, LED1_PIN, GRB>(leds, MAX_LEDS);
   }
+  // FastLED has no 4-channel path: the output task packs GRBW bytes and FastLED sends them as-is
+  bool rgbw = savedChipsetType == CHIPSET_TYPE_SK6812_RGBW;
+  CRGB* wire = rgbw ? ledOutputRgbwWireBuffer() : ledOutputFrontBuffer();
+  // Only the saved strip length goes on the wire; LED Detect and the self-test widen it while they run
+  LedSegmentPlan segmentPlan = planLedSegments(numLedsConfigured, savedLedSegments, rgbw);
+  CLEDController* ledControllers[maxLedSegments] = {};
+  addSegmentControllers(savedChipsetType, wire, segmentPlan, ledControllers, std::make_index_sequence<Board::numLedDataPins>());
+  const LedWireTiming& wireTiming = wireTimingForChipset(savedChipsetType);
+  printLedSegments(segmentPlan, wireTiming, rgbw);
+
+  // Hand the controllers to the double-buffered output task and put the first frame out
+  ledOutputBegin(ledControllers, segmentPlan, wireTiming, rgbw);
+  ledOutputClear();
+  runActivePattern();
+  firstFrameUs = bootNowUs();
+  bootPhaseDone("strip", phaseUs);
+  // --- End FastLED Init ---
 
-  FastLED.setBrightness(fastLedState.brightness); // Use initial brightness from struct
-  if (fastLedState.isOn) {
-     // Optional: Set an initial pattern if needed, otherwise it starts black
-     // fill_solid(leds, NUM_LEDS, CRGB::Black); 
-     FastLED.show();
-  } else {
-     FastLED.clear();
-     FastLED.show();
+  // --- Display and Sensors ---
+  // All on the I2C bus; with FAST_BOOT they come up in the background while setup() goes on
+#if FAST_BOOT
+  xTaskCreatePinnedToCore(bootInitTask, "bootInit", bootInitTaskStackSize, nullptr,
+                          bootInitTaskPriority, nullptr, bootInitTaskCore);
+#else
+  initI2cPeripherals();
+#endif
+  bootPhaseDone("i2c_started", phaseUs);
+
+  // --- Initialize Input Pins ---
+  if constexpr (Board::hasEncoder) {
+      pinMode(Board::encoderAPin, INPUT);
+      pinMode(Board::encoderBPin, INPUT);
+      pinMode(Board::encoderButtonPin, INPUT_PULLUP); // Encoder button often needs pullup
   }
-  // --- End FastLED Init ---
+  pinMode(Board::bootButtonPin, INPUT_PULLUP); 
+  if constexpr (Board::hasUserButton) {
+      pinMode(Board::userButtonPin, INPUT_PULLUP); 
+
+      // Holding the User button during power-up requests the batch self-test
+      bootSelfTestRequested = digitalRead(Board::userButtonPin) == LOW;
+      if (bootSelfTestRequested) {
+          // Treat the held button as already pressed so releasing it doesn't toggle LED 4
+          inputState.userButtonState = LOW;
+          inputState.userLastButtonState = LOW;
+      }
+  }
+
+  // --- Initialize Encoder Library ---
+  // Pullups enabled by default
+  if constexpr (Board::hasEncoder) {
+      encoder.attachHalfQuad(Board::encoderAPin, Board::encoderBPin);
+      encoder.setCount(0); 
+      lastEncoderCount = 0;
+      Serial.println("ESP32Encoder Initialized.");
+  }
+
+  // --- Wake Sources for the Event Loop ---
+  // Encoder edges and button changes notify loop(); counting still happens in PCNT
+  if constexpr (Board::hasEncoder) {
+      attachInterrupt(digitalPinToInterrupt(Board::encoderAPin), notifyLoopFromISR, CHANGE);
+      attachInterrupt(digitalPinToInterrupt(Board::encoderBPin), notifyLoopFromISR, CHANGE);
+      attachInterrupt(digitalPinToInterrupt(Board::encoderButtonPin), notifyLoopFromISR, CHANGE);
+  }
+  if constexpr (Board::hasUserButton) {
+      attachInterrupt(digitalPinToInterrupt(Board::userButtonPin), notifyLoopFromISR, CHANGE);
+  }
+  attachInterrupt(digitalPinToInterrupt(Board::bootButtonPin), notifyLoopFromISR, CHANGE);
+  Serial.onReceive(notifyLoopFromSerial);
+  bootPhaseDone("inputs", phaseUs);
+
+  // --- Animation Sync ---
+  // Followers render patterns on the leader's clock; off, or leading, the pattern clock stays millis()
+  if constexpr (Board::hasSyncPort) {
+      syncLinkBegin(savedSyncRole, loopTaskHandle);
+      setPatternClock(syncLinkClockMs);
+      Serial.print("Animation sync: "); Serial.println(syncRoleNames[savedSyncRole]);
+      bootPhaseDone("sync", phaseUs);
+  }
+  currentState = STARTUP_SPLASH; // Set initial state; loop() animates the splash once the display is up
 
   // --- Initialize PWM LEDs ---
-  ledcSetup(ledcChannel2, pwmFreq, pwmResolution);
-  ledcSetup(ledcChannel3, pwmFreq, pwmResolution);
-  ledcSetup(ledcChannel4, pwmFreq, pwmResolution);
-  ledcAttachPin(LED2_PIN, ledcChannel2);
-  ledcAttachPin(LED3_PIN, ledcChannel3);
-  ledcAttachPin(LED4_PIN, ledcChannel4);
-  ledcWrite(ledcChannel2, led2State.isOn ? led2State.brightness : 0);
-  ledcWrite(ledcChannel3, led3State.isOn ? led3State.brightness : 0);
-  ledcWrite(ledcChannel4, led4State.isOn ? led4State.brightness : 0);
+  if constexpr (Board::hasPwmLeds) {
+    ledcSetup(ledcChannel2, pwmFreq, pwmResolution);
+    ledcSetup(ledcChannel3, pwmFreq, pwmResolution);
+    ledcSetup(ledcChannel4, pwmFreq, pwmResolution);
+    ledcAttachPin(Board::led2Pin, ledcChannel2);
+    ledcAttachPin(Board::led3Pin, ledcChannel3);
+    ledcAttachPin(Board::led4Pin, ledcChannel4);
+    pwmLedsBegin(pwmLedChannels, 3);
+  }
+  writePwmLeds();
+  bootPhaseDone("pwm", phaseUs);
   // --- End PWM Init ---
 
-  // Set initial state AFTER splash wait - REMOVED, set earlier
-  // currentState = MENU; 
-  // lastInteractionTime = millis(); // Start interaction timer
-
+  loopStats.windowStartUs = esp_timer_get_time();
   Serial.println("Setup complete. Entering main loop.");
-
-  // Initial display update for the menu - REMOVED, handled by state machine
-  /*
-  if (displayAvailable) {
-      u8g2.clearBuffer(); 
-      u8g2.setFont(u8g2_font_profont22_tf); 
-      updateDisplay(); // Show initial menu state
-  }
-  */
+  bootPhaseDone("setup_end", phaseUs);
 }
 
 // --- Display Update Function ---
+// Show two centered lines on top of the UI for a while; loop() redraws when it expires
+void showOverlay(const char* line1, const char* line2, unsigned long durationMs) {
+    overlayLine1 = line1;
+    overlayLine2 = line2;
+    overlayUntil = millis() + durationMs;
+    overlayActive = true;
+}
+
+// Menu entry text: "<index>: <name>", split at the last space onto an indented line 2
+void formatMenuLines(int selection, char* line1, char* line2, size_t size) {
+    const char* fullName = modeTable[selection].name;
+    const char* lastSpace = strrchr(fullName, ' ');
+    line2[0] = '\0';
+
+    // Split at the last space if it exists and isn't too close to the start
+    if (lastSpace != nullptr && (lastSpace - fullName > 2)) {
+        snprintf(line1, size, "%d: %.*s", selection, (int)(lastSpace - fullName), fullName);
+        snprintf(line2, size, "   %s", lastSpace + 1);
+    } else {
+        snprintf(line1, size, "%d: %s", selection, fullName);
+    }
+}
+
+// Action screen text; line 1 shows the mode name unless the mode replaces it (selection screens)
+void formatModeLines(AppMode mode, char* line1, char* line2, size_t size) {
+    snprintf(line1, size, "%s", modeTable[mode].name);
+    line2[0] = '\0';
+    modeTable[mode].render(line1, line2, size);
+}
+
+// Every menu entry and mode screen once, without drawing; the display_format benchmark
+void formatAllScreens() {
+    char line1[32];
+    char line2[32];
+    for (int i = 0; i < numModes; i++) {
+        if (!modeTable[i].available) continue;
+        formatMenuLines(i, line1, line2, sizeof(line1));
+        formatModeLines((AppMode)i, line1, line2, sizeof(line1));
+    }
+}
+
 void updateDisplay() {
     if (!displayAvailable || currentState == SPLASH || currentState == STARTUP_SPLASH) return; // Skip if splash
 
     u8g2.clearBuffer(); // Clear previous frame
 
+    if (overlayActive) {
+        u8g2.setFont(u8g2_font_profont22_tf); // Use standard font
+        int line1Y = 14; // Centered vertically-ish
+        int line2Y = line1Y + 16;
+        u8g2.drawStr(u8g2.getDisplayWidth()/2 - u8g2.getStrWidth(overlayLine1)/2, line1Y, overlayLine1);
+        u8g2.drawStr(u8g2.getDisplayWidth()/2 - u8g2.getStrWidth(overlayLine2)/2, line2Y, overlayLine2);
+        displayPost();
+        return;
+    }
+
     // Determine positioning
     u8g2.setFont(u8g2_font_profont22_tf); // Ensure font is set to Profont22 for main UI
     const int lineHeight = 16; // 14px font height + 2px padding
     const int line1Y = 14;     // Adjusted Y for 1st line (starts at pixel 14)
     const int line2Y = line1Y + lineHeight; // Adjusted Y for 2nd line
 
-    char buffer[32]; // Buffer for formatting strings
-
+    char line1[32];
+    char line2[32];
     if (currentState == MENU) {
-        // --- New Menu Formatting --- 
-        const char* fullName = modeNames[menuSelection];
-        char part1[20]; // Buffer for first part of name
-        char part2[20]; // Buffer for second part of name
-        part1[0] = '\0'; // Initialize empty
-        part2[0] = '\0';
-
-        const char* lastSpace = strrchr(fullName, ' ');
-        int part1Len = strlen(fullName);
-
-        // Try splitting at the last space if it exists and isn't too close to the start
-        if (lastSpace != nullptr && (lastSpace - fullName > 2)) { 
-            part1Len = lastSpace - fullName;
-            strncpy(part1, fullName, part1Len);
-            part1[part1Len] = '\0'; // Null-terminate
-            strncpy(part2, lastSpace + 1, sizeof(part2) - 1);
-            part2[sizeof(part2) - 1] = '\0'; // Ensure null-termination
+        formatMenuLines(menuSelection, line1, line2, sizeof(line1));
+    } else if (currentState == ACTION) {
+        formatModeLines(currentMode, line1, line2, sizeof(line1));
+    } else {
+        line1[0] = line2[0] = '\0';
+    }
+    if (line1[0] != '\0') { u8g2.drawStr(0, line1Y, line1); }
+    if (line2[0] != '\0') { u8g2.drawStr(0, line2Y, line2); }
+
+    displayPost(); // Send buffer to display
+}
+// --- End Display Update Function ---
+
+// --- Mode Handlers ---
+// Brightness screens: perceptual steps when turned fast, and turning the knob switches the output on
+void stepBrightness(int& brightness, bool& isOn, long steps) {
+    brightness = encoderAccelApply(brightnessCurve, brightness, steps, encoderSpeed);
+    isOn = true;
+    LOG_INFO("Brightness set to: %d", brightness);
+}
+
+void fastLedBrightnessEncoder(long steps) { stepBrightness(fastLedState.brightness, fastLedState.isOn, steps); }
+void led2BrightnessEncoder(long steps) { stepBrightness(led2State.brightness, led2State.isOn, steps); }
+void led3BrightnessEncoder(long steps) { stepBrightness(led3State.brightness, led3State.isOn, steps); }
+void led4BrightnessEncoder(long steps) { stepBrightness(led4State.brightness, led4State.isOn, steps); }
+
+void fastLedBrightnessRender(char*, char* line2, size_t size) { snprintf(line2, size, "Bright: %d", fastLedState.brightness); }
+// PWM LEDs show their effect in place of "Bright" unless steady
+void pwmLedBrightnessRender(const LedPwmState& state, char* line2, size_t size) {
+    if (state.effect == PWM_EFFECT_STEADY) {
+        snprintf(line2, size, "Bright: %d", state.brightness);
+    } else {
+        snprintf(line2, size, "%s: %d", pwmEffectNames[state.effect], state.brightness);
+    }
+}
+
+void led2BrightnessRender(char*, char* line2, size_t size) { pwmLedBrightnessRender(led2State, line2, size); }
+void led3BrightnessRender(char*, char* line2, size_t size) { pwmLedBrightnessRender(led3State, line2, size); }
+void led4BrightnessRender(char*, char* line2, size_t size) { pwmLedBrightnessRender(led4State, line2, size); }
+
+// State of the PWM LED a mode controls, nullptr for other modes
+LedPwmState* pwmLedForMode(AppMode mode) {
+    switch (mode) {
+        case LED2_MODE: return &led2State;
+        case LED3_MODE: return &led3State;
+        case LED4_MODE: return &led4State;
+        default: return nullptr;
+    }
+}
+
+// Sensor screens read once on entry, then on every refresh
+void lightSensorRender(char*, char* line2, size_t size) {
+    if (lastLuxValue >= 0) {
+        snprintf(line2, size, "Lux: %.0f", lastLuxValue);
+    } else {
+        snprintf(line2, size, "Reading...");
+    }
+}
+
+void ina219SensorRender(char*, char* line2, size_t size) {
+    // Check for zero/invalid values
+    bool voltageValid = !(abs(lastBusVoltage) < 0.01);
+    bool currentValid = !(abs(lastCurrentMa) < 0.1); // Use a small threshold for float comparison
+
+    char voltageStr[8];
+    char currentStr[10];
+
+    // Format Voltage or "--"
+    if (voltageValid) {
+        snprintf(voltageStr, sizeof(voltageStr), "%.1fV", lastBusVoltage);
+    } else {
+        snprintf(voltageStr, sizeof(voltageStr), "-- V");
+    }
+
+    // Format Current (mA or A) or "--"
+    if (currentValid) {
+        if (abs(lastCurrentMa) >= 1000.0) {
+            snprintf(currentStr, sizeof(currentStr), "%.1fA", lastCurrentMa / 1000.0);
         } else {
-            // No suitable space found, put whole name on line 1
-            strncpy(part1, fullName, sizeof(part1) - 1);
-            part1[sizeof(part1) - 1] = '\0'; // Ensure null-termination
-            // part2 remains empty
+            snprintf(currentStr, sizeof(currentStr), "%.0fmA", lastCurrentMa);
         }
+    } else {
+        snprintf(currentStr, sizeof(currentStr), "-- mA");
+    }
 
-        // Line 1: Format Index and Part 1
-        snprintf(buffer, sizeof(buffer), "%d: %s", menuSelection, part1);
-        u8g2.drawStr(0, line1Y, buffer);
+    snprintf(line2, size, "%s %s", voltageStr, currentStr);
+}
 
-        // Line 2: Format indented Part 2 (if it exists)
-        if (part2[0] != '\0') {
-            snprintf(buffer, sizeof(buffer), "   %s", part2);
-            u8g2.drawStr(0, line2Y, buffer);
-        }
-        // --- End New Menu Formatting ---
+void i2cScannerEnter() { lastI2cScan = scanI2CBus(); i2cScanned = true; i2cScanPage = 0; } // Scan and store result on entry
+void i2cScannerTick() { i2cScanPage++; }
 
-        /* // Old Menu Formatting Removed
-        // Line 1: Show selected mode with '>'
-        snprintf(buffer, sizeof(buffer), "> %s", modeNames[menuSelection]);
-        u8g2.drawStr(0, line1Y, buffer);
+void i2cScannerRender(char*, char* line2, size_t size) {
+    if (i2cScanned) {
+        formatI2cScanPage(line2, size, lastI2cScan, i2cScanPage); // One device per page: name, "?" if unverified, address if unknown
+    } else {
+        snprintf(line2, size, "Devices: --"); // Should not happen if scanned on entry
+    }
+}
 
-        // Line 2: Show index
-        snprintf(buffer, sizeof(buffer), "(%d/%d)", menuSelection + 1, numModes);
-        u8g2.drawStr(0, line2Y, buffer);
-        */
+// Selection screens: the encoder moves a proposal, the button commits it
+void chipsetEnter() { chipsetSelectionProposed = savedChipsetType; }
 
-    } else if (currentState == ACTION) {
-        // --- Restore Original Action State Font & Layout ---
-        u8g2.setFont(u8g2_font_profont22_tf); // Restore Profont22
-        // Use the original line Y positions defined earlier (line 480-482)
-        // const int lineHeight = 16;
-        // const int line1Y = 14;
-        // const int line2Y = line1Y + lineHeight;
-
-        // Line 1: Show current mode name (using original font/pos)
-        u8g2.drawStr(0, line1Y, modeNames[currentMode]);
-
-        // Line 2: Show mode-specific info (using original font/pos)
-        switch (currentMode) {
-            case ESP_INFO:
-                {
-                    // Format compact ESP info
-                    int cpuFreq = ESP.getCpuFreqMHz();
-                    int flashSize = ESP.getFlashChipSize() / (1024 * 1024);
-                    snprintf(buffer, sizeof(buffer), "%dMHz/%dMB", cpuFreq, flashSize);
-                }
-                u8g2.drawStr(0, line2Y, buffer);
-                break;
-            case I2C_SCANNER:
-                // Show scan result
-                if (lastI2cDeviceCount >= 0) {
-                    snprintf(buffer, sizeof(buffer), "Devices: %d", lastI2cDeviceCount);
-                } else {
-                    snprintf(buffer, sizeof(buffer), "Devices: --"); // Should not happen if scanned on entry
-                }
-                u8g2.drawStr(0, line2Y, buffer);
-                break;
-            case FASTLED_TEST:
-                snprintf(buffer, sizeof(buffer), "Bright: %d", fastLedState.brightness);
-                u8g2.drawStr(0, line2Y, buffer);
-                break;
-            case LED2_MODE:
-                snprintf(buffer, sizeof(buffer), "Bright: %d", led2State.brightness);
-                u8g2.drawStr(0, line2Y, buffer);
-                break;
-            case LED3_MODE:
-                snprintf(buffer, sizeof(buffer), "Bright: %d", led3State.brightness);
-                u8g2.drawStr(0, line2Y, buffer);
-                break;
-            case LED4_MODE:
-                snprintf(buffer, sizeof(buffer), "Bright: %d", led4State.brightness);
-                u8g2.drawStr(0, line2Y, buffer);
-                break;
-            case LIGHT_SENSOR:
-                if (lastLuxValue >= 0) {
-                     snprintf(buffer, sizeof(buffer), "Lux: %.0f", lastLuxValue);
-                } else {
-                     snprintf(buffer, sizeof(buffer), "Reading...");
-                }
-                u8g2.drawStr(0, line2Y, buffer);
-                break;
-            case INA219_SENSOR:
-                 {
-                     // Check for zero/invalid values
-                     bool voltageValid = !(abs(lastBusVoltage) < 0.01);
-                     bool currentValid = !(abs(lastCurrentMa) < 0.1); // Use a small threshold for float comparison
-
-                     char voltageStr[8];
-                     char currentStr[10];
-
-                     // Format Voltage or "--"
-                     if (voltageValid) {
-                         snprintf(voltageStr, sizeof(voltageStr), "%.1fV", lastBusVoltage);
-                     } else {
-                         snprintf(voltageStr, sizeof(voltageStr), "-- V");
-                     }
-
-                     // Format Current (mA or A) or "--"
-                     if (currentValid) {
-                         if (abs(lastCurrentMa) >= 1000.0) {
-                             snprintf(currentStr, sizeof(currentStr), "%.1fA", lastCurrentMa / 1000.0);
-                         } else {
-                             snprintf(currentStr, sizeof(currentStr), "%.0fmA", lastCurrentMa);
-                         }
-                     } else {
-                         snprintf(currentStr, sizeof(currentStr), "-- mA");
-                     }
-
-                     // Combine strings
-                     snprintf(buffer, sizeof(buffer), "%s %s", voltageStr, currentStr);
-                 }
-                 u8g2.drawStr(0, line2Y, buffer);
-                 break;
-            case LED_CHIPSET_SELECT:
-                u8g2.clearBuffer(); 
-                // Show the proposed chipset name with indicator '>'
-                snprintf(buffer, sizeof(buffer), "> %s", chipsetNames[chipsetSelectionProposed]);
-                u8g2.drawStr(0, line1Y, buffer); // Use Line 1 for the proposed item
-                u8g2.drawStr(0, line2Y, "Press btn->Save"); // Use Line 2 for instruction
-                break;
-            case FASTLED_PATTERN:
-                u8g2.clearBuffer(); 
-                // Show the proposed pattern name with indicator '>'
-                snprintf(buffer, sizeof(buffer), "> %s", patternNames[patternSelectionProposed]);
-                u8g2.drawStr(0, line1Y, buffer); // Use Line 1 for the proposed item
-                u8g2.drawStr(0, line2Y, "Press btn->Set"); // Use Line 2 for instruction
-                break;
-            case LED_COUNT_SELECT:
-                u8g2.clearBuffer(); // Add buffer clear
-                // Show the proposed LED count
-                snprintf(buffer, sizeof(buffer), "Count: %d", numLedsProposed);
-                u8g2.drawStr(0, line1Y, buffer); // Use Line 1 for count
-                u8g2.drawStr(0, line2Y, "Press btn->Save"); // Use Line 2 for instruction
-                break;
-        }
+void chipsetEncoder(long steps) {
+    chipsetSelectionProposed = (chipsetSelectionProposed + steps) % NUM_CHIPSET_TYPES;
+    if (chipsetSelectionProposed < 0) { chipsetSelectionProposed += NUM_CHIPSET_TYPES; }
+    LOG_INFO("Proposed chipset: %s", chipsetNames[chipsetSelectionProposed]);
+}
+
+void chipsetButton() {
+    savedChipsetType = chipsetSelectionProposed;
+    LOG_INFO("Saving Chipset Type: %s", chipsetNames[savedChipsetType]);
+    preferences.begin("led-config", false);
+    preferences.putInt("chipset", savedChipsetType);
+    preferences.end();
+    LOG_INFO("** Chipset selection saved: %s. Reboot required for change to take effect. **", chipsetNames[savedChipsetType]);
+    showOverlay("Saved!", "Reboot!", savedOverlayDuration); // Scheduled, no blocking delay
+}
+
+void chipsetRender(char* line1, char* line2, size_t size) {
+    snprintf(line1, size, "> %s", chipsetNames[chipsetSelectionProposed]);
+    snprintf(line2, size, "Press btn->Save");
+}
+
+void patternEnter() { patternSelectionProposed = currentFastLedPattern; }
+
+void patternEncoder(long steps) {
+    patternSelectionProposed = (patternSelectionProposed + steps) % NUM_FASTLED_PATTERNS;
+    if (patternSelectionProposed < 0) { patternSelectionProposed += NUM_FASTLED_PATTERNS; }
+    LOG_INFO("Proposed pattern: %s", patterns[patternSelectionProposed].name);
+}
+
+void patternButton() {
+    currentFastLedPattern = (FastLedPattern)patternSelectionProposed;
+    LOG_INFO("** Pattern set to: %s", patterns[currentFastLedPattern].name);
+    ledOutputClear(); // Clear and show black
+    // Restart pattern time so the new pattern begins at t=0
+    patternEpoch = patternClockNow();
+    lastCheckerPulseLogged = UINT32_MAX;
+    nextPatternFrameTime = millis(); // Start the new pattern right away
+}
+
+void patternRender(char* line1, char* line2, size_t size) {
+    snprintf(line1, size, "> %s", patterns[patternSelectionProposed].name);
+    snprintf(line2, size, "Press btn->Set");
+}
+
+void ledCountEnter() { numLedsProposed = numLedsConfigured; }
+
+void ledCountEncoder(long steps) {
+    numLedsProposed = encoderAccelApply(ledCountCurve, numLedsProposed, steps, encoderSpeed);
+    LOG_INFO("Proposed LED count: %d", numLedsProposed);
+}
+
+void ledCountButton() {
+    numLedsConfigured = numLedsProposed;
+    LOG_INFO("Saving LED Count: %d", numLedsConfigured);
+    preferences.begin("led-config", false);
+    preferences.putInt("ledCount", numLedsConfigured);
+    preferences.end();
+    LOG_INFO("** LED count saved: %d. Reboot required for change to take effect. **", numLedsConfigured);
+    showOverlay("Saved!", "Reboot!", savedOverlayDuration); // Scheduled, no blocking delay
+}
+
+void ledCountRender(char* line1, char* line2, size_t size) {
+    snprintf(line1, size, "Count: %d", numLedsProposed);
+    snprintf(line2, size, "Press btn->Save");
+}
+
+// Blocking measurement screens: show a busy line while the sweep runs on entry
+void showBusyScreen(const char* text) {
+    if (!displayAvailable) return;
+    u8g2.clearBuffer();
+    u8g2.setFont(u8g2_font_profont22_tf);
+    u8g2.drawStr(0, 14, text);
+    displayPost();
+}
+
+void ledDetectEnter() {
+    if constexpr (Board::hasCurrentSensor) { // Mode is not on this board's menu otherwise
+        showBusyScreen("Detecting...");
+        numLedsDetected = runLedCountDetect();
+        // Offer the result for saving like a manual LED Count selection
+        if (numLedsDetected > 0) { numLedsProposed = numLedsDetected; }
     }
+}
 
-    u8g2.sendBuffer(); // Send buffer to display
+void ledDetectButton() {
+    if (numLedsDetected > 0) { ledCountButton(); }
+}
+
+void ledDetectRender(char* line1, char* line2, size_t size) {
+    if (numLedsDetected > 0) {
+        snprintf(line1, size, "Found: %d", numLedsDetected);
+        snprintf(line2, size, "Press btn->Save");
+    } else {
+        snprintf(line1, size, "No LEDs found");
+        snprintf(line2, size, "Press btn->Back");
+    }
+}
+
+void powerCalEnter() {
+    if constexpr (Board::hasCurrentSensor) { // Mode is not on this board's menu otherwise
+        showBusyScreen("Calibrating");
+        powerCalibrationPassed = runPowerCalibration(powerCalibrationProposed, powerCalibrationErrorPct);
+    }
+}
+
+void powerCalButton() {
+    if (!powerCalibrationPassed) return;
+    powerCalibration = powerCalibrationProposed;
+    savePowerCalibration(savedChipsetType, powerCalibration);
+    LOG_INFO("** Power calibration saved for %s **", chipsetNames[savedChipsetType]);
 }
-// --- End Display Update Function ---
+
+void powerCalRender(char* line1, char* line2, size_t size) {
+    snprintf(line1, size, "Error: %d%%", powerCalibrationErrorPct);
+    snprintf(line2, size, "%s", powerCalibrationPassed ? "Press btn->Save" : "Press btn->Back");
+}
+
+// ESP Info cycles through chip info and watchdog pages, one per refresh
+int espInfoPage = 0;
+
+void espInfoEnter() {
+    espInfoPage = 0;
+    printEspInfo();
+    printLoopStats();
+    printLoopWatchdog();
+}
+
+void espInfoTick() { espInfoPage = (espInfoPage + 1) % 4; }
+
+void espInfoRender(char*, char* line2, size_t size) {
+    LoopWatchdogStats watchdog = loopWatchdogStats();
+    switch (espInfoPage) {
+        case 0:
+            snprintf(line2, size, "%dMHz/%dMB", (int)ESP.getCpuFreqMHz(), (int)(ESP.getFlashChipSize() / (1024 * 1024)));
+            break;
+        case 1: // Input / frame budget violations
+            snprintf(line2, size, "SLO %lu/%lu", (unsigned long)watchdog.inputViolations, (unsigned long)watchdog.frameViolations);
+            break;
+        case 2:
+            snprintf(line2, size, "Heap %luk", (unsigned long)(ESP.getMinFreeHeap() / 1024));
+            break;
+        default:
+            snprintf(line2, size, "Stack %lu", (unsigned long)loopWatchdogMinStackFree());
+            break;
+    }
+}
+
+// One entry per AppMode, in enum order
+constexpr ModeDescriptor modeTable[NUM_APP_MODES] = {
+    // name             available                enter                    encoder                   button           render                   tick                     refreshMs
+    {"FastLED Test",    true,                    nullptr,                 fastLedBrightnessEncoder, nullptr,         fastLedBrightnessRender, nullptr,                 0},
+    {"LED2 Brightness", Board::hasPwmLeds,       nullptr,                 led2BrightnessEncoder,    nullptr,         led2BrightnessRender,    nullptr,                 0},
+    {"LED3 Brightness", Board::hasPwmLeds,       nullptr,                 led3BrightnessEncoder,    nullptr,         led3BrightnessRender,    nullptr,                 0},
+    {"LED4 Brightness", Board::hasPwmLeds,       nullptr,                 led4BrightnessEncoder,    nullptr,         led4BrightnessRender,    nullptr,                 0},
+    {"BH1750 Sensor",   Board::hasLightSensor,   readAndPrintLightSensor, fastLedBrightnessEncoder, nullptr,         lightSensorRender,       readAndPrintLightSensor, sensorReadInterval},
+    {"INA219 Sensor",   Board::hasCurrentSensor, readAndPrintIna219,      fastLedBrightnessEncoder, nullptr,         ina219SensorRender,      readAndPrintIna219,      sensorReadInterval},
+    {"I2C Scanner",     Board::hasI2cBus,        i2cScannerEnter,         nullptr,                  nullptr,         i2cScannerRender,        i2cScannerTick,          i2cScanPageMs},
+    {"LED Chipset",     true,                    chipsetEnter,            chipsetEncoder,           chipsetButton,   chipsetRender,           nullptr,                 0},
+    {"LED Pattern",     true,                    patternEnter,            patternEncoder,           patternButton,   patternRender,           nullptr,                 0},
+    {"LED Count",       true,                    ledCountEnter,           ledCountEncoder,          ledCountButton,  ledCountRender,          nullptr,                 0},
+    {"LED Detect",      Board::hasCurrentSensor, ledDetectEnter,          nullptr,                  ledDetectButton, ledDetectRender,         nullptr,                 0},
+    {"Power Cal",       Board::hasCurrentSensor, powerCalEnter,           nullptr,                  powerCalButton,  powerCalRender,          nullptr,                 0},
+    {"ESP Info",        true,                    espInfoEnter,            nullptr,                  nullptr,         espInfoRender,           espInfoTick,             espInfoPageMs},
+};
+
+// Rows missing from the end of the table would be zero-filled, so require a render hook on each
+constexpr bool modeTableComplete(int i = 0) {
+    return i == NUM_APP_MODES || (modeTable[i].render != nullptr && modeTableComplete(i + 1));
+}
+static_assert(modeTableComplete(), "Every AppMode needs a modeTable row");
+static_assert(modeTable[FASTLED_TEST].available, "The menu needs at least one mode on every board");
+
+// Move the menu cursor over the modes this board has. The knob stops at either
+// end; one-way button stepping wraps around instead.
+int stepMenuSelection(int selection, long steps) {
+    int direction = steps > 0 ? 1 : -1;
+    for (long n = steps > 0 ? steps : -steps; n > 0; n--) {
+        int next = selection;
+        do {
+            next += direction;
+            if (!Board::hasEncoder) { next = (next + numModes) % numModes; }
+            else if (next < 0 || next >= numModes) { return selection; }
+        } while (!modeTable[next].available);
+        selection = next;
+    }
+    return selection;
+}
+// --- End Mode Handlers ---
 
 void loop() {
+    loopStats.iterations++;
+    loopWatchdogBeginIteration();
     bool stateChanged = false; // Declare at the start of the loop scope
     bool interactionDetected = false; // Flag to track if interaction occurred this loop
 
     // --- 1. Read Inputs (Physical & Serial) ---
 
     // --- Read Encoder using Library ---
-    long currentCount = encoder.getCount();
-    long encoderChange = currentCount - lastEncoderCount;
-    lastEncoderCount = currentCount;
-    // Optional: Reset count periodically if it gets too large?
-    // if (abs(currentCount) > 10000) { encoder.clearCount(); lastEncoderCount = 0; }
+    long encoderChange = 0;
+    if constexpr (Board::hasEncoder) {
+        long currentCount = encoder.getCount();
+        encoderChange = currentCount - lastEncoderCount;
+        lastEncoderCount = currentCount;
+        encoderSpeed = encoderChange != 0 ? encoderVelocity.update(millis(), encoderChange) : 0;
+        // Optional: Reset count periodically if it gets too large?
+        // if (abs(currentCount) > 10000) { encoder.clearCount(); lastEncoderCount = 0; }
+    }
 
     if (encoderChange != 0) { interactionDetected = true; } // Mark interaction on encoder change
 
@@ -690,38 +1488,42 @@ void loop() {
     // --- Read Physical Buttons (Keep Debounce Logic) ---
     // Debounce Physical Rotary Button
     bool physicalRotButtonPressedEvent = false;
-    int rotButtonReading = digitalRead(ROT_ENC_BUTTON_PIN);
-    if (rotButtonReading != inputState.rotLastButtonState) {
-        inputState.rotLastDebounceTime = millis();
-    }
-    if ((millis() - inputState.rotLastDebounceTime) > debounceDelay) {
-        if (rotButtonReading != inputState.rotButtonState) {
-            inputState.rotButtonState = rotButtonReading;
-            if (inputState.rotButtonState == LOW) {
-                physicalRotButtonPressedEvent = true;
-                interactionDetected = true; // Mark interaction
-                Serial.println("Physical Rot Button Pressed"); // Debug
+    if constexpr (Board::hasEncoder) {
+        int rotButtonReading = digitalRead(Board::encoderButtonPin);
+        if (rotButtonReading != inputState.rotLastButtonState) {
+            inputState.rotLastDebounceTime = millis();
+        }
+        if ((millis() - inputState.rotLastDebounceTime) > debounceDelay) {
+            if (rotButtonReading != inputState.rotButtonState) {
+                inputState.rotButtonState = rotButtonReading;
+                if (inputState.rotButtonState == LOW) {
+                    physicalRotButtonPressedEvent = true;
+                    interactionDetected = true; // Mark interaction
+                    LOG_DEBUG("Physical Rot Button Pressed");
+                }
             }
         }
+        inputState.rotLastButtonState = rotButtonReading;
     }
-    inputState.rotLastButtonState = rotButtonReading;
 
     // Read User Button
-    int userButtonReading = digitalRead(USER_BUTTON_PIN);
-    if (userButtonReading != inputState.userLastButtonState) { inputState.userLastDebounceTime = millis(); }
-    if ((millis() - inputState.userLastDebounceTime) > debounceDelay) {
-        if (userButtonReading != inputState.userButtonState) {
-            inputState.userButtonState = userButtonReading;
-            if (inputState.userButtonState == LOW) { 
-                inputState.userButtonPressedEvent = true; // Set flag
-                interactionDetected = true; // Mark interaction
+    if constexpr (Board::hasUserButton) {
+        int userButtonReading = digitalRead(Board::userButtonPin);
+        if (userButtonReading != inputState.userLastButtonState) { inputState.userLastDebounceTime = millis(); }
+        if ((millis() - inputState.userLastDebounceTime) > debounceDelay) {
+            if (userButtonReading != inputState.userButtonState) {
+                inputState.userButtonState = userButtonReading;
+                if (inputState.userButtonState == LOW) { 
+                    inputState.userButtonPressedEvent = true; // Set flag
+                    interactionDetected = true; // Mark interaction
+                }
             }
         }
+        inputState.userLastButtonState = userButtonReading;
     }
-    inputState.userLastButtonState = userButtonReading;
 
     // Read Boot Button
-    int bootButtonReading = digitalRead(BOOT_BUTTON_PIN);
+    int bootButtonReading = digitalRead(Board::bootButtonPin);
     if (bootButtonReading != inputState.bootLastButtonState) { inputState.bootLastDebounceTime = millis(); }
     if ((millis() - inputState.bootLastDebounceTime) > debounceDelay) {
         if (bootButtonReading != inputState.bootButtonState) {
@@ -748,9 +1550,27 @@ void loop() {
     inputState.userButtonPressedEvent = false; 
     inputState.bootButtonPressedEvent = false;
 
+    // Boards without an encoder navigate with their two buttons: Boot steps, User selects/goes back
+    if constexpr (!Board::hasEncoder) {
+        if (bootButtonPressedEvent) { encoderChangeSteps = 1; bootButtonPressedEvent = false; }
+        if (userButtonPressedEvent) { rotButtonPressedEvent = true; userButtonPressedEvent = false; }
+    }
+
+
+    // While streaming, serial bytes are pixel data and any button ends the stream
+    if (pixelStreamActive()) {
+        if (rotButtonPressedEvent || userButtonPressedEvent || bootButtonPressedEvent) {
+            LOG_INFO("Pixel stream stopped by button");
+            pixelStreamEnd();
+            rotButtonPressedEvent = userButtonPressedEvent = bootButtonPressedEvent = false;
+        } else {
+            pixelStreamService();
+        }
+        if (!pixelStreamActive()) { nextPatternFrameTime = millis(); } // Patterns pick up again now
+    }
 
     // Process Serial Input (can override or add to physical input)
-    if (Serial.available() > 0) {
+    if (!pixelStreamActive() && Serial.available() > 0) {
         interactionDetected = true; // Mark interaction on any serial input
         char incomingChar = Serial.read();
         // Consume potential preceding carriage return if Enter sends \r\n
@@ -759,20 +1579,41 @@ void loop() {
             incomingChar = '\n'; // Treat \r\n sequence as just \n (Enter)
         }
 
-        if (currentState == MENU) {
+        if (incomingChar == 's' || incomingChar == 'S') {
+            printLoopStats(); // Loop/idle counters, available in any state
+        } else if (incomingChar == 'p' || incomingChar == 'P') {
+            printFramePipelineStats(); // Render/wait/transmit timings, available in any state
+        } else if (incomingChar == 't' || incomingChar == 'T') {
+            runBoardSelfTest(); // Batch hardware self-test, available in any state
+            stateChanged = true;
+        } else if (incomingChar == 'k' || incomingChar == 'K') {
+            runBenchmarks(formatAllScreens); // Per-frame kernel timings, available in any state
+        } else if (incomingChar == 'w' || incomingChar == 'W') {
+            printLoopWatchdog(); // Latency budgets and stack/heap high-water marks, available in any state
+        } else if ((incomingChar == 'y' || incomingChar == 'Y') && Board::hasSyncPort) {
+            cycleSyncRole(); // Off -> Leader -> Follower, available in any state
+        } else if (incomingChar == 'a' || incomingChar == 'A') {
+            pixelStreamBegin(fastLedState.brightness); // Adalight frames from the PC until idle, available in any state
+        } else if (incomingChar == 'l' || incomingChar == 'L') {
+            toggleSoakLog(); // Sensor/power records to flash, available in any state
+        } else if (incomingChar == 'd' || incomingChar == 'D') {
+            soakLogDump(); // All soak log records as hex lines, available in any state
+        } else if ((incomingChar == 'g' || incomingChar == 'G') && Board::numLedDataPins > 1) {
+            cycleLedSegments(); // 1 -> 2 -> ... data pins, available in any state
+        } else if (currentState == MENU) {
             if (isdigit(incomingChar)) {
                 int selected = incomingChar - '0'; // Convert char to int
-                if (selected >= 0 && selected < numModes) {
+                if (selected >= 0 && selected < numModes && modeTable[selected].available) {
                     menuSelection = selected; // Update selection visually (optional)
                     // Don't simulate press here, just update selection
-                    Serial.print("Selected menu item via Serial: "); Serial.println(menuSelection);
+                    LOG_INFO("Selected menu item via Serial: %d", menuSelection);
                     stateChanged = true; // Force display update
                     delay(50); // Allow serial buffer to clear slightly
                 } else {
-                    Serial.println("Invalid menu number.");
+                    LOG_WARN("Invalid menu number.");
                 }
             } else if (incomingChar == '\n') { // Enter key in MENU
-                 Serial.println("Simulating Enter Press (Select) via Serial");
+                 LOG_DEBUG("Simulating Enter Press (Select) via Serial");
                  rotButtonPressedEvent = true; // Simulate press to enter selected mode
             } else {
                 // Optional: Handle other chars in menu mode if needed
@@ -780,50 +1621,59 @@ void loop() {
         } else if (currentState == ACTION) {
             if (incomingChar == '+') {
                  // Directly simulate a positive change step for serial (reversed)
-                 encoderChangeSteps = -1; // Simulate one step down (because main logic is reversed)
-                 Serial.println("Simulating Encoder + Step via Serial (Reversed to Down)");
+                 encoderChangeSteps = -1; encoderSpeed = 0; // Simulate one step down (because main logic is reversed)
+                 LOG_DEBUG("Simulating Encoder + Step via Serial (Reversed to Down)");
             } else if (incomingChar == '-') {
                  // Directly simulate a negative change step for serial (reversed)
-                 encoderChangeSteps = 1; // Simulate one step up (because main logic is reversed)
-                 Serial.println("Simulating Encoder - Step via Serial (Reversed to Up)");
+                 encoderChangeSteps = 1; encoderSpeed = 0; // Simulate one step up (because main logic is reversed)
+                 LOG_DEBUG("Simulating Encoder - Step via Serial (Reversed to Up)");
+            } else if ((incomingChar == 'e' || incomingChar == 'E') && pwmLedForMode(currentMode) != nullptr) {
+                LedPwmState* led = pwmLedForMode(currentMode);
+                led->effect = (PwmEffect)((led->effect + 1) % NUM_PWM_EFFECTS);
+                led->isOn = true;
+                LOG_INFO("Effect set to: %s", pwmEffectNames[led->effect]);
+                stateChanged = true;
             } else if (incomingChar == 'b' || incomingChar == 'B') {
                 rotButtonPressedEvent = true; // Simulate press to go back
-                 Serial.println("Simulating Back button via Serial");
+                 LOG_DEBUG("Simulating Back button via Serial");
             } else if (incomingChar == '\n') { // Enter key in ACTION
-                 Serial.println("Simulating Enter Press (Back) via Serial");
+                 LOG_DEBUG("Simulating Enter Press (Back) via Serial");
                  rotButtonPressedEvent = true; // Simulate press to go back
             } else {
                 // Optional: Handle other chars in action mode if needed
             }
         }
-        // Consume any remaining characters in the buffer for this loop cycle
-        while(Serial.available() > 0) { Serial.read(); }
+        // Consume any remaining characters in the buffer for this loop cycle (a new stream keeps them)
+        while(!pixelStreamActive() && Serial.available() > 0) { Serial.read(); }
     }
 
 
     // --- 2. Process Inputs & Handle UI State Transitions ---
+    loopWatchdogStage(LOOP_STAGE_UI);
 
     bool performMenuExit = false; // Flag to signal exiting ACTION mode
 
     // --- State Transitions First ---
     // Check for Idle Timeout
     if (currentState == MENU && (millis() - lastInteractionTime > idleTimeoutDuration)) {
-        Serial.println("Idle timeout, returning to splash screen.");
+        LOG_INFO("Idle timeout, returning to splash screen.");
         currentState = SPLASH;
         displaySplashScreen(); // Show splash immediately
+        loopWatchdogEndIteration(); // Count this iteration too, before the sleep
+        waitForNextEvent();
         return; // Skip further processing this loop iteration
     }
 
     // Handle transition from IDLE SPLASH state on interaction
     if (currentState == SPLASH && interactionDetected) {
-        Serial.println("Interaction detected, returning to menu.");
+        LOG_INFO("Interaction detected, returning to menu.");
         currentState = MENU;
         stateChanged = true; 
     }
 
     // Handle transition from STARTUP SPLASH state on interaction
     if (currentState == STARTUP_SPLASH && interactionDetected) {
-        Serial.println("Interaction detected, entering menu.");
+        LOG_INFO("Interaction detected, entering menu.");
         currentState = MENU;
         stateChanged = true; 
         encoderChangeSteps = 0; // Consume the encoder change that triggered the transition
@@ -834,44 +1684,11 @@ void loop() {
         interactionDetected = true; // Button press is interaction
         currentMode = (AppMode)menuSelection;
         currentState = ACTION;
+        waitForPeripherals(); // Modes may use the display and sensors right away
         stateChanged = true;
-        Serial.print("\nEntering mode: ");
-        Serial.println(modeNames[currentMode]);
-        // Mode-specific entry actions
-        switch (currentMode) {
-            case ESP_INFO:
-                printEspInfo();
-                break;
-            case FASTLED_TEST:
-            case LED2_MODE:
-            case LED3_MODE:
-            case LED4_MODE:
-                break; // No specific entry action needed
-            case LIGHT_SENSOR:
-            case INA219_SENSOR:
-                lastSensorReadTime = millis() - sensorReadInterval; // Force immediate read
-                readAndPrintLightSensor(); // Read both, only INA needed for display update here
-                readAndPrintIna219();
-                if (currentMode == INA219_SENSOR && displayAvailable) {
-                    updateDisplay(); // Force display update *after* reading
-                }
-                break;
-            case I2C_SCANNER:
-                lastI2cDeviceCount = scanI2CBus(); // Scan and store result on entry
-                break;
-            case LED_CHIPSET_SELECT:
-                // Initialize proposed selection to current saved value on entry
-                chipsetSelectionProposed = savedChipsetType;
-                break;
-            case FASTLED_PATTERN:
-                // Initialize proposed selection to current pattern
-                patternSelectionProposed = currentFastLedPattern;
-                break;
-            case LED_COUNT_SELECT:
-                // Initialize proposed selection to current LED count
-                numLedsProposed = numLedsConfigured;
-                break;
-        }
+        LOG_INFO("Entering mode: %s", modeTable[currentMode].name);
+        if (modeTable[currentMode].enter) { modeTable[currentMode].enter(); }
+        nextModeRefreshTime = millis() + modeTable[currentMode].refreshMs;
         // Consume the button press event after using it for state transition
         rotButtonPressedEvent = false; 
     }
@@ -885,365 +1702,162 @@ void loop() {
     if (currentState == MENU) {
         // Handle encoder for menu navigation
         if (encoderChangeSteps != 0) {
-            menuSelection = constrain(menuSelection + encoderChangeSteps, 0, numModes - 1);
-            Serial.print("Menu Selection Changed: "); Serial.println(menuSelection);
+            menuSelection = stepMenuSelection(menuSelection, encoderChangeSteps);
+            LOG_INFO("Menu Selection Changed: %d", menuSelection);
             stateChanged = true; 
         }
     } else if (currentState == ACTION) {
+        const ModeDescriptor& mode = modeTable[currentMode];
         // Handle encoder changes within ACTION mode
         if (encoderChangeSteps != 0) {
             interactionDetected = true; // Encoder counts as interaction
             lastInteractionTime = millis(); // Update timer immediately
-            bool brightnessChanged = false;
-            int brightnessStep = encoderChangeSteps * 3; 
-            switch (currentMode) {
-                case FASTLED_TEST:
-                    fastLedState.brightness = constrain(fastLedState.brightness + brightnessStep, 0, 255);
-                    fastLedState.isOn = true;
-                    brightnessChanged = true;
-                    break;
-                case LED2_MODE:
-                    led2State.brightness = constrain(led2State.brightness + brightnessStep, 0, 255);
-                    led2State.isOn = true;
-                    brightnessChanged = true;
-                    break;
-                case LED3_MODE:
-                    led3State.brightness = constrain(led3State.brightness + brightnessStep, 0, 255);
-                    led3State.isOn = true;
-                    brightnessChanged = true;
-                    break;
-                case LED4_MODE:
-                    led4State.brightness = constrain(led4State.brightness + brightnessStep, 0, 255);
-                    led4State.isOn = true;
-                    brightnessChanged = true;
-                    break;
-                case LIGHT_SENSOR:
-                case INA219_SENSOR:
-                    fastLedState.brightness = constrain(fastLedState.brightness + brightnessStep, 0, 255);
-                    fastLedState.isOn = true;
-                    brightnessChanged = true;
-                    break;
-                case LED_CHIPSET_SELECT:
-                    chipsetSelectionProposed = (chipsetSelectionProposed + encoderChangeSteps) % NUM_CHIPSET_TYPES;
-                    if (chipsetSelectionProposed < 0) { chipsetSelectionProposed += NUM_CHIPSET_TYPES; }
-                    Serial.print("Proposed chipset: "); Serial.println(chipsetNames[chipsetSelectionProposed]);
-                    break;
-                case FASTLED_PATTERN:
-                    // Encoder changes the proposed pattern selection
-                    patternSelectionProposed = (patternSelectionProposed + encoderChangeSteps) % NUM_FASTLED_PATTERNS;
-                    if (patternSelectionProposed < 0) { patternSelectionProposed += NUM_FASTLED_PATTERNS; }
-                    Serial.print("Proposed pattern: "); Serial.println(patternNames[patternSelectionProposed]);
-                    break;
-                case LED_COUNT_SELECT:
-                    // Encoder changes the proposed LED count
-                    numLedsProposed = constrain(numLedsProposed + encoderChangeSteps, 1, MAX_LEDS);
-                    Serial.print("Proposed LED count: "); Serial.println(numLedsProposed);
-                    break;
-            }
-            // Log brightness changes
-            if (brightnessChanged) {
-                 Serial.print("Brightness set to: ");
-                 if(currentMode == FASTLED_TEST || currentMode == LIGHT_SENSOR || currentMode == INA219_SENSOR) Serial.println(fastLedState.brightness);
-                 else if(currentMode == LED2_MODE) Serial.println(led2State.brightness);
-                 else if(currentMode == LED3_MODE) Serial.println(led3State.brightness);
-                 else if(currentMode == LED4_MODE) Serial.println(led4State.brightness);
-            }
+            if (mode.encoder) { mode.encoder(encoderChangeSteps); }
             stateChanged = true; // Update display after encoder action
         }
 
-        // Handle button press within ACTION mode
+        // Handle button press within ACTION mode: the mode commits its selection, if any, then exits
         if (rotButtonPressedEvent) {
             interactionDetected = true; // Button press is interaction
             lastInteractionTime = millis(); // Update timer immediately
-            Serial.println("Button pressed in ACTION state."); // Debug
-            if (currentMode == LED_CHIPSET_SELECT) {
-                // --- SAVE Logic --- 
-                savedChipsetType = chipsetSelectionProposed;
-                Serial.print("Saving Chipset Type: "); Serial.println(chipsetNames[savedChipsetType]);
-                preferences.begin("led-config", false);
-                preferences.putInt("chipset", savedChipsetType);
-                preferences.end();
-                Serial.print("** Chipset selection saved: "); Serial.print(chipsetNames[savedChipsetType]); // Added **
-                Serial.println(". Reboot required for change to take effect. **");
-                
-                // --- Display Save Message ---
-                if (displayAvailable) {
-                    u8g2.clearBuffer();
-                    u8g2.setFont(u8g2_font_profont22_tf); // Use standard font
-                    int line1Y = 14; // Centered vertically-ish
-                    int line2Y = line1Y + 16;
-                    u8g2.drawStr(u8g2.getDisplayWidth()/2 - u8g2.getStrWidth("Saved!")/2, line1Y, "Saved!");
-                    u8g2.drawStr(u8g2.getDisplayWidth()/2 - u8g2.getStrWidth("Reboot!")/2, line2Y, "Reboot!");
-                    u8g2.sendBuffer();
-                    delay(2000); // Show message for 2 seconds
-                }
-                // --- End Display Save Message ---
-                
-                // We still exit to menu after saving
-                performMenuExit = true;
-            } else if (currentMode == FASTLED_PATTERN) {
-                // --- Set Pattern Logic --- 
-                currentFastLedPattern = (FastLedPattern)patternSelectionProposed;
-                Serial.print("** Pattern set to: "); Serial.println(patternNames[currentFastLedPattern]);
-                // Clear FastLED buffer when changing patterns
-                FastLED.clear(true); // Clear and show black
-                // Reset pattern state if needed (e.g., for RGB checker)
-                rgbCheckerStage = 0;
-                rgbCheckerPulseCount = 0;
-                lastRgbCheckerActionTime = millis();
-                rgbCheckerLedState = false;
-                performMenuExit = true; // Exit to menu after setting
-            } else if (currentMode == LED_COUNT_SELECT) {
-                // --- SAVE Logic --- 
-                numLedsConfigured = numLedsProposed;
-                Serial.print("Saving LED Count: "); Serial.println(numLedsConfigured);
-                preferences.begin("led-config", false);
-                preferences.putInt("ledCount", numLedsConfigured);
-                preferences.end();
-                Serial.print("** LED count saved: "); Serial.print(numLedsConfigured); // Added **
-                Serial.println(". Reboot required for change to take effect. **");
-                
-                // --- Display Save Message ---
-                if (displayAvailable) {
-                    u8g2.clearBuffer();
-                    u8g2.setFont(u8g2_font_profont22_tf); // Use standard font
-                    int line1Y = 14; // Centered vertically-ish
-                    int line2Y = line1Y + 16;
-                    u8g2.drawStr(u8g2.getDisplayWidth()/2 - u8g2.getStrWidth("Saved!")/2, line1Y, "Saved!");
-                    u8g2.drawStr(u8g2.getDisplayWidth()/2 - u8g2.getStrWidth("Reboot!")/2, line2Y, "Reboot!");
-                    u8g2.sendBuffer();
-                    delay(2000); // Show message for 2 seconds
-                }
-                // --- End Display Save Message ---
-                
-                // We still exit to menu after saving
-                performMenuExit = true;
-            } else {
-                // Default action for other modes is just to exit
-                performMenuExit = true;
-            }
+            LOG_DEBUG("Button pressed in ACTION state.");
+            if (mode.button) { mode.button(); }
+            performMenuExit = true;
         }
-        
-        // Perform continuous actions for specific modes
-        if (currentMode == LIGHT_SENSOR) {
-            readAndPrintLightSensor();
-        } else if (currentMode == INA219_SENSOR) {
-            readAndPrintIna219();
-        }
-
     } // End ACTION state processing
 
     // Perform exit from ACTION to MENU if flagged
     if (performMenuExit) {
         currentState = MENU;
         stateChanged = true;
-        Serial.println("Exiting mode to Menu.");
+        LOG_INFO("Exiting mode to Menu.");
     }
 
 
     // --- Process Direct Button Actions (Physical Buttons) ---
-    if (inputState.userButtonPressedEvent) {
-        Serial.println("User Button Pressed - Toggling LED 4");
+    if (userButtonPressedEvent) {
+        LOG_INFO("User Button Pressed - Toggling LED 4");
         led4State.isOn = !led4State.isOn;
         stateChanged = true; // May need display update if in LED4 mode
     }
-    if (inputState.bootButtonPressedEvent) {
-        Serial.println("Boot Button Pressed - Toggling LED 3");
+    if (bootButtonPressedEvent) {
+        LOG_INFO("Boot Button Pressed - Toggling LED 3");
         led3State.isOn = !led3State.isOn;
          stateChanged = true; // May need display update if in LED3 mode
     }
 
     // --- 3. Update LED/Output States (Every Cycle) ---
+    loopWatchdogStage(LOOP_STAGE_PATTERN);
+    if constexpr (Board::hasSyncPort) { serviceAnimationSync(); }
     // Call the appropriate pattern function based on state
 
     // --- Restore Original Pattern Switch --- 
-    switch (currentFastLedPattern) {
-        case RAINBOW:
-            runRainbowPattern();
-            break;
-        case RGB_CHECKER:
-            runRgbCheckerPattern();
-            break;
-        case CHASE:
-            runChasePattern();
-            break;
+    // Patterns only run once their next frame is due, and not over a pixel stream
+    if (!pixelStreamActive() && (long)(millis() - nextPatternFrameTime) >= 0) {
+        loopStats.patternFrames++;
+        runActivePattern();
     }
+    ledOutputRefreshIfDue(); // Unchanged frames are still resent periodically
     // --- End Restore ---
 
-    /* // DEBUG code removed
-    // --- DEBUG: Force Rainbow Pattern ---
-    runRainbowPattern();
-    // --- END DEBUG ---
-    */
-    /* // Original switch temporarily disabled - REMOVED
-    switch (currentFastLedPattern) {
-        case RAINBOW:
-            runRainbowPattern();
-            break;
-        case RGB_CHECKER:
-            runRgbCheckerPattern();
-            break;
-    }
-    */
 
-    // PWM LED Update
-    ledcWrite(ledcChannel2, led2State.isOn ? led2State.brightness : 0);
-    ledcWrite(ledcChannel3, led3State.isOn ? led3State.brightness : 0);
-    ledcWrite(ledcChannel4, led4State.isOn ? led4State.brightness : 0);
+    // PWM LED Update (only channels whose duty changed)
+    loopWatchdogStage(LOOP_STAGE_PWM);
+    writePwmLeds();
 
     // --- 4. Perform Continuous Mode Actions (Sensors/Info) ---
-    if (currentState == ACTION) {
-        switch (currentMode) {
-            // ESP_INFO printed once on entry
-            case LIGHT_SENSOR:
-                readAndPrintLightSensor();
-                break;
-            case INA219_SENSOR:
-                readAndPrintIna219();
-                break;
-            // I2C_SCANNER done on entry
-            default: // No continuous actions for other modes
-                break;
-        }
+    loopWatchdogStage(LOOP_STAGE_SENSORS);
+    // Modes with a refresh period are ticked (sensor reads, page flips) and redrawn on schedule
+    bool modeRefreshDue = currentState == ACTION && modeTable[currentMode].refreshMs > 0 &&
+                          (long)(millis() - nextModeRefreshTime) >= 0;
+    if (modeRefreshDue) {
+        if (modeTable[currentMode].tick) { modeTable[currentMode].tick(); }
+        nextModeRefreshTime = millis() + modeTable[currentMode].refreshMs;
+    }
+    if (soakLogReady() && (long)(millis() - nextSoakSampleTime) >= 0) {
+        sampleSoakLog();
+        nextSoakSampleTime += SOAK_LOG_INTERVAL_MS;
+        if ((long)(millis() - nextSoakSampleTime) >= 0) { nextSoakSampleTime = millis() + SOAK_LOG_INTERVAL_MS; } // Don't catch up after a stall
     }
 
     // --- 5. Update Display ---
-    // Update display if state changed, or sensor was read, or in relevant action modes
-    if (stateChanged || (currentState == ACTION && 
-       (currentMode == FASTLED_TEST || currentMode == LED_CHIPSET_SELECT || currentMode == FASTLED_PATTERN || 
-        currentMode == INA219_SENSOR || currentMode == LIGHT_SENSOR || currentMode == LED_COUNT_SELECT)) ) 
-    {
-       updateDisplay();
-    } else if (currentState == MENU && encoderChangeSteps != 0) {
-        // Update display in menu mode immediately if encoder moved
+    loopWatchdogStage(LOOP_STAGE_DISPLAY);
+    if (!bootFinished && peripheralsReady) { finishBoot(); }
+    if (splashAnimationActive && (long)(millis() - nextSplashFrameTime) >= 0) { stepSplashAnimation(); }
+    // Expired overlays hand the screen back to the normal UI
+    if (overlayActive && (long)(millis() - overlayUntil) >= 0) {
+        overlayActive = false;
+        stateChanged = true;
+    }
+    // Redraw on state changes, scheduled mode refreshes, and menu navigation
+    if (stateChanged || modeRefreshDue || (currentState == MENU && encoderChangeSteps != 0)) {
         updateDisplay();
     }
 
-    // Small delay to prevent loop spinning too fast if no other delays are hit
-    // delay(1); // Add small delay if needed, but FastLED delay might be sufficient
-}
+    loopWatchdogEndIteration(); // Budgets are checked against the work above, not the sleep
 
-// --- Pattern Functions ---
-void runRainbowPattern() {
-    if (!fastLedState.isOn) {
-        FastLED.clearData();
-        // Don't call show if LEDs are meant to be off
-        return; 
-    }
-    FastLED.setBrightness(fastLedState.brightness);
-    fastLedState.hue++; 
-    fill_rainbow(leds, numLedsConfigured, fastLedState.hue, 7); 
-    FastLED.show();
-    delay(10); // Keep delay associated with rainbow animation rate
+    // --- 6. Sleep Until Next Event ---
+    // Blocks until an input notification or the next pattern/sensor/debounce/idle deadline
+    waitForNextEvent();
 }
 
-void runRgbCheckerPattern() {
+// --- Pattern Functions ---
+// Render the active pattern at the current pattern time and schedule the next
+// frame for when its output can next change.
+void runActivePattern() {
     if (!fastLedState.isOn) {
-        FastLED.clearData();
-        // Don't call show if LEDs are meant to be off
+        ledOutputClear(); // Blank the strip; no frames are scheduled while off
         return;
     }
 
-    FastLED.setBrightness(fastLedState.brightness);
-    unsigned long currentTime = millis();
-    unsigned long timeSinceLastAction = currentTime - lastRgbCheckerActionTime;
-    int pulsesNeeded = 0;
-    CRGB currentColor;
-    const char* colorName = "";
-
-    // Determine current stage details
-    switch (rgbCheckerStage) {
-        case 0: pulsesNeeded = 1; currentColor = CRGB::Red; colorName = "Red"; break;
-        case 1: pulsesNeeded = 2; currentColor = CRGB::Green; colorName = "Green"; break; // Swapped G and B for common order
-        case 2: pulsesNeeded = 3; currentColor = CRGB::Blue; colorName = "Blue"; break; 
-    }
-
-    bool updateLeds = false;
+    const PatternDescriptor& pattern = patterns[currentFastLedPattern];
+    uint32_t t = patternClockNow() - patternEpoch;
+
+    // Render into the back buffer while the previous frame is still on the wire
+#if LED_INDEXED_FRAMEBUFFER
+    uint8_t* indices = ledOutputBeginIndexedFrame();
+    pattern.renderIndexed(t, indices, numLedsConfigured);
+    pattern.updatePalette(t, ledOutputPalette());
+    ledOutputPresentIndexed(fastLedState.brightness, numLedsConfigured);
+#else
+    CRGB* frame = ledOutputBeginFrame();
+    pattern.render(t, frame, numLedsConfigured);
+    ledOutputPresent(fastLedState.brightness);
+#endif
+    nextPatternFrameTime = millis() + (pattern.nextChange(t, numLedsConfigured) - t);
 
-    // State machine for pulsing
-    if (rgbCheckerLedState) { // Currently ON
-        if (timeSinceLastAction >= pulseOnTime) {
-            fill_solid(leds, numLedsConfigured, CRGB::Black);
-            rgbCheckerLedState = false;
-            lastRgbCheckerActionTime = currentTime;
-            rgbCheckerPulseCount++;
-            updateLeds = true;
+    if (currentFastLedPattern == RGB_CHECKER) {
+        RgbCheckerPhase phase = rgbCheckerPhaseAt(t);
+        if (phase.on && phase.start != lastCheckerPulseLogged) {
+            LOG_INFO("RGB Check: %s", rgbCheckerColorNames[phase.stage]); // Log color pulse
+            lastCheckerPulseLogged = phase.start;
         }
-    } else { // Currently OFF
-        if (rgbCheckerPulseCount >= pulsesNeeded) { // Done with pulses for this color?
-            if (timeSinceLastAction >= interColorDelay) { // Wait before next color
-                rgbCheckerStage = (rgbCheckerStage + 1) % 3;
-                rgbCheckerPulseCount = 0;
-                // Re-determine details for the NEW stage immediately
-                switch (rgbCheckerStage) {
-                    case 0: pulsesNeeded = 1; currentColor = CRGB::Red; colorName = "Red"; break;
-                    case 1: pulsesNeeded = 2; currentColor = CRGB::Green; colorName = "Green"; break; 
-                    case 2: pulsesNeeded = 3; currentColor = CRGB::Blue; colorName = "Blue"; break; 
-                }
-                // Start next color's pulse
-                fill_solid(leds, numLedsConfigured, currentColor); // Use the new currentColor
-                rgbCheckerLedState = true;
-                lastRgbCheckerActionTime = currentTime;
-                Serial.print("RGB Check: "); Serial.println(colorName); // Log color change
-                updateLeds = true;
-            }
-        } else { // Still need more pulses for this color
-            if (timeSinceLastAction >= pulseOffTime) { // Time for next pulse?
-                 fill_solid(leds, numLedsConfigured, currentColor);
-                 rgbCheckerLedState = true;
-                 lastRgbCheckerActionTime = currentTime;
-                 Serial.print("RGB Check: "); Serial.println(colorName); // Log color change
-                 updateLeds = true;
-            }
-        }
-    }
-
-    if (updateLeds) {
-        FastLED.show();
     }
-    // No delay here, timing is handled by millis()
 }
 
-void runChasePattern() {
-    if (!fastLedState.isOn) {
-        // Ensure strip is off if state is off
-        if (FastLED.getBrightness() > 0) { // Check if it was previously on
-            FastLED.clear(true); // Clear and force show
-        }
-        FastLED.setBrightness(0); // Explicitly set brightness to 0
-        return;
+// Exchange sync beacons; a follower takes the leader's pattern and start time
+void serviceAnimationSync() {
+    syncLinkService({(uint8_t)currentFastLedPattern, patternEpoch});
+    SyncPatternState leader;
+    if (syncLinkLeaderState(leader) && leader.pattern < NUM_FASTLED_PATTERNS &&
+        (leader.pattern != currentFastLedPattern || leader.epochMs != patternEpoch)) {
+        currentFastLedPattern = (FastLedPattern)leader.pattern;
+        patternEpoch = leader.epochMs;
+        lastCheckerPulseLogged = UINT32_MAX;
+        nextPatternFrameTime = millis(); // Redraw on the shared timeline now
     }
+}
 
-    unsigned long currentTime = millis();
-    if (currentTime - lastChaseUpdateTime >= chaseStepDelay) {
-        lastChaseUpdateTime = currentTime;
-
-        FastLED.setBrightness(fastLedState.brightness); // Apply global brightness
-
-        // --- Wave Logic --- 
-        // Update the wave position
-        chasePosition += 0.1; // Adjust this value to change speed independent of update rate
-        if (chasePosition >= numLedsConfigured) {
-            chasePosition -= numLedsConfigured; // Wrap based on configured count
-        }
-
-        // Update all LEDs based on distance from the wave position
-        for (int i = 0; i < numLedsConfigured; i++) {
-            // Calculate distance, handling wrap-around
-            float distance = abs(i - chasePosition);
-            float distanceWrap = min(distance, (float)numLedsConfigured - distance); // Wrap based on configured count
-
-            // Calculate brightness based on distance (linear falloff)
-            int brightness = 255 - (int)(distanceWrap * chaseFadeRate);
-            brightness = max(0, brightness); // Clamp at 0
-
-            // Set LED color (White)
-            leds[i] = CRGB(brightness, brightness, brightness);
-        }
-        // --- End Wave Logic ---
-
-        FastLED.show();
-    }
-    // No delay needed, timing handled by chaseStepDelay
+// Step to the next sync role and save it; the pattern restarts on the new clock
+void cycleSyncRole() {
+    savedSyncRole = (SyncRole)((savedSyncRole + 1) % NUM_SYNC_ROLES);
+    syncLinkSetRole(savedSyncRole);
+    preferences.begin("led-config", false);
+    preferences.putInt("syncRole", savedSyncRole);
+    preferences.end();
+    LOG_INFO("Animation sync: %s", syncRoleNames[savedSyncRole]);
+    patternEpoch = patternClockNow();
+    lastCheckerPulseLogged = UINT32_MAX;
+    nextPatternFrameTime = millis();
 }
 // --- End Pattern Functions ---
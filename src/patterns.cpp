@@ -0,0 +1,162 @@
+#include "patterns.h"
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+static uint32_t systemClock() { return millis(); }
+#else
+static uint32_t systemClock() { return 0; } // Host builds inject their own clock
+#endif
+
+static PatternClockFn patternClock = systemClock;
+
+void setPatternClock(PatternClockFn clock) {
+    patternClock = clock != nullptr ? clock : systemClock;
+}
+
+uint32_t patternClockNow() {
+    return patternClock();
+}
+
+// --- Rainbow ---
+const uint32_t rainbowFrameDelay = 10; // ms per hue step
+const uint8_t rainbowDeltaHue = 7;     // Hue difference between neighbouring pixels
+
+void renderRainbow(uint32_t t, CRGB* leds, int n) {
+    uint8_t hue = (uint8_t)(t / rainbowFrameDelay);
+    fill_rainbow(leds, n, hue, rainbowDeltaHue);
+}
+
+// Pixel i shows hue (t-hue + 7i); the index is the per-pixel hue offset,
+// so animating is a rotation of the palette and the indices never change.
+void renderRainbowIndexed(uint32_t t, uint8_t* indices, int n) {
+    uint8_t offset = 0;
+    for (int i = 0; i < n; i++) {
+        indices[i] = offset;
+        offset += rainbowDeltaHue;
+    }
+}
+
+void updateRainbowPalette(uint32_t t, CRGB* palette) {
+    fill_rainbow(palette, paletteSize, (uint8_t)(t / rainbowFrameDelay), 1);
+}
+
+static uint32_t rainbowNextChange(uint32_t t, int n) {
+    return (t / rainbowFrameDelay + 1) * rainbowFrameDelay;
+}
+
+// --- RGB Checker ---
+// Red pulses once, Green twice, Blue three times, then the cycle repeats.
+const uint32_t pulseOnTime = 500;     // ms
+const uint32_t pulseOffTime = 250;    // ms between pulses of one color
+const uint32_t interColorDelay = 600; // ms after the last pulse of a color
+const uint32_t checkerLeadIn = pulseOffTime; // Dark time before the first Red pulse
+
+const char* const rgbCheckerColorNames[3] = {"Red", "Green", "Blue"};
+static const CRGB checkerColors[3] = {CRGB::Red, CRGB::Green, CRGB::Blue};
+
+static uint32_t checkerStageLength(uint8_t stage) {
+    uint32_t pulses = stage + 1;
+    return pulses * pulseOnTime + (pulses - 1) * pulseOffTime + interColorDelay;
+}
+
+RgbCheckerPhase rgbCheckerPhaseAt(uint32_t t) {
+    RgbCheckerPhase phase = {0, false, 0, checkerLeadIn};
+    if (t < checkerLeadIn) return phase;
+
+    const uint32_t cycleLength = checkerStageLength(0) + checkerStageLength(1) + checkerStageLength(2);
+    uint32_t cycleStart = checkerLeadIn + (t - checkerLeadIn) / cycleLength * cycleLength;
+    uint32_t segmentStart = cycleStart;
+
+    for (uint8_t stage = 0; stage < 3; stage++) {
+        uint8_t pulses = stage + 1;
+        for (uint8_t pulse = 0; pulse < pulses; pulse++) {
+            bool lastPulse = (pulse == pulses - 1);
+            uint32_t offTime = lastPulse ? interColorDelay : pulseOffTime;
+            if (t < segmentStart + pulseOnTime) {
+                return {stage, true, segmentStart, segmentStart + pulseOnTime};
+            }
+            segmentStart += pulseOnTime;
+            if (t < segmentStart + offTime) {
+                return {stage, false, segmentStart, segmentStart + offTime};
+            }
+            segmentStart += offTime;
+        }
+    }
+    return phase; // Unreachable, t always falls inside the cycle
+}
+
+void renderRgbChecker(uint32_t t, CRGB* leds, int n) {
+    RgbCheckerPhase phase = rgbCheckerPhaseAt(t);
+    fill_solid(leds, n, phase.on ? checkerColors[phase.stage] : CRGB(CRGB::Black));
+}
+
+// Whole strip shows palette entry 0, which carries the current color
+void renderRgbCheckerIndexed(uint32_t t, uint8_t* indices, int n) {
+    memset(indices, 0, n);
+}
+
+void updateRgbCheckerPalette(uint32_t t, CRGB* palette) {
+    RgbCheckerPhase phase = rgbCheckerPhaseAt(t);
+    palette[0] = phase.on ? checkerColors[phase.stage] : CRGB(CRGB::Black);
+}
+
+static uint32_t rgbCheckerNextChange(uint32_t t, int n) {
+    return rgbCheckerPhaseAt(t).end;
+}
+
+// --- Chase ---
+// A white wave moving 0.1 pixel every 2 ms, with linear brightness falloff.
+// Position is kept in tenths of a pixel so the wave is exact in integers.
+const uint32_t chaseStepDelay = 2;   // ms between position updates
+const int chaseFadeRate = 100;       // Brightness decrease per pixel distance (Higher = narrower wave)
+
+// Calls lit(i, brightness) for each pixel the wave lights at time t
+template <typename LitFn>
+static void forEachChasePixel(uint32_t t, int n, LitFn lit) {
+    const int32_t span = (int32_t)n * 10;
+    int32_t position = (int32_t)((t / chaseStepDelay) % (uint32_t)span);
+
+    // Only pixels within 255 / chaseFadeRate of the wave centre are lit
+    const int reach = 255 / chaseFadeRate + 1;
+    int centre = position / 10;
+    for (int offset = -reach; offset <= reach + 1; offset++) {
+        int i = ((centre + offset) % n + n) % n;
+        int32_t distance = i * 10 - position;
+        if (distance < 0) distance = -distance;
+        if (span - distance < distance) distance = span - distance; // Wrap around the strip
+        int brightness = 255 - (int)(distance * chaseFadeRate / 10);
+        if (brightness > 0) {
+            lit(i, (uint8_t)brightness);
+        }
+    }
+}
+
+void renderChase(uint32_t t, CRGB* leds, int n) {
+    if (n <= 0) return;
+    fill_solid(leds, n, CRGB::Black);
+    forEachChasePixel(t, n, [leds](int i, uint8_t brightness) { leds[i] = CRGB(brightness, brightness, brightness); });
+}
+
+// Indices are the white level; the palette is a fixed grey ramp
+void renderChaseIndexed(uint32_t t, uint8_t* indices, int n) {
+    if (n <= 0) return;
+    memset(indices, 0, n);
+    forEachChasePixel(t, n, [indices](int i, uint8_t brightness) { indices[i] = brightness; });
+}
+
+void updateChasePalette(uint32_t t, CRGB* palette) {
+    for (int i = 0; i < paletteSize; i++) {
+        palette[i] = CRGB(i, i, i);
+    }
+}
+
+static uint32_t chaseNextChange(uint32_t t, int n) {
+    return (t / chaseStepDelay + 1) * chaseStepDelay;
+}
+
+const PatternDescriptor patterns[NUM_FASTLED_PATTERNS] = {
+    {"Rainbow", renderRainbow, rainbowNextChange, renderRainbowIndexed, updateRainbowPalette},
+    {"RGB Check", renderRgbChecker, rgbCheckerNextChange, renderRgbCheckerIndexed, updateRgbCheckerPalette},
+    {"Chase", renderChase, chaseNextChange, renderChaseIndexed, updateChasePalette},
+};
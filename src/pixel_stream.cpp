@@ -0,0 +1,110 @@
+#include "pixel_stream.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const uint8_t adalightMagic[3] = {'A', 'd', 'a'};
+
+PixelStreamParser::PixelStreamParser(int maxPixels) : maxPixels(maxPixels) {}
+
+uint8_t* PixelStreamParser::writePointer(size_t& maxBytes) {
+    switch (state) {
+        case HEADER:
+            maxBytes = pixelStreamHeaderSize - headerLength;
+            return header + headerLength;
+        case PAYLOAD:
+            maxBytes = payloadSize - payloadDone;
+            return frame + payloadDone;
+        case SKIP:
+            maxBytes = payloadSize - payloadDone < sizeof(skipBuffer) ? payloadSize - payloadDone : sizeof(skipBuffer);
+            return skipBuffer;
+        default:
+            maxBytes = 0;
+            return nullptr;
+    }
+}
+
+void PixelStreamParser::dropHeaderByte() {
+    memmove(header, header + 1, --headerLength);
+}
+
+PixelStreamEvent PixelStreamParser::commit(size_t count, uint32_t nowMs) {
+    if (count == 0) return PIXEL_STREAM_NONE;
+    lastByteMs = nowMs;
+
+    if (state == PAYLOAD || state == SKIP) {
+        payloadDone += count;
+        if (payloadDone < payloadSize) return PIXEL_STREAM_NONE;
+        bool complete = state == PAYLOAD;
+        state = HEADER;
+        if (!complete) return PIXEL_STREAM_NONE;
+        counters.frames++;
+        return PIXEL_STREAM_FRAME;
+    }
+    if (state != HEADER) return PIXEL_STREAM_NONE;
+
+    headerLength += count;
+    while (headerLength > 0) {
+        size_t magicBytes = headerLength < sizeof(adalightMagic) ? headerLength : sizeof(adalightMagic);
+        if (memcmp(header, adalightMagic, magicBytes) != 0) {
+            counters.skippedBytes++;
+            dropHeaderByte();
+            continue;
+        }
+        if (headerLength < pixelStreamHeaderSize) return PIXEL_STREAM_NONE;
+        if ((header[3] ^ header[4] ^ 0x55) != header[5]) {
+            counters.badHeaders++;
+            dropHeaderByte(); // The real header may start inside this one
+            continue;
+        }
+
+        headerLength = 0;
+        int framePixelCount = (header[3] << 8 | header[4]) + 1;
+        payloadDone = 0;
+        payloadSize = (size_t)framePixelCount * 3;
+        if (framePixelCount > maxPixels) {
+            counters.oversize++;
+            state = SKIP;
+            return PIXEL_STREAM_NONE;
+        }
+        pixels = framePixelCount;
+        state = NEED_BUFFER;
+        return PIXEL_STREAM_NEED_BUFFER;
+    }
+    return PIXEL_STREAM_NONE;
+}
+
+void PixelStreamParser::setFrameBuffer(uint8_t* buffer) {
+    if (state != NEED_BUFFER) return;
+    frame = buffer;
+    state = PAYLOAD;
+}
+
+bool PixelStreamParser::expire(uint32_t nowMs) {
+    if (msUntilExpiry(nowMs) > 0) return false;
+    bool dropped = state == PAYLOAD || state == NEED_BUFFER;
+    if (dropped) counters.timeouts++;
+    reset();
+    return dropped;
+}
+
+void PixelStreamParser::reset() {
+    state = HEADER;
+    headerLength = 0;
+    frame = nullptr;
+}
+
+uint32_t PixelStreamParser::msUntilExpiry(uint32_t nowMs) const {
+    if (state == HEADER && headerLength == 0) return UINT32_MAX; // Nothing partial to drop
+    uint32_t idleMs = nowMs - lastByteMs;
+    return idleMs >= PIXEL_STREAM_FRAME_TIMEOUT_MS ? 0 : PIXEL_STREAM_FRAME_TIMEOUT_MS - idleMs;
+}
+
+void formatPixelStreamReport(char* out, size_t size, const char* tag, const PixelStreamStats& stats,
+                             uint32_t windowFrames, uint32_t windowMs, uint32_t rxOverflows) {
+    uint32_t fpsX10 = windowMs > 0 ? (uint32_t)((uint64_t)windowFrames * 10000 / windowMs) : 0;
+    snprintf(out, size, "%s fps=%lu.%lu frames=%lu bad_headers=%lu oversize=%lu timeouts=%lu skipped_bytes=%lu rx_overflows=%lu",
+             tag, (unsigned long)(fpsX10 / 10), (unsigned long)(fpsX10 % 10), (unsigned long)stats.frames,
+             (unsigned long)stats.badHeaders, (unsigned long)stats.oversize, (unsigned long)stats.timeouts,
+             (unsigned long)stats.skippedBytes, (unsigned long)rxOverflows);
+}
@@ -0,0 +1,127 @@
+#include "pixel_stream_link.h"
+#include "led_output.h"
+#include "log.h"
+
+const unsigned long consoleBaud = 115200;
+const uint32_t streamReportIntervalMs = 1000;
+
+static PixelStreamParser parser(MAX_LEDS);
+static int streamLeds = 0; // Pixels on the wire; longer frames count as oversize
+static bool streamActive = false;
+static uint8_t streamBrightness = 0;
+static CRGB* streamFrame = nullptr;   // Back buffer the current frame is read into
+static uint32_t streamStartMs = 0;
+static bool streamHasData = false;
+static uint32_t firstDataMs = 0;
+static uint32_t lastDataMs = 0;
+static uint32_t nextReportMs = 0;
+static uint32_t reportWindowStartMs = 0;
+static uint32_t reportWindowFrames = 0;
+static volatile uint32_t rxOverflows = 0; // Driver ring or FIFO overflows, counted in the UART event task
+
+static void onSerialError(hardwareSerial_error_t error) {
+    if (streamActive && (error == UART_BUFFER_FULL_ERROR || error == UART_FIFO_OVF_ERROR)) { rxOverflows++; }
+}
+
+void pixelStreamSetupSerial() {
+    Serial.setRxBufferSize(PIXEL_STREAM_RX_BUFFER_SIZE);
+}
+
+void pixelStreamBegin(uint8_t brightness) {
+    logFlush(); // Keep queued log lines ahead of the switch
+    streamLeds = ledOutputLength();
+    Serial.printf("STREAM BEGIN baud=%lu leds=%d\n", (unsigned long)(PIXEL_STREAM_BAUD > 0 ? PIXEL_STREAM_BAUD : consoleBaud), streamLeds);
+    Serial.flush();
+    if (PIXEL_STREAM_BAUD > 0) { Serial.updateBaudRate(PIXEL_STREAM_BAUD); }
+    Serial.onReceiveError(onSerialError);
+
+    parser = PixelStreamParser(streamLeds); // Fresh state and counters
+    rxOverflows = 0;
+    streamBrightness = brightness;
+    streamFrame = nullptr;
+    streamStartMs = lastDataMs = reportWindowStartMs = millis();
+    streamHasData = false;
+    nextReportMs = streamStartMs + streamReportIntervalMs;
+    reportWindowFrames = 0;
+    streamActive = true;
+}
+
+static void printReport(const char* tag, uint32_t windowFrames, uint32_t windowMs) {
+    char line[192];
+    formatPixelStreamReport(line, sizeof(line), tag, parser.stats(), windowFrames, windowMs, rxOverflows);
+    Serial.println(line);
+}
+
+void pixelStreamEnd() {
+    if (!streamActive) return;
+    if (streamFrame != nullptr) { ledOutputCancelFrame(); }
+    streamFrame = nullptr;
+    streamActive = false;
+    // Average over the time data was arriving, not the idle wait at either end
+    printReport("STREAM END", parser.stats().frames, streamHasData ? lastDataMs - firstDataMs : 0);
+    Serial.flush();
+    if (PIXEL_STREAM_BAUD > 0) { Serial.updateBaudRate(consoleBaud); }
+    while (Serial.available() > 0) { Serial.read(); } // Pixel bytes still in flight are not commands
+}
+
+bool pixelStreamActive() {
+    return streamActive;
+}
+
+void pixelStreamService() {
+    if (!streamActive) return;
+
+    int available;
+    while ((available = Serial.available()) > 0) {
+        size_t maxBytes;
+        uint8_t* destination = parser.writePointer(maxBytes);
+        size_t length = Serial.read(destination, min((size_t)available, maxBytes));
+        uint32_t nowMs = millis();
+        if (!streamHasData) { firstDataMs = nowMs; streamHasData = true; }
+        lastDataMs = nowMs;
+
+        PixelStreamEvent event = parser.commit(length, nowMs);
+        if (event == PIXEL_STREAM_NEED_BUFFER) {
+            streamFrame = ledOutputBeginFrame();
+            parser.setFrameBuffer((uint8_t*)streamFrame);
+        } else if (event == PIXEL_STREAM_FRAME) {
+            int pixels = parser.framePixels();
+            fill_solid(streamFrame + pixels, streamLeds - pixels, CRGB::Black); // Short frames: the rest is black
+            ledOutputPresent(streamBrightness); // Waits here if the previous frame is still on the wire
+            streamFrame = nullptr;
+            reportWindowFrames++;
+        }
+    }
+
+    uint32_t nowMs = millis();
+    if (parser.expire(nowMs) && streamFrame != nullptr) {
+        ledOutputCancelFrame();
+        streamFrame = nullptr;
+    }
+    if ((int32_t)(nowMs - nextReportMs) >= 0) {
+        printReport("STREAM", reportWindowFrames, nowMs - reportWindowStartMs);
+        reportWindowFrames = 0;
+        reportWindowStartMs = nowMs;
+        nextReportMs = nowMs + streamReportIntervalMs;
+    }
+    if (nowMs - lastDataMs >= PIXEL_STREAM_IDLE_EXIT_MS) {
+        LOG_INFO("Pixel stream idle, back to patterns");
+        pixelStreamEnd();
+    }
+}
+
+unsigned long pixelStreamMsUntilDue(unsigned long maxMs) {
+    if (!streamActive) return maxMs;
+    uint32_t nowMs = millis();
+    unsigned long wait = maxMs;
+    auto consider = [&](uint32_t due) {
+        int32_t remaining = (int32_t)(due - nowMs);
+        if (remaining <= 0) { wait = 0; }
+        else if ((unsigned long)remaining < wait) { wait = remaining; }
+    };
+    consider(nextReportMs);
+    consider(lastDataMs + PIXEL_STREAM_IDLE_EXIT_MS);
+    uint32_t expiryMs = parser.msUntilExpiry(nowMs);
+    if (expiryMs != UINT32_MAX) { consider(nowMs + expiryMs); }
+    return wait;
+}
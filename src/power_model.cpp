@@ -0,0 +1,47 @@
+#include "power_model.h"
+#include "rgbw.h"
+
+uint32_t predictFrameMa(const CRGB* leds, int n, uint8_t brightness, const PowerCalibration& cal, bool rgbw) {
+    if (cal.version != powerCalibrationVersion) return 0;
+
+    uint32_t sumR = 0, sumG = 0, sumB = 0, sumW = 0;
+    if (rgbw) {
+        for (int i = 0; i < n; i++) {
+            uint8_t channels[NUM_POWER_CHANNELS];
+            rgbwExtract(leds[i], channels);
+            sumR += channels[POWER_R];
+            sumG += channels[POWER_G];
+            sumB += channels[POWER_B];
+            sumW += channels[POWER_W];
+        }
+    } else {
+        for (int i = 0; i < n; i++) {
+            sumR += leds[i].r;
+            sumG += leds[i].g;
+            sumB += leds[i].b;
+        }
+    }
+    uint64_t channelNa = (uint64_t)sumR * cal.naPerUnit[POWER_R] +
+                         (uint64_t)sumG * cal.naPerUnit[POWER_G] +
+                         (uint64_t)sumB * cal.naPerUnit[POWER_B] +
+                         (uint64_t)sumW * cal.naPerUnit[POWER_W];
+    // Global brightness scales every channel like FastLED's scale8
+    channelNa = (channelNa * ((uint32_t)brightness + 1)) >> 8;
+    return cal.darkMa + (uint32_t)(channelNa / 1000000);
+}
+
+uint32_t fitNaPerUnit(const uint8_t* levels, const int32_t* currentMa, int points, int litLeds) {
+    if (points < 2 || litLeds <= 0) return 0;
+
+    int64_t sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+    for (int i = 0; i < points; i++) {
+        sumX += levels[i];
+        sumY += currentMa[i];
+        sumXX += (int64_t)levels[i] * levels[i];
+        sumXY += (int64_t)levels[i] * currentMa[i];
+    }
+    int64_t numerator = points * sumXY - sumX * sumY;   // mA * unit, scaled by points
+    int64_t denominator = points * sumXX - sumX * sumX; // unit^2, scaled by points
+    if (denominator <= 0 || numerator <= 0) return 0;
+    return (uint32_t)(numerator * 1000000 / (denominator * litLeds));
+}
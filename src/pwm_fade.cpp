@@ -0,0 +1,178 @@
+#include "pwm_fade.h"
+
+const char* const pwmEffectNames[NUM_PWM_EFFECTS] = {"Steady", "Breathe", "Blink"};
+
+const uint8_t breatheFloorDivisor = 8; // Breathing bottoms out at brightness/8, not off
+
+uint32_t pwmFadeTimeMs(uint8_t from, uint8_t to) {
+    uint32_t delta = from > to ? from - to : to - from;
+    return delta * PWM_FADE_FULL_SCALE_MS / 255;
+}
+
+PwmProgram pwmFadeProgram(uint8_t duty, uint32_t fadeMs) {
+    PwmProgram program = {};
+    program.legs[0] = {duty, fadeMs, 0};
+    program.numLegs = 1;
+    program.repeat = false;
+    return program;
+}
+
+PwmProgram pwmEffectProgram(PwmEffect effect, uint8_t brightness) {
+    PwmProgram program = {};
+    switch (effect) {
+        case PWM_EFFECT_BREATHE:
+            program.legs[0] = {brightness, PWM_BREATHE_PERIOD_MS / 2, 0};
+            program.legs[1] = {(uint8_t)(brightness / breatheFloorDivisor), PWM_BREATHE_PERIOD_MS / 2, 0};
+            program.numLegs = 2;
+            program.repeat = true;
+            return program;
+        case PWM_EFFECT_BLINK:
+            program.legs[0] = {brightness, 0, PWM_BLINK_ON_MS};
+            program.legs[1] = {0, 0, PWM_BLINK_OFF_MS};
+            program.numLegs = 2;
+            program.repeat = true;
+            return program;
+        default:
+            return pwmFadeProgram(brightness, pwmFadeTimeMs(0, brightness));
+    }
+}
+
+static bool sameProgram(const PwmProgram& a, const PwmProgram& b) {
+    if (a.numLegs != b.numLegs || a.repeat != b.repeat) return false;
+    for (int i = 0; i < a.numLegs; i++) {
+        if (a.legs[i].duty != b.legs[i].duty || a.legs[i].fadeMs != b.legs[i].fadeMs ||
+            a.legs[i].holdMs != b.legs[i].holdMs) return false;
+    }
+    return true;
+}
+
+static bool hasDuration(const PwmProgram& program) {
+    for (int i = 0; i < program.numLegs; i++) {
+        if (program.legs[i].fadeMs > 0 || program.legs[i].holdMs > 0) return true;
+    }
+    return false;
+}
+
+PwmFadeSequencer::PwmFadeSequencer(int numChannels, const PwmFadeBackend& backend)
+    : numChannels(numChannels > pwmFadeMaxChannels ? pwmFadeMaxChannels : numChannels), backend(backend) {}
+
+void PwmFadeSequencer::request(int channel, const PwmProgram& program, uint32_t nowMs) {
+    if (channel < 0 || channel >= numChannels) return;
+    Channel& ch = channels[channel];
+    sequencerStats.requests++;
+
+    if (ch.hasPending) {
+        if (sameProgram(ch.pending, program)) { sequencerStats.unchanged++; return; }
+        sequencerStats.replaced++;
+        if (ch.hasProgram && sameProgram(ch.program, program)) {
+            ch.hasPending = false; // Back to what is already playing
+            return;
+        }
+    } else if (ch.hasProgram && sameProgram(ch.program, program)) {
+        sequencerStats.unchanged++;
+        return;
+    }
+
+    ch.pending = program;
+    if (ch.pending.repeat && !hasDuration(ch.pending)) { ch.pending.repeat = false; } // Would loop without end
+    ch.hasPending = true;
+    advance(channel, nowMs);
+}
+
+void PwmFadeSequencer::fadeEnded(int channel, uint32_t nowMs) {
+    if (channel < 0 || channel >= numChannels || !channels[channel].fading) return;
+    channels[channel].fading = false;
+    advance(channel, nowMs);
+}
+
+uint32_t PwmFadeSequencer::poll(uint32_t nowMs) {
+    uint32_t nextMs = UINT32_MAX;
+    for (int i = 0; i < numChannels; i++) {
+        advance(i, nowMs);
+        const Channel& ch = channels[i];
+        if (ch.waiting) {
+            uint32_t remaining = ch.waitUntilMs - nowMs;
+            if (remaining < nextMs) { nextMs = remaining; }
+        }
+    }
+    return nextMs;
+}
+
+void PwmFadeSequencer::reset(int channel, uint8_t duty) {
+    if (channel < 0 || channel >= numChannels) return;
+    channels[channel] = Channel();
+    channels[channel].duty = duty;
+}
+
+// Move a channel on if it is free: a pending program starts at once (cutting a
+// hold short), otherwise the current one continues once its wait is over
+void PwmFadeSequencer::advance(int channel, uint32_t nowMs) {
+    Channel& ch = channels[channel];
+    if (ch.fading) return;
+    if (ch.waiting && !ch.hasPending && (int32_t)(nowMs - ch.waitUntilMs) < 0) return;
+    ch.waiting = false;
+
+    if (ch.hasPending) {
+        ch.program = ch.pending;
+        ch.hasProgram = true;
+        ch.hasPending = false;
+        ch.done = false;
+        ch.leg = 0;
+        startLeg(channel, ch);
+    } else if (ch.done) {
+        return;
+    }
+    continueProgram(channel, ch, nowMs);
+}
+
+// Begin a leg; a jump (no fade time) is written right away, and only if the duty changes
+void PwmFadeSequencer::startLeg(int channel, Channel& ch) {
+    const PwmLeg& leg = ch.program.legs[ch.leg];
+    ch.legRemainingMs = leg.fadeMs;
+    ch.legHoldMs = leg.holdMs;
+    if (leg.fadeMs == 0 && leg.duty != ch.duty) {
+        backend.setDuty(channel, leg.duty, backend.context);
+        ch.duty = leg.duty;
+        sequencerStats.dutySets++;
+    }
+}
+
+// Issue the next fade segment or wait; legs longer than PWM_FADE_MAX_SEGMENT_MS are
+// split into proportional segments so the overall ramp stays linear
+void PwmFadeSequencer::continueProgram(int channel, Channel& ch, uint32_t nowMs) {
+    for (;;) {
+        if (ch.legRemainingMs > 0) {
+            uint8_t target = ch.program.legs[ch.leg].duty;
+            uint32_t segmentMs = ch.legRemainingMs > PWM_FADE_MAX_SEGMENT_MS ? PWM_FADE_MAX_SEGMENT_MS : ch.legRemainingMs;
+            int32_t delta = (int32_t)target - ch.duty;
+            uint8_t segmentDuty = (uint8_t)(ch.duty + delta * (int32_t)segmentMs / (int32_t)ch.legRemainingMs);
+            ch.legRemainingMs -= segmentMs;
+            if (segmentDuty == ch.duty) {
+                // Nothing to fade in this stretch: let the time pass without a command
+                ch.waiting = true;
+                ch.waitUntilMs = nowMs + segmentMs;
+            } else {
+                backend.startFade(channel, segmentDuty, segmentMs, backend.context);
+                ch.duty = segmentDuty;
+                ch.fading = true;
+                sequencerStats.fades++;
+            }
+            return;
+        }
+        if (ch.legHoldMs > 0) {
+            ch.waiting = true;
+            ch.waitUntilMs = nowMs + ch.legHoldMs;
+            ch.legHoldMs = 0;
+            return;
+        }
+        // Leg complete
+        if (++ch.leg >= ch.program.numLegs) {
+            if (!ch.program.repeat) {
+                ch.done = true;
+                return;
+            }
+            ch.leg = 0;
+        }
+        startLeg(channel, ch);
+    }
+}
@@ -0,0 +1,164 @@
+#include <Arduino.h>
+#include <driver/ledc.h>
+#include "pwm_leds.h"
+
+// Notification bits: one per channel for fade ends, one for new requests/pause changes
+const uint32_t requestBit = 1UL << 31;
+
+const uint32_t fadeTaskStackSize = 2048;
+const UBaseType_t fadeTaskPriority = 2; // Short bursts; above the display flush so effects stay smooth
+const BaseType_t fadeTaskCore = 0;
+const uint32_t pauseTimeoutMs = PWM_FADE_MAX_SEGMENT_MS + 50; // A running segment always ends within this
+
+struct PendingRequest {
+    PwmProgram program;
+    bool valid = false;
+};
+
+static int numPwmLeds = 0;
+static int ledcChannelOf[pwmFadeMaxChannels];
+static PendingRequest pendingRequests[pwmFadeMaxChannels]; // Posted by callers, taken by the task
+static volatile bool pauseRequested = false;
+static volatile bool resyncRequested = false;
+static volatile bool taskParked = false;
+static volatile uint32_t fadingMask = 0; // Channels with a hardware fade running
+static portMUX_TYPE requestLock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t fadeTaskHandle = nullptr;
+static PwmFadeSequencer* sequencer = nullptr;
+static PwmLedStats ledStats;
+
+// Arduino LEDC channels 0-7 are the high speed group, 8-15 the low speed group
+static ledc_mode_t speedModeOf(int index) {
+    return (ledc_mode_t)(ledcChannelOf[index] / 8);
+}
+
+static ledc_channel_t hwChannelOf(int index) {
+    return (ledc_channel_t)(ledcChannelOf[index] % 8);
+}
+
+// --- Sequencer Backend ---
+static void backendSetDuty(int index, uint8_t duty, void*) {
+    ledc_set_duty(speedModeOf(index), hwChannelOf(index), duty);
+    ledc_update_duty(speedModeOf(index), hwChannelOf(index));
+}
+
+static void backendStartFade(int index, uint8_t duty, uint32_t fadeMs, void*) {
+    portENTER_CRITICAL(&requestLock);
+    fadingMask |= 1UL << index;
+    portEXIT_CRITICAL(&requestLock);
+    ledc_set_fade_with_time(speedModeOf(index), hwChannelOf(index), duty, fadeMs);
+    ledc_fade_start(speedModeOf(index), hwChannelOf(index), LEDC_FADE_NO_WAIT);
+}
+// --- End Sequencer Backend ---
+
+// Runs in the LEDC interrupt when a channel's fade is done
+static bool IRAM_ATTR fadeEndFromISR(const ledc_cb_param_t* param, void* userArg) {
+    if (param->event != LEDC_FADE_END_EVT) return false;
+    uint32_t index = (uint32_t)(uintptr_t)userArg;
+    portENTER_CRITICAL_ISR(&requestLock);
+    fadingMask &= ~(1UL << index);
+    portEXIT_CRITICAL_ISR(&requestLock);
+    ledStats.fadeEndEvents++;
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    xTaskNotifyFromISR(fadeTaskHandle, 1UL << index, eSetBits, &higherPriorityTaskWoken);
+    return higherPriorityTaskWoken == pdTRUE;
+}
+
+static void fadeTask(void* param) {
+    TickType_t waitTicks = portMAX_DELAY;
+    for (;;) {
+        uint32_t bits = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &bits, waitTicks);
+        ledStats.wakeups++;
+
+        if (pauseRequested) {
+            taskParked = true; // Someone else is driving the channels; send nothing
+            waitTicks = portMAX_DELAY;
+            continue;
+        }
+        uint32_t nowMs = millis();
+        if (taskParked || resyncRequested) {
+            // Take over from whatever the hardware was left at
+            for (int i = 0; i < numPwmLeds; i++) {
+                sequencer->reset(i, (uint8_t)ledc_get_duty(speedModeOf(i), hwChannelOf(i)));
+            }
+            taskParked = false;
+            resyncRequested = false;
+        }
+
+        for (int i = 0; i < numPwmLeds; i++) {
+            if (bits & (1UL << i)) { sequencer->fadeEnded(i, nowMs); }
+        }
+        for (int i = 0; i < numPwmLeds; i++) {
+            portENTER_CRITICAL(&requestLock);
+            bool haveRequest = pendingRequests[i].valid;
+            PwmProgram program = pendingRequests[i].program;
+            pendingRequests[i].valid = false;
+            portEXIT_CRITICAL(&requestLock);
+            if (haveRequest) { sequencer->request(i, program, nowMs); }
+        }
+
+        uint32_t nextMs = sequencer->poll(nowMs);
+        waitTicks = nextMs == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(nextMs);
+    }
+}
+
+void pwmLedsBegin(const int* ledcChannels, int numLeds) {
+    numPwmLeds = numLeds > pwmFadeMaxChannels ? pwmFadeMaxChannels : numLeds;
+    for (int i = 0; i < numPwmLeds; i++) { ledcChannelOf[i] = ledcChannels[i]; }
+    static PwmFadeSequencer fadeSequencer(numPwmLeds, PwmFadeBackend{backendSetDuty, backendStartFade, nullptr});
+    sequencer = &fadeSequencer;
+    resyncRequested = true;
+
+    xTaskCreatePinnedToCore(fadeTask, "pwmFade", fadeTaskStackSize, nullptr,
+                            fadeTaskPriority, &fadeTaskHandle, fadeTaskCore);
+
+    ledc_fade_func_install(0);
+    ledc_cbs_t callbacks = {.fade_cb = fadeEndFromISR};
+    for (int i = 0; i < numPwmLeds; i++) {
+        ledc_cb_register(speedModeOf(i), hwChannelOf(i), &callbacks, (void*)(uintptr_t)i);
+    }
+    xTaskNotify(fadeTaskHandle, requestBit, eSetBits);
+}
+
+// Hand a program to the fade task; a newer request for the same LED replaces an unhandled one
+static void postRequest(int index, const PwmProgram& program) {
+    if (fadeTaskHandle == nullptr || index < 0 || index >= numPwmLeds) return;
+    portENTER_CRITICAL(&requestLock);
+    pendingRequests[index].program = program;
+    pendingRequests[index].valid = true;
+    portEXIT_CRITICAL(&requestLock);
+    xTaskNotify(fadeTaskHandle, requestBit, eSetBits);
+}
+
+void pwmLedsFadeTo(int index, uint8_t duty, uint32_t fadeMs) {
+    postRequest(index, pwmFadeProgram(duty, fadeMs));
+}
+
+void pwmLedsPlay(int index, PwmEffect effect, uint8_t brightness) {
+    postRequest(index, pwmEffectProgram(effect, brightness));
+}
+
+bool pwmLedsPause() {
+    if (fadeTaskHandle == nullptr) return true;
+    pauseRequested = true;
+    xTaskNotify(fadeTaskHandle, requestBit, eSetBits);
+    uint32_t startMs = millis();
+    while (!taskParked || fadingMask != 0) {
+        if (millis() - startMs > pauseTimeoutMs) return false;
+        delay(1);
+    }
+    return true;
+}
+
+void pwmLedsResume() {
+    if (fadeTaskHandle == nullptr) return;
+    pauseRequested = false;
+    xTaskNotify(fadeTaskHandle, requestBit, eSetBits);
+}
+
+PwmLedStats pwmLedsStats() {
+    PwmLedStats stats = ledStats;
+    if (sequencer != nullptr) { stats.sequencer = sequencer->stats(); }
+    return stats;
+}
@@ -0,0 +1,68 @@
+#include "rgbw.h"
+
+static CRGB whitePoint;
+static uint8_t toWhite[3][256];    // Channel value -> W level that would produce it
+static uint8_t whiteShare[3][256]; // W level -> channel value it produces
+static bool tablesReady = false;
+
+void rgbwSetWhitePoint(CRGB wp) {
+    uint8_t peak = wp.r > wp.g ? wp.r : wp.g;
+    if (wp.b > peak) peak = wp.b;
+    if (peak == 0) { wp = CRGB(255, 255, 255); peak = 255; }
+    for (int c = 0; c < 3; c++) {
+        whitePoint[c] = (uint8_t)((wp[c] * 255 + peak / 2) / peak);
+    }
+
+    for (int c = 0; c < 3; c++) {
+        uint32_t share = whitePoint[c];
+        for (int v = 0; v < 256; v++) {
+            // Rounding down on both sides keeps whiteShare[toWhite[v]] <= v, so subtraction can't wrap
+            uint32_t w = share > 0 ? (uint32_t)v * 255 / share : 255;
+            toWhite[c][v] = (uint8_t)(w > 255 ? 255 : w);
+            whiteShare[c][v] = (uint8_t)(v * share / 255);
+        }
+    }
+    tablesReady = true;
+}
+
+CRGB rgbwWhitePoint() {
+    if (!tablesReady) rgbwSetWhitePoint(CRGB(RGBW_WHITE_POINT));
+    return whitePoint;
+}
+
+void rgbwConvert(const CRGB* src, uint8_t* dst, int n) {
+    if (!tablesReady) rgbwSetWhitePoint(CRGB(RGBW_WHITE_POINT));
+
+    for (int i = 0; i < n; i++) {
+        uint8_t r = src[i].r, g = src[i].g, b = src[i].b;
+        uint8_t w = toWhite[0][r];
+        uint8_t wg = toWhite[1][g];
+        uint8_t wb = toWhite[2][b];
+        if (wg < w) w = wg;
+        if (wb < w) w = wb;
+        dst[0] = g - whiteShare[1][w];
+        dst[1] = r - whiteShare[0][w];
+        dst[2] = b - whiteShare[2][w];
+        dst[3] = w;
+        dst += rgbwBytesPerPixel;
+    }
+}
+
+void rgbwExtract(const CRGB& in, uint8_t out[4]) {
+    uint8_t grbw[rgbwBytesPerPixel];
+    rgbwConvert(&in, grbw, 1);
+    out[0] = grbw[1];
+    out[1] = grbw[0];
+    out[2] = grbw[2];
+    out[3] = grbw[3];
+}
+
+CRGB rgbwWhiteColor(uint8_t level) {
+    CRGB wp = rgbwWhitePoint();
+    CRGB color;
+    for (int c = 0; c < 3; c++) {
+        // Round up so every channel maps back to at least this level; the peak channel is exact
+        color[c] = (uint8_t)((level * wp[c] + 254) / 255);
+    }
+    return color;
+}
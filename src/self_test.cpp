@@ -0,0 +1,153 @@
+#include <Arduino.h>
+#include <Wire.h>
+#include "self_test.h"
+#include "led_output.h"
+#include "board.h"
+
+// Expected I2C devices on the controller PCB
+struct ExpectedI2cDevice {
+    uint8_t address;
+    const char* name;
+    bool fitted; // Part of this board's profile
+};
+static const ExpectedI2cDevice expectedI2cDevices[] = {
+    {0x23, "BH1750", Board::hasLightSensor},
+    {0x40, "INA219", Board::hasCurrentSensor},
+    {0x3C, "SSD1306", Board::hasDisplay},
+};
+
+// Plausibility ranges
+const float minLux = 0.0, maxLux = 65535.0;          // BH1750 full scale
+const float minBusVoltage = 3.0, maxBusVoltage = 5.6; // USB or 5V LED supply
+const float minIdleCurrentMa = -50.0, maxIdleCurrentMa = 2000.0;
+
+// RGB strip check: light a few pixels and expect the supply current to rise
+const int stripTestLeds = 10;
+const uint8_t stripTestBrightness = 128;
+const float minStripDeltaMa = 30.0;
+const unsigned long stripSettleMs = 50;
+const int currentSamples = 8;
+
+const unsigned long pwmSweepStepMs = 2;
+
+struct StepResult {
+    bool pass;
+    char detail[96];
+};
+
+static float averageCurrentMa(const SelfTestContext& ctx) {
+    float sum = 0;
+    for (int i = 0; i < currentSamples; i++) {
+        sum += ctx.readCurrentMa(); // Each reading waits for its own conversion
+    }
+    return sum / currentSamples;
+}
+
+static void stepI2cScan(const SelfTestContext& ctx, StepResult& result) {
+    result.pass = true;
+    int len = 0;
+    for (const ExpectedI2cDevice& device : expectedI2cDevices) {
+        if (!device.fitted) continue;
+        Wire.beginTransmission(device.address);
+        bool found = Wire.endTransmission() == 0;
+        result.pass = result.pass && found;
+        len += snprintf(result.detail + len, sizeof(result.detail) - len, "%s0x%02X:%s",
+                        len > 0 ? "," : "", device.address, found ? "ok" : "missing");
+    }
+}
+
+static void stepLightSensor(const SelfTestContext& ctx, StepResult& result) {
+    float lux = ctx.lightMeter.readLightLevel();
+    result.pass = lux >= minLux && lux <= maxLux;
+    snprintf(result.detail, sizeof(result.detail), "lux=%.1f", lux);
+}
+
+static void stepCurrentSensor(const SelfTestContext& ctx, StepResult& result) {
+    float currentMa = ctx.readCurrentMa();
+    float busVoltage = ctx.ina219.last().busMv / 1000.0f; // Same conversion as the current
+    result.pass = busVoltage >= minBusVoltage && busVoltage <= maxBusVoltage &&
+                  currentMa >= minIdleCurrentMa && currentMa <= maxIdleCurrentMa;
+    snprintf(result.detail, sizeof(result.detail), "bus_v=%.2f current_ma=%.1f", busVoltage, currentMa);
+}
+
+static void stepPwmSweep(const SelfTestContext& ctx, StepResult& result) {
+    if (!ctx.pwmChannelsFree) { // A fade still owns the channels; writing them would fight it
+        result.pass = false;
+        snprintf(result.detail, sizeof(result.detail), "channels=%d fade_task_busy", ctx.numPwmChannels);
+        return;
+    }
+    // No feedback path for the PWM LEDs; the sweep is for the operator's eye
+    for (int c = 0; c < ctx.numPwmChannels; c++) {
+        for (int duty = 0; duty <= 255; duty += 5) { ledcWrite(ctx.pwmChannels[c], duty); delay(pwmSweepStepMs); }
+        for (int duty = 255; duty >= 0; duty -= 5) { ledcWrite(ctx.pwmChannels[c], duty); delay(pwmSweepStepMs); }
+    }
+    result.pass = true;
+    snprintf(result.detail, sizeof(result.detail), "channels=%d visual", ctx.numPwmChannels);
+}
+
+static void stepRgbStrip(const SelfTestContext& ctx, StepResult& result) {
+    int litLeds = min(stripTestLeds, ctx.numLeds);
+
+    ledOutputClear();
+    ledOutputFlush();
+    delay(stripSettleMs);
+    float baselineMa = averageCurrentMa(ctx);
+
+    CRGB* frame = ledOutputBeginFrame();
+    fill_solid(frame, MAX_LEDS, CRGB::Black);
+    fill_solid(frame, litLeds, CRGB::White);
+    ledOutputPresent(stripTestBrightness);
+    ledOutputFlush();
+    delay(stripSettleMs);
+    float litMa = averageCurrentMa(ctx);
+
+    ledOutputClear();
+    ledOutputFlush();
+
+    float deltaMa = litMa - baselineMa;
+    result.pass = deltaMa >= minStripDeltaMa;
+    snprintf(result.detail, sizeof(result.detail), "leds=%d baseline_ma=%.1f lit_ma=%.1f delta_ma=%.1f",
+             litLeds, baselineMa, litMa, deltaMa);
+}
+
+static void stepChipInfo(const SelfTestContext& ctx, StepResult& result) {
+    uint32_t flashMb = ESP.getFlashChipSize() / (1024 * 1024);
+    uint32_t cpuMhz = ESP.getCpuFreqMHz();
+    result.pass = flashMb > 0 && cpuMhz > 0;
+    snprintf(result.detail, sizeof(result.detail), "rev=%d cpu_mhz=%lu flash_mb=%lu",
+             ESP.getChipRevision(), (unsigned long)cpuMhz, (unsigned long)flashMb);
+}
+
+struct SelfTestStep {
+    const char* name;
+    void (*run)(const SelfTestContext& ctx, StepResult& result); // nullptr: hardware not on this board
+};
+// Steps for absent hardware are resolved to nullptr at compile time, so their code is not linked
+static const SelfTestStep selfTestSteps[] = {
+    {"i2c_scan", stepI2cScan},
+    {"bh1750", Board::hasLightSensor ? stepLightSensor : nullptr},
+    {"ina219", Board::hasCurrentSensor ? stepCurrentSensor : nullptr},
+    {"pwm_sweep", Board::hasPwmLeds ? stepPwmSweep : nullptr},
+    {"rgb_strip", Board::hasCurrentSensor ? stepRgbStrip : nullptr}, // Judged by the supply current
+    {"chip_info", stepChipInfo},
+};
+
+bool runSelfTest(const SelfTestContext& ctx) {
+    unsigned long testStart = millis();
+    int passed = 0, failed = 0;
+
+    Serial.printf("SELFTEST BEGIN mac=%04X%08X\n", (uint16_t)(ESP.getEfuseMac() >> 32), (uint32_t)ESP.getEfuseMac());
+    for (const SelfTestStep& step : selfTestSteps) {
+        if (step.run == nullptr) continue;
+        StepResult result = {false, ""};
+        unsigned long stepStart = millis();
+        step.run(ctx, result);
+        unsigned long stepMs = millis() - stepStart;
+        if (result.pass) { passed++; } else { failed++; }
+        Serial.printf("SELFTEST STEP name=%s result=%s ms=%lu %s\n",
+                      step.name, result.pass ? "PASS" : "FAIL", stepMs, result.detail);
+    }
+    Serial.printf("SELFTEST END result=%s passed=%d failed=%d ms=%lu\n",
+                  failed == 0 ? "PASS" : "FAIL", passed, failed, millis() - testStart);
+    return failed == 0;
+}
@@ -0,0 +1,246 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <atomic>
+#include "soak_log.h"
+#include "log.h"
+
+const unsigned long consoleBaud = 115200;
+const int batchBytes = soakRecordsPerBatch * soakRecordSize;
+
+static uint8_t batches[2][batchBytes];
+static int fillBatch = 0;                   // Batch the loop appends to
+static int fillCount = 0;
+static std::atomic<int> pendingBatch(-1);   // Batch handed to the writer, -1 if none
+static std::atomic<bool> enabledFlag(false);
+static std::atomic<bool> readyFlag(false);
+static bool mounted = false;                // Writer task only
+static uint32_t nextSlot = 0;               // Writer task only: ring slot for the next batch
+static uint32_t nextSequence = 0;           // Set by the writer before ready, then owned by the loop
+static SemaphoreHandle_t fsLock = nullptr;  // Held while the ring files are in use
+static TaskHandle_t writerTaskHandle = nullptr;
+static SoakLogStats stats;
+
+const uint32_t writerTaskStackSize = 4096;
+const UBaseType_t writerTaskPriority = 1; // Below the LED output task
+const BaseType_t writerTaskCore = 0;
+
+static void segmentPath(char* out, size_t size, int segment) {
+    snprintf(out, size, "/soak/%03d.bin", segment);
+}
+
+// Mount, preallocate any missing segment and find where the ring left off
+static bool prepareRing() {
+    if (!LittleFS.begin(true)) { // Formats a partition that has never held LittleFS
+        LOG_ERROR("Soak log: LittleFS mount failed");
+        return false;
+    }
+    LittleFS.mkdir("/soak");
+
+    uint8_t* firstRecords = (uint8_t*)malloc(SOAK_LOG_SEGMENTS * soakRecordSize);
+    uint8_t* block = (uint8_t*)malloc(SOAK_LOG_SEGMENT_BYTES);
+    if (firstRecords == nullptr || block == nullptr) {
+        free(firstRecords);
+        free(block);
+        LOG_ERROR("Soak log: out of memory");
+        return false;
+    }
+    int created = 0;
+    bool ok = true;
+    char path[24];
+    for (int s = 0; s < SOAK_LOG_SEGMENTS && ok; s++) {
+        segmentPath(path, sizeof(path), s);
+        File file = LittleFS.open(path, "r");
+        if (file && file.size() == SOAK_LOG_SEGMENT_BYTES) {
+            ok = file.read(firstRecords + s * soakRecordSize, soakRecordSize) == soakRecordSize;
+            file.close();
+            continue;
+        }
+        if (file) { file.close(); }
+        memset(block, 0xFF, SOAK_LOG_SEGMENT_BYTES); // Empty slots
+        file = LittleFS.open(path, "w");
+        ok = file && file.write(block, SOAK_LOG_SEGMENT_BYTES) == SOAK_LOG_SEGMENT_BYTES;
+        if (file) { file.close(); }
+        memset(firstRecords + s * soakRecordSize, 0xFF, soakRecordSize);
+        created++;
+    }
+
+    SoakResume resume = {0, 0};
+    int newest = ok ? soakLogNewestSegment(firstRecords, SOAK_LOG_SEGMENTS) : -1;
+    if (newest >= 0) {
+        segmentPath(path, sizeof(path), newest);
+        File file = LittleFS.open(path, "r");
+        ok = file && file.read(block, SOAK_LOG_SEGMENT_BYTES) == SOAK_LOG_SEGMENT_BYTES;
+        if (file) { file.close(); }
+        if (ok) { resume = soakLogResume(newest, block); }
+    }
+    free(firstRecords);
+    free(block);
+    if (!ok) {
+        LOG_ERROR("Soak log: can't preallocate %d segments", SOAK_LOG_SEGMENTS);
+        return false;
+    }
+
+    nextSlot = resume.slot;
+    nextSequence = resume.sequence;
+    LOG_INFO("Soak log ready: %d segments (%d created), %lu KB free, next record %lu",
+             SOAK_LOG_SEGMENTS, created, (unsigned long)((LittleFS.totalBytes() - LittleFS.usedBytes()) / 1024),
+             (unsigned long)nextSequence);
+    return true;
+}
+
+static void writeBatch(const uint8_t* batch) {
+    uint32_t startUs = micros();
+    char path[24];
+    segmentPath(path, sizeof(path), nextSlot / soakRecordsPerSegment);
+    File file = LittleFS.open(path, "r+");
+    bool ok = file && file.seek((nextSlot % soakRecordsPerSegment) * soakRecordSize) &&
+              file.write(batch, batchBytes) == (size_t)batchBytes;
+    if (file) { file.close(); } // Commits the block copy and the metadata
+    uint32_t elapsedUs = micros() - startUs;
+
+    nextSlot = (nextSlot + soakRecordsPerBatch) % soakRingSlots; // A failed batch gives up its slots
+    if (!ok) {
+        stats.writeErrors++;
+        LOG_ERROR("Soak log: write to %s failed", path);
+        return;
+    }
+    stats.batches++;
+    stats.flushUsTotal += elapsedUs;
+    if (elapsedUs > stats.flushUsMax) { stats.flushUsMax = elapsedUs; }
+}
+
+static void writerTask(void* param) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        xSemaphoreTake(fsLock, portMAX_DELAY);
+        if (enabledFlag && !mounted) {
+            mounted = prepareRing();
+            readyFlag = mounted;
+        }
+        int batch = pendingBatch;
+        if (batch >= 0) {
+            if (mounted) { writeBatch(batches[batch]); }
+            pendingBatch = -1;
+        }
+        xSemaphoreGive(fsLock);
+    }
+}
+
+void soakLogBegin(bool enabled) {
+    fsLock = xSemaphoreCreateMutex();
+    xTaskCreatePinnedToCore(writerTask, "soakLog", writerTaskStackSize, nullptr,
+                            writerTaskPriority, &writerTaskHandle, writerTaskCore);
+    soakLogSetEnabled(enabled);
+}
+
+void soakLogSetEnabled(bool enabled) {
+    if (writerTaskHandle == nullptr) return;
+    if (!enabled) { soakLogFlush(); } // Keep what was sampled so far
+    enabledFlag = enabled;
+    if (enabled) { xTaskNotifyGive(writerTaskHandle); } // Mounts on first use
+}
+
+bool soakLogEnabled() {
+    return enabledFlag;
+}
+
+bool soakLogReady() {
+    return enabledFlag && readyFlag;
+}
+
+// Give the fill batch to the writer, padded with empty slots; false if the writer still has the other one
+static bool handOver() {
+    if (pendingBatch >= 0) return false;
+    memset(batches[fillBatch] + fillCount * soakRecordSize, 0xFF, (soakRecordsPerBatch - fillCount) * soakRecordSize);
+    pendingBatch = fillBatch;
+    xTaskNotifyGive(writerTaskHandle);
+    fillBatch ^= 1;
+    fillCount = 0;
+    return true;
+}
+
+void soakLogAppend(SoakRecord& record, uint32_t sampleUs) {
+    if (!soakLogReady()) return;
+    uint32_t startUs = micros();
+    record.sequence = nextSequence++;
+    soakRecordEncode(record, batches[fillBatch] + fillCount * soakRecordSize);
+    fillCount++;
+    stats.appended++;
+    if (fillCount == soakRecordsPerBatch && !handOver()) {
+        stats.dropped += fillCount; // Flash is slower than one batch per batch interval
+        fillCount = 0;
+    }
+    uint32_t elapsedUs = sampleUs + (micros() - startUs);
+    stats.appendUsTotal += elapsedUs;
+    if (elapsedUs > stats.appendUsMax) { stats.appendUsMax = elapsedUs; }
+}
+
+void soakLogFlush() {
+    if (fillCount == 0 || !readyFlag) return;
+    while (pendingBatch >= 0) { delay(1); } // At most one batch write
+    handOver();
+}
+
+void soakLogDump() {
+    if (writerTaskHandle == nullptr || !readyFlag) {
+        Serial.println("SOAK DUMP BEGIN records=0");
+        Serial.println("SOAK DUMP END records=0 crc32=00000000");
+        return;
+    }
+    soakLogFlush();
+    while (pendingBatch >= 0) { delay(1); }
+    xSemaphoreTake(fsLock, portMAX_DELAY);
+
+    logFlush(); // Keep queued log lines ahead of the switch
+    Serial.printf("SOAK DUMP BEGIN baud=%lu slots=%lu record_bytes=%d\n",
+                  (unsigned long)(SOAK_LOG_DUMP_BAUD > 0 ? SOAK_LOG_DUMP_BAUD : consoleBaud),
+                  (unsigned long)soakRingSlots, soakRecordSize);
+    Serial.flush();
+    if (SOAK_LOG_DUMP_BAUD > 0) { Serial.updateBaudRate(SOAK_LOG_DUMP_BAUD); }
+    delay(10); // Time for the host to follow
+
+    // Oldest first: from the next slot to write once around the ring
+    SoakDumpWriter dump([](const char* line, void*) { Serial.println(line); }, nullptr);
+    uint8_t chunk[soakDumpRecordsPerLine * soakRecordSize];
+    File file;
+    int openSegment = -1;
+    for (uint32_t n = 0; n < soakRingSlots; n += soakDumpRecordsPerLine) {
+        uint32_t slot = (nextSlot + n) % soakRingSlots;
+        int segment = slot / soakRecordsPerSegment;
+        if (segment != openSegment || slot % soakRecordsPerSegment == 0) { // Also the wrap in a one-segment ring
+            if (file) { file.close(); }
+            char path[24];
+            segmentPath(path, sizeof(path), segment);
+            file = LittleFS.open(path, "r");
+            if (file) { file.seek((slot % soakRecordsPerSegment) * soakRecordSize); }
+            openSegment = segment;
+        }
+        if (file && file.read(chunk, sizeof(chunk)) == sizeof(chunk)) { dump.addSlots(chunk, soakDumpRecordsPerLine); }
+    }
+    if (file) { file.close(); }
+    dump.finish();
+    Serial.flush();
+    if (SOAK_LOG_DUMP_BAUD > 0) { Serial.updateBaudRate(consoleBaud); }
+    xSemaphoreGive(fsLock);
+}
+
+SoakLogStats soakLogStats() {
+    return stats;
+}
+
+void soakLogPrintStats() {
+    SoakLogStats s = stats;
+    uint32_t appendUsAvg = s.appended > 0 ? (uint32_t)(s.appendUsTotal / s.appended) : 0;
+    uint32_t flushUsAvg = s.batches > 0 ? (uint32_t)(s.flushUsTotal / s.batches) : 0;
+    uint32_t amplificationX100 = soakLogFlashBytesPerBatch() * 100 / batchBytes;
+    uint32_t partitionBytes = readyFlag ? (uint32_t)LittleFS.totalBytes() : 0;
+    Serial.printf("SOAK STATS enabled=%d ready=%d records=%lu dropped=%lu batches=%lu write_errors=%lu "
+                  "append_us_avg=%lu append_us_max=%lu flush_us_avg=%lu flush_us_max=%lu "
+                  "flash_bytes=%llu write_amplification=%lu.%02lu lifetime_days=%lu\n",
+                  enabledFlag ? 1 : 0, readyFlag ? 1 : 0, (unsigned long)s.appended, (unsigned long)s.dropped,
+                  (unsigned long)s.batches, (unsigned long)s.writeErrors, (unsigned long)appendUsAvg,
+                  (unsigned long)s.appendUsMax, (unsigned long)flushUsAvg, (unsigned long)s.flushUsMax,
+                  (unsigned long long)s.batches * soakLogFlashBytesPerBatch(), (unsigned long)(amplificationX100 / 100),
+                  (unsigned long)(amplificationX100 % 100),
+                  (unsigned long)(partitionBytes > 0 ? soakLogFlashLifetimeDays(partitionBytes, SOAK_LOG_INTERVAL_MS) : 0));
+}
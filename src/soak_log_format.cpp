@@ -0,0 +1,148 @@
+#include "soak_log.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// LittleFS on the ESP32: commits are padded to whole 256-byte pages, blocks are rated for 100k erases
+const uint32_t soakMetadataCommitBytes = 256;
+const uint32_t flashEraseCycles = 100000;
+
+static void putLe(uint8_t* out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) { out[i] = (uint8_t)(value >> (8 * i)); }
+}
+
+static uint32_t getLe(const uint8_t* in, int bytes) {
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; i++) { value |= (uint32_t)in[i] << (8 * i); }
+    return value;
+}
+
+void soakRecordEncode(const SoakRecord& record, uint8_t* out) {
+    putLe(out, record.sequence, 4);
+    putLe(out + 4, record.timeMs, 4);
+    putLe(out + 8, record.busMv, 2);
+    putLe(out + 10, (uint16_t)record.currentMa, 2);
+    putLe(out + 12, record.lux, 2);
+    out[14] = record.pattern;
+    out[15] = record.brightness;
+}
+
+bool soakRecordDecode(const uint8_t* in, SoakRecord& record) {
+    record.sequence = getLe(in, 4);
+    if (record.sequence == soakEmptySequence) return false;
+    record.timeMs = getLe(in + 4, 4);
+    record.busMv = (uint16_t)getLe(in + 8, 2);
+    record.currentMa = (int16_t)getLe(in + 10, 2);
+    record.lux = (uint16_t)getLe(in + 12, 2);
+    record.pattern = in[14];
+    record.brightness = in[15];
+    return true;
+}
+
+int soakLogNewestSegment(const uint8_t* firstRecords, int segments) {
+    int newest = -1;
+    uint32_t newestSequence = 0;
+    for (int s = 0; s < segments; s++) {
+        SoakRecord record;
+        if (!soakRecordDecode(firstRecords + s * soakRecordSize, record)) continue;
+        if (newest < 0 || record.sequence > newestSequence) {
+            newest = s;
+            newestSequence = record.sequence;
+        }
+    }
+    return newest;
+}
+
+SoakResume soakLogResume(int newestSegment, const uint8_t* segmentData) {
+    if (newestSegment < 0) return {0, 0}; // Fresh ring
+    // Batches are written whole, padded with empty slots, so the last record ends the last batch
+    int last = -1;
+    uint32_t lastSequence = 0;
+    for (int i = 0; i < soakRecordsPerSegment; i++) {
+        SoakRecord record;
+        if (soakRecordDecode(segmentData + i * soakRecordSize, record)) {
+            last = i;
+            lastSequence = record.sequence;
+        }
+    }
+    int nextIndex = (last / soakRecordsPerBatch + 1) * soakRecordsPerBatch;
+    uint32_t slot = (uint32_t)newestSegment * soakRecordsPerSegment + nextIndex;
+    return {slot % soakRingSlots, lastSequence + 1};
+}
+
+void soakDumpFormatLine(char* out, size_t size, const uint8_t* records, int count) {
+    static const char hexDigits[] = "0123456789abcdef";
+    size_t length = snprintf(out, size, "SOAK DATA ");
+    for (int i = 0; i < count * soakRecordSize && length + 2 < size; i++) {
+        out[length++] = hexDigits[records[i] >> 4];
+        out[length++] = hexDigits[records[i] & 0x0f];
+    }
+    if (length < size) out[length] = '\0';
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+int soakDumpParseLine(const char* line, uint8_t* records, int maxRecords) {
+    static const char prefix[] = "SOAK DATA ";
+    if (strncmp(line, prefix, sizeof(prefix) - 1) != 0) return -1;
+    const char* hex = line + sizeof(prefix) - 1;
+    size_t digits = 0;
+    while (hexValue(hex[digits]) >= 0) digits++;
+    if (digits % (2 * soakRecordSize) != 0 || digits / (2 * soakRecordSize) > (size_t)maxRecords) return -1;
+    for (size_t i = 0; i < digits / 2; i++) {
+        records[i] = (uint8_t)(hexValue(hex[2 * i]) << 4 | hexValue(hex[2 * i + 1]));
+    }
+    return (int)(digits / (2 * soakRecordSize));
+}
+
+// CRC-32 (IEEE, reflected), bitwise: only the dump uses it
+uint32_t soakCrc32(uint32_t crc, const uint8_t* data, size_t length) {
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) { crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1))); }
+    }
+    return ~crc;
+}
+
+void SoakDumpWriter::addSlots(const uint8_t* slots, int count) {
+    for (int i = 0; i < count; i++) {
+        SoakRecord record;
+        if (!soakRecordDecode(slots + i * soakRecordSize, record)) continue;
+        memcpy(lineRecords + lineCount * soakRecordSize, slots + i * soakRecordSize, soakRecordSize);
+        if (++lineCount == soakDumpRecordsPerLine) { emitLine(); }
+    }
+}
+
+void SoakDumpWriter::emitLine() {
+    char line[16 + sizeof(lineRecords) * 2];
+    soakDumpFormatLine(line, sizeof(line), lineRecords, lineCount);
+    sink(line, context);
+    crc = soakCrc32(crc, lineRecords, lineCount * soakRecordSize);
+    sent += lineCount;
+    lineCount = 0;
+}
+
+void SoakDumpWriter::finish() {
+    if (lineCount > 0) { emitLine(); }
+    char line[64];
+    snprintf(line, sizeof(line), "SOAK DUMP END records=%lu crc32=%08lx", (unsigned long)sent, (unsigned long)crc);
+    sink(line, context);
+}
+
+uint32_t soakLogFlashBytesPerBatch() {
+    return SOAK_LOG_SEGMENT_BYTES + soakMetadataCommitBytes;
+}
+
+uint32_t soakLogFlashLifetimeDays(uint32_t partitionBytes, uint32_t intervalMs) {
+    // Wear leveling spreads the writes over every block of the partition
+    uint64_t flashBytesPerDay = (uint64_t)86400000 / intervalMs * soakLogFlashBytesPerBatch() / soakRecordsPerBatch;
+    if (flashBytesPerDay == 0) return UINT32_MAX;
+    uint64_t days = (uint64_t)partitionBytes * flashEraseCycles / flashBytesPerDay;
+    return days > UINT32_MAX ? UINT32_MAX : (uint32_t)days;
+}
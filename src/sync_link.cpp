@@ -0,0 +1,83 @@
+#include "sync_link.h"
+#include "board.h"
+
+// The receive callback fires once the line has been idle for the RX timeout
+// after a beacon, so a beacon is seen this long after its first byte was sent
+const uint32_t syncRxLatencyUs = syncWireTimeUs(SYNC_LINK_BAUD) +
+                                 (uint32_t)(SYNC_RX_TIMEOUT_SYMBOLS * 10 * 1000000ULL / SYNC_LINK_BAUD);
+
+static SyncNode syncNode(syncRxLatencyUs);
+static TaskHandle_t syncNotifyTask = nullptr;
+static portMUX_TYPE rxLock = portMUX_INITIALIZER_UNLOCKED;
+static uint64_t lastRxUs = 0;  // When the last burst finished arriving
+static bool rxPending = false; // A burst has arrived that syncLinkService() hasn't read
+
+// Runs in the UART event task, not an ISR
+static void onSyncReceive() {
+    uint64_t nowUs = esp_timer_get_time();
+    portENTER_CRITICAL(&rxLock);
+    lastRxUs = nowUs;
+    rxPending = true;
+    portEXIT_CRITICAL(&rxLock);
+    if (syncNotifyTask != nullptr) { xTaskNotifyGive(syncNotifyTask); }
+}
+
+void syncLinkBegin(SyncRole role, TaskHandle_t loopTask) {
+    syncNotifyTask = loopTask;
+    Serial2.begin(SYNC_LINK_BAUD, SERIAL_8N1, Board::syncRxPin, Board::syncTxPin);
+    Serial2.setRxTimeout(SYNC_RX_TIMEOUT_SYMBOLS);
+    Serial2.onReceive(onSyncReceive, true); // Only on RX timeout: one call per beacon
+    syncNode.setRole(role);
+}
+
+void syncLinkSetRole(SyncRole role) {
+    syncNode.setRole(role);
+}
+
+SyncRole syncLinkRole() {
+    return syncNode.role();
+}
+
+void syncLinkService(const SyncPatternState& localState) {
+    portENTER_CRITICAL(&rxLock);
+    bool haveBurst = rxPending;
+    uint64_t rxUs = lastRxUs;
+    rxPending = false;
+    portEXIT_CRITICAL(&rxLock);
+
+    // Only read complete bursts, so the timestamp belongs to the bytes
+    if (haveBurst) {
+        uint8_t buffer[64];
+        int available;
+        while ((available = Serial2.available()) > 0) {
+            size_t length = Serial2.read(buffer, min((size_t)available, sizeof(buffer)));
+            syncNode.receive(buffer, length, rxUs);
+        }
+    }
+
+    uint8_t beacon[syncBeaconSize];
+    size_t length = syncNode.poll(esp_timer_get_time(), localState, beacon);
+    if (length > 0) { Serial2.write(beacon, length); }
+}
+
+unsigned long syncLinkMsUntilDue(unsigned long maxMs) {
+    uint64_t dueUs = syncNode.usUntilDue(esp_timer_get_time());
+    if (dueUs == UINT64_MAX) return maxMs;
+    unsigned long dueMs = (unsigned long)((dueUs + 999) / 1000);
+    return dueMs < maxMs ? dueMs : maxMs;
+}
+
+uint32_t syncLinkClockMs() {
+    return (uint32_t)(syncNode.sharedTimeUs(esp_timer_get_time()) / 1000);
+}
+
+bool syncLinkLeaderState(SyncPatternState& state) {
+    return syncNode.leaderState(state);
+}
+
+void syncLinkStats(SyncNodeStats& node, SyncClockStats& clock, bool& following) {
+    node = syncNode.stats();
+    clock = syncNode.clock().stats();
+    following = syncNode.following();
+    syncNode.clock().clearErrorPeak();
+}
@@ -0,0 +1,28 @@
+// Host run of the kernel benchmarks (bench.h): the pattern, brightness and
+// RGBW kernels from src/bench.cpp, built with FastLED's stub platform and
+// timed by the host clock. The test fails if no buffer fits or the RGBW
+// kernel's output differs from the division reference. It prints the same
+// BENCH lines and BENCH JSON document as the 'k' command, as board "Host",
+// so the timings are checked against the Host rows of
+// scripts/bench_baseline.json with:
+//
+//   pio test -e native -v | scripts/bench_compare.py --log -
+//
+// The display formatting kernel reads the firmware's mode table and only
+// runs on a board.
+
+#include <unity.h>
+#include "bench.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void test_kernels_run_and_rgbw_matches_reference() {
+    TEST_ASSERT_TRUE(runBenchmarks(nullptr));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_kernels_run_and_rgbw_matches_reference);
+    return UNITY_END();
+}
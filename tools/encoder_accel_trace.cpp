@@ -0,0 +1,251 @@
+// Host check of the encoder acceleration (encoder_accel.h) on synthetic
+// rotation traces: timestamped count changes like the ones loop() reads from
+// ESP32Encoder. It checks:
+//   velocity  steady turning at known rates reads back at that rate, a pause
+//             reads zero and turning back starts from zero
+//   slow      slow turning moves every curve one unit per step, end to end
+//   random    random traces (bursts, pauses, several counts per loop, turning
+//             back) keep every value in range, moving the way the knob turned,
+//             and on the curve's grid when the step was coarse
+//   reach     a turning model reaches every value of every curve from a few
+//             starting points within the budget
+// The turning model spins fast, medium or slow: the fastest speed whose step
+// doesn't pass the target. The speed estimate lags a change of pace, so it can
+// overshoot and turn back, as a person would.
+// scripts/encoder_accel_traces.sh builds and runs it.
+//
+//   encoder_accel_trace [--budget-ms N] [--traces N] [--seed S]
+
+#include "encoder_accel.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <random>
+
+// Turning speeds of the model, steps per second, each inside its tier
+const float slowTurnSps = ENCODER_MEDIUM_FROM_SPS * 0.4f;
+const float mediumTurnSps = (ENCODER_MEDIUM_FROM_SPS + ENCODER_FAST_FROM_SPS) / 2.0f;
+const float fastTurnSps = ENCODER_FAST_FROM_SPS * 1.2f;
+
+struct NamedCurve {
+    const char* name;
+    EncoderCurve curve;
+    int oldStep; // Units per step before acceleration, for the comparison
+};
+
+// The firmware's curves (main.cpp); MAX_LEDS is 1000 or 300 depending on the board
+static const NamedCurve curves[] = {
+    {"led_count", {ENCODER_CURVE_DECADE, 1, 1000, 0}, 1},
+    {"led_count_300", {ENCODER_CURVE_DECADE, 1, 300, 0}, 1},
+    {"brightness", {ENCODER_CURVE_PERCEPTUAL, 0, 255, 64}, 3},
+};
+
+static int failures = 0;
+
+static void fail(const char* check, const char* format, ...) __attribute__((format(printf, 2, 3)));
+static void fail(const char* check, const char* format, ...) {
+    if (failures++ >= 20) return; // Enough to go on
+    printf("!!! %s: ", check);
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\n");
+}
+
+// --- velocity ---
+static void checkVelocity() {
+    int before = failures;
+    const float quantum = 1000.0f / ENCODER_VELOCITY_WINDOW_MS; // One step in the window
+    const float rates[] = {2, 5, 8, 12, 15, 20, 30, 50};
+    for (float rate : rates) {
+        EncoderVelocity velocity;
+        float reading = 0;
+        for (int i = 1; i <= (int)rate; i++) { reading = velocity.update((uint32_t)lroundf(i * 1000 / rate), 1); }
+        if (fabsf(reading - rate) > quantum + 0.01f) { fail("velocity", "steady %.0f steps/s reads %.1f", rate, reading); }
+        uint32_t last = (uint32_t)lroundf((int)rate * 1000 / rate);
+        if (velocity.speed(last + ENCODER_VELOCITY_WINDOW_MS) != 0) { fail("velocity", "%.0f steps/s still moving after a pause", rate); }
+        if (velocity.update(last + 1, -1) != quantum) { fail("velocity", "%.0f steps/s: turning back doesn't start from zero", rate); }
+    }
+    // Several counts in one loop pass weigh as much as the same counts one by one
+    EncoderVelocity batched;
+    if (batched.update(1000, 3) != 3 * quantum) { fail("velocity", "3 counts in one change read %.1f", batched.speed(1000)); }
+    // Across the millis() wrap
+    EncoderVelocity wrapping;
+    wrapping.update(UINT32_MAX - 20, 1);
+    if (wrapping.update(20, 1) != 2 * quantum) { fail("velocity", "steps across the millis() wrap are lost"); }
+    if (failures == before) { printf("ok velocity: %d rates, batched counts, pauses, turning back, millis() wrap\n", (int)(sizeof(rates) / sizeof(rates[0]))); }
+}
+
+// --- slow ---
+static void checkSlow(const NamedCurve& named) {
+    const EncoderCurve& curve = named.curve;
+    int before = failures;
+    EncoderVelocity velocity;
+    uint32_t timeMs = 0;
+    int value = curve.minValue;
+    int steps = 0;
+    for (int direction : {1, -1}) {
+        int end = direction > 0 ? curve.maxValue : curve.minValue;
+        while (value != end && failures == before) {
+            timeMs += (uint32_t)(1000 / slowTurnSps);
+            int next = encoderAccelApply(curve, value, direction, velocity.update(timeMs, direction));
+            if (next != value + direction) { fail("slow", "%s: %d -> %d on one slow step", named.name, value, next); }
+            value = next;
+            steps++;
+        }
+    }
+    if (failures == before) { printf("ok slow %s: %d steps of one unit, %d..%d and back\n", named.name, steps, curve.minValue, curve.maxValue); }
+}
+
+// --- random ---
+static bool onPerceptualGrid(const EncoderCurve& curve, int value) {
+    for (int level = 0; level <= curve.coarseSteps; level++) {
+        if (encoderValueForLevel(curve, level * 100.0f / curve.coarseSteps) == value) return true;
+    }
+    return false;
+}
+
+static void checkRandom(const NamedCurve& named, int traces, uint32_t seed) {
+    const EncoderCurve& curve = named.curve;
+    int before = failures;
+    std::mt19937 random(seed);
+    long changes = 0;
+    int coarse = 0;
+    for (int trace = 0; trace < traces; trace++) {
+        EncoderVelocity velocity;
+        uint32_t timeMs = random(); // Anywhere, including near the wrap
+        int value = curve.minValue + (int)(random() % (curve.maxValue - curve.minValue + 1));
+        int direction = random() % 2 ? 1 : -1;
+        float rate = 1 + random() % 60;
+        for (int event = 0; event < 300; event++) {
+            switch (random() % 20) {
+                case 0: direction = -direction; break;              // Turn back
+                case 1: rate = 1 + random() % 60; break;            // Change pace
+                case 2: timeMs += 100 + random() % 900; break;      // Pause
+                default: break;
+            }
+            timeMs += (uint32_t)(1000 / rate * (0.7 + 0.6 * (random() % 1000) / 1000.0)); // Uneven hand
+            long steps = direction * (1 + (random() % 8 == 0 ? random() % 3 : 0));      // A busy loop reads several at once
+            float speed = velocity.update(timeMs, steps);
+            EncoderSpeedTier tier = encoderSpeedTier(curve, speed);
+            int next = encoderAccelApply(curve, value, steps, speed);
+            changes++;
+
+            if (next < curve.minValue || next > curve.maxValue) {
+                fail("random", "%s: %d left the range", named.name, next);
+            } else if (next == value && value != (direction > 0 ? curve.maxValue : curve.minValue)) {
+                fail("random", "%s: %d didn't move on %ld steps", named.name, value, steps);
+            } else if ((next - value) * direction < 0) {
+                fail("random", "%s: %d -> %d against %ld steps", named.name, value, next, steps);
+            } else if (tier == ENCODER_SPEED_SLOW && labs(steps) == 1 && next != value && abs(next - value) != 1) {
+                fail("random", "%s: slow step %d -> %d", named.name, value, next);
+            } else if (tier != ENCODER_SPEED_SLOW && next != curve.minValue && next != curve.maxValue) {
+                coarse++;
+                if (curve.kind == ENCODER_CURVE_DECADE && next % encoderDecadeStep(curve, tier) != 0) {
+                    fail("random", "%s: coarse step %d -> %d is off the multiples of %d", named.name, value, next,
+                         encoderDecadeStep(curve, tier));
+                }
+                if (curve.kind == ENCODER_CURVE_PERCEPTUAL && !onPerceptualGrid(curve, next) && abs(next - value) != labs(steps)) {
+                    fail("random", "%s: coarse step %d -> %d is off the perceptual grid", named.name, value, next);
+                }
+            }
+            value = next;
+        }
+    }
+    if (failures == before) { printf("ok random %s: %d traces, %ld changes, %d coarse\n", named.name, traces, changes, coarse); }
+}
+
+// --- reach ---
+struct ReachResult {
+    uint32_t timeMs;
+    int steps;
+    int turnsBack;
+};
+
+static ReachResult reach(const EncoderCurve& curve, int start, int target) {
+    EncoderVelocity velocity;
+    ReachResult result = {0, 0, 0};
+    float timeMs = 0;
+    int value = start;
+    int lastDirection = 0;
+    while (value != target && result.steps < 10000) {
+        int direction = target > value ? 1 : -1;
+        // Fastest pace whose step stays short of the target
+        float pace = slowTurnSps;
+        if ((target - encoderAccelApply(curve, value, direction, curve.fastFromSps)) * direction >= 0) {
+            pace = fastTurnSps;
+        } else if ((target - encoderAccelApply(curve, value, direction, curve.mediumFromSps)) * direction >= 0) {
+            pace = mediumTurnSps;
+        }
+        if (lastDirection != 0 && direction != lastDirection) { result.turnsBack++; }
+        lastDirection = direction;
+        timeMs += 1000 / pace;
+        value = encoderAccelApply(curve, value, direction, velocity.update((uint32_t)timeMs, direction));
+        result.steps++;
+    }
+    result.timeMs = (uint32_t)timeMs;
+    return result;
+}
+
+static void checkReach(const NamedCurve& named, uint32_t budgetMs) {
+    const EncoderCurve& curve = named.curve;
+    int before = failures;
+    int span = curve.maxValue - curve.minValue;
+    const int starts[] = {curve.minValue, curve.minValue + span / 10, curve.minValue + span / 2, curve.maxValue - span / 10, curve.maxValue};
+    ReachResult worst = {0, 0, 0};
+    int worstStart = 0;
+    int worstTarget = 0;
+    double totalMs = 0;
+    int runs = 0;
+    for (int start : starts) {
+        for (int target = curve.minValue; target <= curve.maxValue; target++) {
+            ReachResult result = reach(curve, start, target);
+            if (result.timeMs > worst.timeMs) {
+                worst = result;
+                worstStart = start;
+                worstTarget = target;
+            }
+            totalMs += result.timeMs;
+            runs++;
+            if (result.timeMs > budgetMs) {
+                fail("reach", "%s: %d -> %d took %.2f s (%d steps)", named.name, start, target, result.timeMs / 1000.0, result.steps);
+            }
+        }
+    }
+    // Before acceleration: the whole range at the fast pace, a fixed step each
+    float oldMs = (float)span / named.oldStep / fastTurnSps * 1000;
+    if (failures == before) {
+        printf("ok reach %s: %d runs, worst %.2f s (%d -> %d, %d steps, %d turns back), mean %.2f s; fixed steps took %.2f s end to end\n",
+               named.name, runs, worst.timeMs / 1000.0, worstStart, worstTarget, worst.steps, worst.turnsBack,
+               totalMs / runs / 1000.0, oldMs / 1000.0);
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t budgetMs = 4000;
+    int traces = 200;
+    uint32_t seed = 1;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--budget-ms") && hasValue) { budgetMs = (uint32_t)atol(argv[++i]); }
+        else if (!strcmp(argv[i], "--traces") && hasValue) { traces = atoi(argv[++i]); }
+        else if (!strcmp(argv[i], "--seed") && hasValue) { seed = (uint32_t)atol(argv[++i]); }
+        else {
+            fprintf(stderr, "usage: %s [--budget-ms N] [--traces N] [--seed S]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    checkVelocity();
+    for (const NamedCurve& named : curves) {
+        checkSlow(named);
+        checkRandom(named, traces, seed);
+        checkReach(named, budgetMs);
+    }
+    if (failures > 0) { printf("%d failures\n", failures); }
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,138 @@
+// Host check of the INA219 register math (ina219.h) against register dumps.
+// Reads tools/golden/ina219_registers.txt (or the file given) and checks:
+//   calibration  current LSB and calibration register for a shunt
+//   config       configuration register of each ADC profile
+//   sample       the conversion-ready and overflow flags, bus voltage,
+//                current, power and shunt voltage decoded from one result set
+// Every sample is also checked against the chip's own math, current =
+// shunt * calibration / 4096 and power = |current| * bus / 5000, so a dump
+// that doesn't fit its shunt is caught as well as a decode that is wrong.
+// scripts/ina219_decode.sh builds and runs it.
+//
+//   ina219_decode [dump file]
+
+#include "ina219.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+struct Fields {
+    char text[512];
+
+    // Value of "key=..." in the line, or nullptr
+    const char* get(const char* key) const {
+        size_t length = strlen(key);
+        for (const char* p = text; (p = strstr(p, key)) != nullptr; p += length) {
+            if ((p == text || p[-1] == ' ') && p[length] == '=') return p + length + 1;
+        }
+        return nullptr;
+    }
+    bool has(const char* key) const {
+        const char* value = get(key);
+        return value != nullptr && *value != '-';
+    }
+    long long number(const char* key) const {
+        const char* value = get(key);
+        return value != nullptr ? strtoll(value, nullptr, 0) : 0;
+    }
+    std::string word(const char* key) const {
+        const char* value = get(key);
+        if (value == nullptr) return "";
+        return std::string(value, strcspn(value, " \n"));
+    }
+};
+
+static int failures = 0;
+static int checks = 0;
+
+static void expect(int lineNumber, const char* what, long long got, long long want) {
+    checks++;
+    if (got == want) return;
+    failures++;
+    printf("!!! line %d %s: got %lld, want %lld\n", lineNumber, what, got, want);
+}
+
+static void checkCalibration(int lineNumber, const Fields& f) {
+    uint32_t shunt = (uint32_t)f.number("shunt_uohm");
+    uint32_t lsb = ina219CurrentLsbUa(shunt);
+    expect(lineNumber, "current_lsb_ua", lsb, f.number("current_lsb_ua"));
+    expect(lineNumber, "calibration", ina219CalibrationValue(lsb, shunt), f.number("value"));
+}
+
+static void checkConfig(int lineNumber, const Fields& f) {
+    static const char* const profileNames[NUM_INA219_PROFILES] = {"monitor", "calibration", "probe"};
+    std::string name = f.word("profile");
+    for (int p = 0; p < NUM_INA219_PROFILES; p++) {
+        if (name == profileNames[p]) {
+            expect(lineNumber, ("config " + name).c_str(), ina219ConfigValue((Ina219Profile)p), f.number("value"));
+            return;
+        }
+    }
+    failures++;
+    printf("!!! line %d: unknown profile %s\n", lineNumber, name.c_str());
+}
+
+static void checkSample(int lineNumber, const Fields& f) {
+    uint32_t shunt = (uint32_t)f.number("shunt_uohm");
+    uint32_t lsb = ina219CurrentLsbUa(shunt);
+    uint16_t cal = ina219CalibrationValue(lsb, shunt);
+    uint16_t busRaw = (uint16_t)f.number("bus");
+    uint16_t shuntRaw = (uint16_t)f.number("shunt");
+    uint16_t currentRaw = (uint16_t)f.number("current");
+    uint16_t powerRaw = (uint16_t)f.number("power");
+    std::string name = f.word("name");
+    int before = failures;
+
+    Ina219Sample sample = ina219DecodeSample(busRaw, currentRaw, powerRaw, lsb, shunt);
+    expect(lineNumber, "ready", ina219ConversionReady(busRaw), f.number("ready"));
+    expect(lineNumber, "overflow", sample.overflow, f.number("overflow"));
+    expect(lineNumber, "bus_mv", sample.busMv, f.number("bus_mv"));
+    if (f.has("current_ua")) { expect(lineNumber, "current_ua", sample.currentUa, f.number("current_ua")); }
+    if (f.has("power_uw")) { expect(lineNumber, "power_uw", sample.powerUw, f.number("power_uw")); }
+    if (f.has("shunt_uv")) { expect(lineNumber, "shunt_uv", sample.shuntUv, f.number("shunt_uv")); }
+
+    if (!sample.overflow) {
+        // The chip's math: the dump has to fit the shunt it claims
+        int32_t chipCurrent = (int32_t)(int16_t)shuntRaw * cal / 4096;
+        expect(lineNumber, "chip current register", (int16_t)currentRaw, chipCurrent);
+        int32_t magnitude = chipCurrent < 0 ? -chipCurrent : chipCurrent;
+        expect(lineNumber, "chip power register", powerRaw, magnitude * (busRaw >> 3) / 5000);
+        // The register reading of the shunt is within one current step of the derived one
+        long long readUv = ina219DecodeShuntUv(shuntRaw);
+        long long stepUv = (long long)lsb * shunt / 1000000;
+        checks++;
+        if (llabs(readUv - sample.shuntUv) > stepUv) {
+            failures++;
+            printf("!!! line %d: shunt register %lld µV vs derived %ld µV\n", lineNumber, readUv, (long)sample.shuntUv);
+        }
+    }
+    if (failures == before) {
+        printf("ok %s: bus_mv=%lu current_ua=%ld power_uw=%lu%s%s\n", name.c_str(), (unsigned long)sample.busMv,
+               (long)sample.currentUa, (unsigned long)sample.powerUw, ina219ConversionReady(busRaw) ? "" : " not_ready",
+               sample.overflow ? " overflow" : "");
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : "tools/golden/ina219_registers.txt";
+    FILE* in = fopen(path, "r");
+    if (in == nullptr) {
+        perror(path);
+        return 2;
+    }
+    Fields f;
+    int lineNumber = 0;
+    int calibrations = 0, configs = 0;
+    while (fgets(f.text, sizeof(f.text), in) != nullptr) {
+        lineNumber++;
+        if (!strncmp(f.text, "calibration ", 12)) { checkCalibration(lineNumber, f); calibrations++; }
+        else if (!strncmp(f.text, "config ", 7)) { checkConfig(lineNumber, f); configs++; }
+        else if (!strncmp(f.text, "sample ", 7)) { checkSample(lineNumber, f); }
+    }
+    fclose(in);
+    if (failures == 0) { printf("ok %d calibrations, %d profiles, %d checks\n", calibrations, configs, checks); }
+    else { printf("%d failures\n", failures); }
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,160 @@
+// Host check of the LED count search (led_count_detect.h) against a simulated
+// strip. Every pixel draws its own full-white current, spread around a typical
+// WS2812. Each reading goes through a model of the INA219 in the probe
+// profile: supply ripple plus shunt ADC noise per sample, averaged on chip,
+// then rounded to the 10 µV shunt step and the current LSB (10 mA at 1 mΩ).
+// The chain stops at its first dead pixel, so from there on nothing lights.
+// For every strip length and dead position the search must return the working
+// length, probe only pixels on the strip, and use no more than ceil(log2(n+1))
+// measurements (10 for 1000 LEDs). The cases include an all-dead strip, a
+// fully working one and a first pixel that is dead.
+// scripts/led_count_detect.sh builds and runs it.
+//
+//   led_count_detect [--adc-noise-uv SIGMA] [--ripple-ma SIGMA] [--averaging N] [--random N] [--seed S] [--verbose]
+
+#include "led_count_detect.h"
+#include "ina219.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <random>
+#include <vector>
+
+// Same as autoDetectMinLitDeltaMa and autoDetectBaselineReads in main.cpp
+const float minLitDeltaMa = 20.0f;
+const int baselineReads = 4;
+// Full-white draw of one pixel: WS2812/SK6812 parts vary a lot from batch to batch
+const float minPixelMa = 35.0f;
+const float maxPixelMa = 60.0f;
+const float idleStripMa = 0.8f;    // Quiescent draw per pixel, dark or not
+const float shuntStepUv = 10.0f;   // INA219 shunt voltage register step
+
+struct Ina219Model {
+    float adcNoiseUv;  // Per-sample shunt ADC noise
+    float rippleMa;    // Supply ripple, per sample
+    int averaging;     // On-chip samples per result
+};
+
+struct SimulatedStrip {
+    std::vector<float> pixelMa; // Full-white draw of each pixel
+    int firstDead;              // Pixels from here on never light
+    Ina219Model sensor;
+    std::mt19937 random;
+    std::normal_distribution<float> noise{0.0f, 1.0f};
+    float baselineMa = 0;       // Dark strip current, averaged like runLedCountDetect()
+    int probes = 0;
+    int outOfRange = 0;         // Probes past the end of the strip
+
+    SimulatedStrip(int leds, int firstDead, const Ina219Model& sensor, uint32_t seed)
+        : pixelMa(leds), firstDead(firstDead), sensor(sensor), random(seed) {
+        std::uniform_real_distribution<float> draw(minPixelMa, maxPixelMa);
+        for (float& ma : pixelMa) { ma = draw(random); }
+        for (int i = 0; i < baselineReads; i++) { baselineMa += read(-1) / baselineReads; }
+    }
+
+    // One INA219 reading with only pixel `lit` on (-1: all dark)
+    float read(int lit) {
+        float ma = idleStripMa * pixelMa.size();
+        if (lit >= 0 && lit < firstDead) { ma += pixelMa[lit]; }
+        const float shuntUohm = INA219_SHUNT_MICROOHM;
+        float sumUv = 0;
+        for (int i = 0; i < sensor.averaging; i++) {
+            sumUv += (ma + noise(random) * sensor.rippleMa) * shuntUohm / 1000 + noise(random) * sensor.adcNoiseUv;
+        }
+        float shuntUv = roundf(sumUv / sensor.averaging / shuntStepUv) * shuntStepUv;
+        float lsbMa = ina219CurrentLsbUa(INA219_SHUNT_MICROOHM) / 1000.0f;
+        return truncf(shuntUv * 1000 / shuntUohm / lsbMa) * lsbMa; // The chip truncates the current register
+    }
+};
+
+static float probe(int index, void* context) {
+    SimulatedStrip& strip = *(SimulatedStrip*)context;
+    strip.probes++;
+    if (index < 0 || index >= (int)strip.pixelMa.size()) {
+        strip.outOfRange++;
+        return 0;
+    }
+    return strip.read(index) - strip.baselineMa;
+}
+
+static int maxMeasurements(int leds) {
+    return (int)ceil(log2((double)leds + 1));
+}
+
+static int failures = 0;
+static int cases = 0;
+static int worstMeasurements = 0;
+
+static void runCase(int leds, int firstDead, const Ina219Model& sensor, uint32_t seed, bool verbose) {
+    SimulatedStrip strip(leds, firstDead, sensor, seed);
+    LedCountDetectResult result = detectLedCount(leds, minLitDeltaMa, probe, &strip);
+    int expected = firstDead < leds ? firstDead : leds;
+    cases++;
+    if (result.measurements > worstMeasurements) { worstMeasurements = result.measurements; }
+
+    const char* problem = nullptr;
+    if (result.workingLeds != expected) {
+        problem = "wrong length";
+    } else if (result.measurements != strip.probes) {
+        problem = "measurement count doesn't match the probes made";
+    } else if (result.measurements > maxMeasurements(leds)) {
+        problem = "too many measurements";
+    } else if (strip.outOfRange > 0) {
+        problem = "probed past the end of the strip";
+    }
+    if (problem != nullptr) {
+        failures++;
+        printf("!!! leds=%d first_dead=%d: %s (found %d in %d measurements, limit %d)\n", leds, firstDead, problem,
+               result.workingLeds, result.measurements, maxMeasurements(leds));
+    } else if (verbose) {
+        printf("    leds=%d first_dead=%d: %d in %d measurements\n", leds, firstDead, result.workingLeds, result.measurements);
+    }
+}
+
+int main(int argc, char** argv) {
+    Ina219Model sensor = {10.0f, 2.0f, 16}; // One shunt step of ADC noise, probe profile averaging
+    int randomCases = 500;
+    uint32_t seed = 1;
+    bool verbose = false;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--verbose")) { verbose = true; }
+        else if (!strcmp(argv[i], "--adc-noise-uv") && hasValue) { sensor.adcNoiseUv = (float)atof(argv[++i]); }
+        else if (!strcmp(argv[i], "--ripple-ma") && hasValue) { sensor.rippleMa = (float)atof(argv[++i]); }
+        else if (!strcmp(argv[i], "--averaging") && hasValue) { sensor.averaging = atoi(argv[++i]); }
+        else if (!strcmp(argv[i], "--random") && hasValue) { randomCases = atoi(argv[++i]); }
+        else if (!strcmp(argv[i], "--seed") && hasValue) { seed = (uint32_t)atol(argv[++i]); }
+        else {
+            fprintf(stderr, "usage: %s [--adc-noise-uv SIGMA] [--ripple-ma SIGMA] [--averaging N] [--random N] [--seed S] [--verbose]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    // Edge cases and a few fixed positions, for the firmware's strip lengths and some awkward ones
+    const int lengths[] = {1, 2, 3, 60, 300, 1000, 1023, 1024, 4000};
+    for (int leds : lengths) {
+        const int positions[] = {0, 1, 2, leds / 3, leds / 2, leds - 1, leds};
+        for (int firstDead : positions) {
+            if (firstDead < 0 || firstDead > leds) continue;
+            runCase(leds, firstDead, sensor, seed + cases, verbose);
+        }
+    }
+    printf("%s edge cases: %d cases (all dead, first dead, last dead, all good), worst %d measurements for 4000 LEDs\n",
+           failures == 0 ? "ok" : "!!!", cases, worstMeasurements);
+
+    // Random dead positions on the firmware's 1000-LED strip
+    int before = failures;
+    int edgeCases = cases;
+    worstMeasurements = 0;
+    std::mt19937 random(seed);
+    for (int i = 0; i < randomCases; i++) {
+        runCase(1000, (int)(random() % 1001), sensor, seed + cases, verbose);
+    }
+    printf("%s random 1000 LEDs: %d cases, worst %d measurements (limit %d)\n", failures == before ? "ok" : "!!!",
+           cases - edgeCases, worstMeasurements, maxMeasurements(1000));
+
+    if (failures > 0) { printf("%d failures\n", failures); }
+    return failures > 0 ? 1 : 0;
+}
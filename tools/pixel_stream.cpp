@@ -0,0 +1,373 @@
+// Host tools for the Adalight pixel stream (pixel_stream.h), Linux only.
+//
+//   pixel_stream send --port /dev/ttyUSB0 --leds 1000 [--enter] [--baud 2000000] [--fps 0] [--seconds 10]
+//                     [--bad-header-every K] [--stall-every K] [--oversize-every K]
+//   pixel_stream node --leds 1000 [--chipset ws2812|sk6812] [--segments 1] [--idle-ms 5000]
+//
+// send pushes numbered test frames to a board (or a node). With --enter it
+// first types 'a' at the console baud and waits for "STREAM BEGIN". --fps 0
+// sends as fast as the port takes them. The --*-every options swap every K-th
+// frame for a header with a bad checksum, a frame cut off for longer than the
+// frame timeout, or a frame longer than the strip, so the error counters can
+// be checked. The board's STREAM report lines are echoed as they come back.
+//
+// node is the board's side on a pty, for testing without hardware: it prints
+// "PORT <path>" for send. It runs the same parser and reads straight into a
+// back buffer. Each frame waits for the previous one's modelled wire time, as
+// ledOutputPresent() waits for the strip (led_segments.h). Every frame is
+// checked against the test pattern, and the node prints the board's STREAM
+// lines plus content_errors. scripts/pixel_stream_pty.sh runs both.
+
+#include "led_segments.h"
+#include "pixel_stream.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+static uint64_t monotonicUs() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000ULL + now.tv_nsec / 1000;
+}
+
+static uint32_t monotonicMs() {
+    return (uint32_t)(monotonicUs() / 1000);
+}
+
+static void sleepUntilUs(uint64_t dueUs) {
+    timespec due = {(time_t)(dueUs / 1000000), (long)(dueUs % 1000000 * 1000)};
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, nullptr);
+}
+
+// Test frame k: pixel 0 carries the frame number, every other byte follows from it
+static void fillTestFrame(uint32_t k, uint8_t* pixels, int count) {
+    pixels[0] = (uint8_t)k;
+    pixels[1] = (uint8_t)(k >> 8);
+    pixels[2] = 0x5a;
+    for (int i = 1; i < count; i++) {
+        for (int c = 0; c < 3; c++) { pixels[i * 3 + c] = (uint8_t)(k + i * 3 + c * 85); }
+    }
+}
+
+static bool checkTestFrame(const uint8_t* pixels, int count) {
+    if (pixels[2] != 0x5a) return false;
+    uint32_t k = pixels[0] | pixels[1] << 8;
+    for (int i = 1; i < count; i++) {
+        for (int c = 0; c < 3; c++) {
+            if (pixels[i * 3 + c] != (uint8_t)(k + i * 3 + c * 85)) return false;
+        }
+    }
+    return true;
+}
+
+static void adalightHeader(int pixels, uint8_t* header) {
+    uint16_t count = (uint16_t)(pixels - 1);
+    header[0] = 'A';
+    header[1] = 'd';
+    header[2] = 'a';
+    header[3] = (uint8_t)(count >> 8);
+    header[4] = (uint8_t)count;
+    header[5] = header[3] ^ header[4] ^ 0x55;
+}
+
+static bool setSpeed(int fd, long baud) {
+    termios settings;
+    if (tcgetattr(fd, &settings) != 0) return true; // Not a tty: nothing to set
+    cfmakeraw(&settings);
+    static const struct { long baud; speed_t speed; } speeds[] = {
+        {115200, B115200}, {230400, B230400}, {460800, B460800}, {921600, B921600},
+        {1000000, B1000000}, {1500000, B1500000}, {2000000, B2000000}, {3000000, B3000000},
+    };
+    for (const auto& entry : speeds) {
+        if (entry.baud == baud) {
+            cfsetispeed(&settings, entry.speed);
+            cfsetospeed(&settings, entry.speed);
+            return tcsetattr(fd, TCSANOW, &settings) == 0;
+        }
+    }
+    fprintf(stderr, "unsupported baud %ld\n", baud);
+    return false;
+}
+
+static bool writeAll(int fd, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN) {
+                pollfd out = {fd, POLLOUT, 0};
+                poll(&out, 1, 100);
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+    return true;
+}
+
+// Print complete lines arriving on fd with a prefix; returns true once one starts with match
+struct LineReader {
+    char buffer[512];
+    size_t length = 0;
+
+    bool pump(int fd, const char* prefix, const char* match) {
+        bool matched = false;
+        for (;;) {
+            ssize_t got = read(fd, buffer + length, sizeof(buffer) - 1 - length);
+            if (got <= 0) break;
+            length += (size_t)got;
+            char* start = buffer;
+            char* newline;
+            while ((newline = (char*)memchr(start, '\n', buffer + length - start)) != nullptr) {
+                *newline = '\0';
+                if (newline > start && newline[-1] == '\r') newline[-1] = '\0';
+                if (*start != '\0') printf("%s%s\n", prefix, start);
+                if (match != nullptr && strncmp(start, match, strlen(match)) == 0) matched = true;
+                start = newline + 1;
+            }
+            length -= (size_t)(start - buffer);
+            memmove(buffer, start, length);
+            if (length == sizeof(buffer) - 1) length = 0; // A line too long to be a report
+        }
+        fflush(stdout);
+        return matched;
+    }
+};
+
+static int runSend(int argc, char** argv) {
+    const char* port = nullptr;
+    int leds = 0;
+    long baud = PIXEL_STREAM_BAUD > 0 ? PIXEL_STREAM_BAUD : 115200;
+    bool enter = false;
+    double fps = 0;
+    double seconds = 10;
+    int badHeaderEvery = 0;
+    int stallEvery = 0;
+    int oversizeEvery = 0;
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--enter")) { enter = true; }
+        else if (!strcmp(argv[i], "--port") && hasValue) { port = argv[++i]; }
+        else if (!strcmp(argv[i], "--leds") && hasValue) { leds = atoi(argv[++i]); }
+        else if (!strcmp(argv[i], "--baud") && hasValue) { baud = atol(argv[++i]); }
+        else if (!strcmp(argv[i], "--fps") && hasValue) { fps = atof(argv[++i]); }
+        else if (!strcmp(argv[i], "--seconds") && hasValue) { seconds = atof(argv[++i]); }
+        else if (!strcmp(argv[i], "--bad-header-every") && hasValue) { badHeaderEvery = atoi(argv[++i]); }
+        else if (!strcmp(argv[i], "--stall-every") && hasValue) { stallEvery = atoi(argv[++i]); }
+        else if (!strcmp(argv[i], "--oversize-every") && hasValue) { oversizeEvery = atoi(argv[++i]); }
+        else { port = nullptr; break; }
+    }
+    if (port == nullptr || leds <= 0 || leds > 65535) {
+        fprintf(stderr, "usage: %s send --port PATH --leds N [--enter] [--baud B] [--fps F] [--seconds S]\n"
+                        "       [--bad-header-every K] [--stall-every K] [--oversize-every K]\n", argv[0]);
+        return 2;
+    }
+
+    int fd = open(port, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) {
+        fprintf(stderr, "can't open %s: %s\n", port, strerror(errno));
+        return 1;
+    }
+    LineReader device;
+    if (enter) {
+        if (!setSpeed(fd, 115200)) return 1;
+        tcflush(fd, TCIOFLUSH);
+        writeAll(fd, (const uint8_t*)"a", 1);
+        uint64_t deadlineUs = monotonicUs() + 3000000;
+        bool begun = false;
+        while (!begun && monotonicUs() < deadlineUs) {
+            pollfd in = {fd, POLLIN, 0};
+            poll(&in, 1, 100);
+            begun = device.pump(fd, "DEVICE ", "STREAM BEGIN");
+        }
+        if (!begun) {
+            fprintf(stderr, "no STREAM BEGIN from %s\n", port);
+            return 1;
+        }
+    }
+    if (!setSpeed(fd, baud)) return 1;
+
+    const int oversizePixels = leds + 1;
+    std::vector<uint8_t> frame(pixelStreamHeaderSize + oversizePixels * 3);
+    uint32_t sent = 0, badHeaders = 0, stalls = 0, oversize = 0;
+    uint64_t startUs = monotonicUs();
+    uint64_t nextFrameUs = startUs;
+    while (monotonicUs() - startUs < (uint64_t)(seconds * 1e6)) {
+        int k = (int)(sent + badHeaders + stalls + oversize);
+        uint8_t* header = frame.data();
+        uint8_t* pixels = header + pixelStreamHeaderSize;
+        if (badHeaderEvery > 0 && k % badHeaderEvery == badHeaderEvery - 1) {
+            adalightHeader(leds, header);
+            header[5] ^= 0xff;
+            writeAll(fd, header, pixelStreamHeaderSize);
+            badHeaders++;
+        } else if (stallEvery > 0 && k % stallEvery == stallEvery - 1) {
+            adalightHeader(leds, header);
+            fillTestFrame(k, pixels, leds);
+            writeAll(fd, frame.data(), pixelStreamHeaderSize + leds * 3 / 2);
+            usleep((PIXEL_STREAM_FRAME_TIMEOUT_MS + 50) * 1000); // Long enough to be dropped
+            stalls++;
+        } else if (oversizeEvery > 0 && k % oversizeEvery == oversizeEvery - 1) {
+            adalightHeader(oversizePixels, header);
+            fillTestFrame(k, pixels, oversizePixels);
+            writeAll(fd, frame.data(), pixelStreamHeaderSize + oversizePixels * 3);
+            oversize++;
+        } else {
+            adalightHeader(leds, header);
+            fillTestFrame(k, pixels, leds);
+            if (!writeAll(fd, frame.data(), pixelStreamHeaderSize + leds * 3)) {
+                fprintf(stderr, "write failed: %s\n", strerror(errno));
+                return 1;
+            }
+            sent++;
+        }
+        device.pump(fd, "DEVICE ", nullptr);
+        if (fps > 0) {
+            nextFrameUs += (uint64_t)(1e6 / fps);
+            sleepUntilUs(nextFrameUs);
+        }
+    }
+    double elapsedS = (monotonicUs() - startUs) / 1e6;
+    printf("SEND frames=%lu seconds=%.1f fps=%.1f bad_headers=%lu stalls=%lu oversize=%lu\n", (unsigned long)sent,
+           elapsedS, sent / elapsedS, (unsigned long)badHeaders, (unsigned long)stalls, (unsigned long)oversize);
+    fflush(stdout);
+
+    // Stay for the board's last reports; it ends the stream once it has been idle
+    uint64_t deadlineUs = monotonicUs() + PIXEL_STREAM_IDLE_EXIT_MS * 1000ULL + 2000000;
+    bool ended = false;
+    while (!ended && monotonicUs() < deadlineUs) {
+        pollfd in = {fd, POLLIN, 0};
+        poll(&in, 1, 100);
+        ended = device.pump(fd, "DEVICE ", "STREAM END");
+    }
+    close(fd);
+    return 0;
+}
+
+static int runNode(int argc, char** argv) {
+    int leds = 0;
+    int segments = 1;
+    uint32_t idleMs = PIXEL_STREAM_IDLE_EXIT_MS;
+    const LedWireTiming* timing = &ws2812WireTiming;
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--leds") && hasValue) { leds = atoi(argv[++i]); }
+        else if (!strcmp(argv[i], "--segments") && hasValue) { segments = atoi(argv[++i]); }
+        else if (!strcmp(argv[i], "--idle-ms") && hasValue) { idleMs = (uint32_t)atol(argv[++i]); }
+        else if (!strcmp(argv[i], "--chipset") && hasValue) {
+            timing = !strcmp(argv[++i], "sk6812") ? &sk6812WireTiming : &ws2812WireTiming;
+        } else { leds = 0; break; }
+    }
+    if (leds <= 0) {
+        fprintf(stderr, "usage: %s node --leds N [--chipset ws2812|sk6812] [--segments S] [--idle-ms MS]\n", argv[0]);
+        return 2;
+    }
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        fprintf(stderr, "can't create a pty: %s\n", strerror(errno));
+        return 1;
+    }
+    const char* path = ptsname(master);
+    int slave = open(path, O_RDWR | O_NOCTTY); // Held open so the pty survives until send opens it
+    termios settings;
+    if (slave >= 0 && tcgetattr(slave, &settings) == 0) {
+        cfmakeraw(&settings);
+        tcsetattr(slave, TCSANOW, &settings);
+    }
+
+    // What the strip costs per frame, which paces ledOutputPresent() on the board
+    LedSegmentPlan plan = planLedSegments(leds, segments, false);
+    const uint64_t wireUs = ledWireFrameUs(plan.longestWireBytes, *timing);
+    printf("PORT %s\n", path);
+    printf("NODE leds=%d segments=%d chipset=%s wire_us=%lu max_fps=%.1f\n", leds, plan.numSegments, timing->name,
+           (unsigned long)wireUs, 1e6 / wireUs);
+    fflush(stdout);
+
+    PixelStreamParser parser(leds);
+    std::vector<uint8_t> buffers[2] = {std::vector<uint8_t>(leds * 3), std::vector<uint8_t>(leds * 3)};
+    int back = 0;
+    uint64_t wireBusyUntilUs = 0;
+    uint32_t contentErrors = 0;
+    uint32_t windowFrames = 0;
+    uint32_t windowStartMs = monotonicMs();
+    uint32_t nextReportMs = windowStartMs + 1000;
+    bool hasData = false;
+    uint32_t firstDataMs = 0;
+    uint32_t lastDataMs = windowStartMs;
+    char line[256];
+
+    auto report = [&](const char* tag, uint32_t frames, uint32_t windowMs) {
+        size_t length;
+        formatPixelStreamReport(line, sizeof(line) - 32, tag, parser.stats(), frames, windowMs, 0);
+        length = strlen(line);
+        snprintf(line + length, sizeof(line) - length, " content_errors=%lu\n", (unsigned long)contentErrors);
+        fputs(line, stdout);
+        fflush(stdout);
+        writeAll(master, (const uint8_t*)line, strlen(line));
+    };
+
+    for (;;) {
+        uint32_t nowMs = monotonicMs();
+        uint32_t waitMs = nextReportMs - nowMs;
+        uint32_t expiryMs = parser.msUntilExpiry(nowMs);
+        if (expiryMs < waitMs) waitMs = expiryMs;
+        if (lastDataMs + idleMs - nowMs < waitMs) waitMs = lastDataMs + idleMs - nowMs;
+        pollfd in = {master, POLLIN, 0};
+        poll(&in, 1, (int)waitMs + 1);
+
+        if (in.revents & POLLIN) {
+            size_t maxBytes;
+            uint8_t* destination = parser.writePointer(maxBytes);
+            ssize_t length = read(master, destination, maxBytes);
+            nowMs = monotonicMs();
+            if (length > 0) {
+                if (!hasData) { firstDataMs = nowMs; hasData = true; }
+                lastDataMs = nowMs;
+                PixelStreamEvent event = parser.commit((size_t)length, nowMs);
+                if (event == PIXEL_STREAM_NEED_BUFFER) {
+                    parser.setFrameBuffer(buffers[back].data());
+                } else if (event == PIXEL_STREAM_FRAME) {
+                    if (!checkTestFrame(buffers[back].data(), parser.framePixels())) contentErrors++;
+                    // Present: wait for the strip, swap, and start this frame's wire time
+                    uint64_t nowUs = monotonicUs();
+                    if (nowUs < wireBusyUntilUs) { sleepUntilUs(wireBusyUntilUs); nowUs = wireBusyUntilUs; }
+                    wireBusyUntilUs = nowUs + wireUs;
+                    back ^= 1;
+                    windowFrames++;
+                }
+            }
+        }
+
+        nowMs = monotonicMs();
+        parser.expire(nowMs);
+        if ((int32_t)(nowMs - nextReportMs) >= 0) {
+            report("STREAM", windowFrames, nowMs - windowStartMs);
+            windowFrames = 0;
+            windowStartMs = nowMs;
+            nextReportMs = nowMs + 1000;
+        }
+        if (hasData && nowMs - lastDataMs >= idleMs) {
+            report("STREAM END", parser.stats().frames, lastDataMs - firstDataMs);
+            usleep(200000); // Let send read it before the pty goes away
+            return 0;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && !strcmp(argv[1], "send")) return runSend(argc, argv);
+    if (argc >= 2 && !strcmp(argv[1], "node")) return runNode(argc, argv);
+    fprintf(stderr, "usage: %s send|node ...\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,246 @@
+// Host check of the PWM fade sequencer (pwm_fade.h) against a recording
+// backend. The backend logs every command the LEDC fade unit would get and
+// ends each fade after its time, like the fade-end interrupt; the driver loop
+// feeds requests, fade ends and poll() in the order the pwmFade task does.
+// Each scenario's commands must match exactly:
+//   brightness  a step up, a step down, and a change that arrives mid-fade
+//               and waits for the running segment
+//   toggle      on and off again, each split into segments of at most 250 ms
+//   breathe     two full breaths: linear segments up to the brightness and
+//               down to brightness/8
+//   blink       on/off at a brightness, and starting from the duty already set
+//   unchanged   repeated and reverted requests and a fade to the duty already
+//               set send nothing
+// scripts/pwm_fade_sequence.sh builds and runs it.
+//
+//   pwm_fade_sequence [--verbose]
+
+#include "pwm_fade.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// The expected commands below are worked out for the default timings
+static_assert(PWM_FADE_FULL_SCALE_MS == 400 && PWM_FADE_MAX_SEGMENT_MS == 250, "expected fades assume the default timings");
+static_assert(PWM_BREATHE_PERIOD_MS == 3000 && PWM_BLINK_ON_MS == 500 && PWM_BLINK_OFF_MS == 500,
+              "expected effects assume the default timings");
+
+const int numChannels = 3; // LED2-4
+
+// --- Recording Backend ---
+struct Recorder {
+    uint32_t nowMs = 0;
+    bool fading[numChannels] = {};
+    uint32_t fadeEndMs[numChannels] = {};
+    std::vector<std::string> commands;
+
+    void record(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        char line[64];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(line, sizeof(line), format, args);
+        va_end(args);
+        commands.push_back(line);
+    }
+};
+
+static void recordSetDuty(int channel, uint8_t duty, void* context) {
+    Recorder& recorder = *(Recorder*)context;
+    recorder.record("t=%lu ch=%d set duty=%u", (unsigned long)recorder.nowMs, channel, duty);
+}
+
+static void recordStartFade(int channel, uint8_t duty, uint32_t fadeMs, void* context) {
+    Recorder& recorder = *(Recorder*)context;
+    recorder.record("t=%lu ch=%d fade duty=%u ms=%lu", (unsigned long)recorder.nowMs, channel, duty, (unsigned long)fadeMs);
+    recorder.fading[channel] = true;
+    recorder.fadeEndMs[channel] = recorder.nowMs + fadeMs;
+}
+// --- End Recording Backend ---
+
+struct Request {
+    uint32_t atMs;
+    int channel;
+    PwmProgram program;
+};
+
+struct Scenario {
+    const char* name;
+    std::vector<Request> requests;
+    uint32_t untilMs; // Stop once nothing is due before this
+    std::vector<std::string> expected;
+    uint32_t expectedUnchanged;
+    uint32_t expectedReplaced;
+};
+
+// Run the requests to untilMs; each step handles the earliest fade end, request or hold end
+static std::vector<std::string> play(const Scenario& scenario, PwmFadeStats& stats) {
+    Recorder recorder;
+    PwmFadeSequencer sequencer(numChannels, {recordSetDuty, recordStartFade, &recorder});
+    size_t next = 0;
+    uint32_t wakeMs = UINT32_MAX;
+    for (;;) {
+        uint32_t nowMs = wakeMs;
+        if (next < scenario.requests.size() && scenario.requests[next].atMs < nowMs) { nowMs = scenario.requests[next].atMs; }
+        for (int i = 0; i < numChannels; i++) {
+            if (recorder.fading[i] && recorder.fadeEndMs[i] < nowMs) { nowMs = recorder.fadeEndMs[i]; }
+        }
+        if (nowMs > scenario.untilMs) break;
+
+        recorder.nowMs = nowMs;
+        for (int i = 0; i < numChannels; i++) {
+            if (recorder.fading[i] && recorder.fadeEndMs[i] == nowMs) {
+                recorder.fading[i] = false;
+                sequencer.fadeEnded(i, nowMs);
+            }
+        }
+        for (; next < scenario.requests.size() && scenario.requests[next].atMs == nowMs; next++) {
+            sequencer.request(scenario.requests[next].channel, scenario.requests[next].program, nowMs);
+        }
+        uint32_t waitMs = sequencer.poll(nowMs);
+        wakeMs = waitMs == UINT32_MAX ? UINT32_MAX : nowMs + waitMs;
+    }
+    stats = sequencer.stats();
+    return recorder.commands;
+}
+
+static int failures = 0;
+
+static void check(const Scenario& scenario, bool verbose) {
+    PwmFadeStats stats;
+    std::vector<std::string> got = play(scenario, stats);
+    const std::vector<std::string>& want = scenario.expected;
+    bool match = got == want && stats.unchanged == scenario.expectedUnchanged && stats.replaced == scenario.expectedReplaced;
+    if (match) {
+        printf("ok %s: %d commands, %lu unchanged, %lu replaced\n", scenario.name, (int)got.size(),
+               (unsigned long)stats.unchanged, (unsigned long)stats.replaced);
+        if (verbose) {
+            for (const std::string& command : got) { printf("    %s\n", command.c_str()); }
+        }
+        return;
+    }
+    failures++;
+    printf("!!! %s: commands or counters differ (unchanged %lu want %lu, replaced %lu want %lu)\n", scenario.name,
+           (unsigned long)stats.unchanged, (unsigned long)scenario.expectedUnchanged, (unsigned long)stats.replaced,
+           (unsigned long)scenario.expectedReplaced);
+    for (size_t i = 0; i < got.size() || i < want.size(); i++) {
+        const char* g = i < got.size() ? got[i].c_str() : "-";
+        const char* w = i < want.size() ? want[i].c_str() : "-";
+        printf("%s %-36s want %s\n", strcmp(g, w) == 0 ? "   " : "!!!", g, w);
+    }
+}
+
+// A steady change the way writePwmIfChanged() asks for it
+static PwmProgram fadeTo(uint8_t from, uint8_t to) {
+    return pwmFadeProgram(to, pwmFadeTimeMs(from, to));
+}
+
+int main(int argc, char** argv) {
+    bool verbose = false;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--verbose")) { verbose = true; }
+        else {
+            fprintf(stderr, "usage: %s [--verbose]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    const Scenario scenarios[] = {
+        {"brightness",
+         {{0, 0, fadeTo(0, 128)}, {1000, 0, fadeTo(128, 64)}, {2000, 0, fadeTo(64, 255)}, {2100, 0, fadeTo(255, 0)}},
+         5000,
+         {
+             "t=0 ch=0 fade duty=128 ms=200",     // 128/255 of 400 ms, one segment
+             "t=1000 ch=0 fade duty=64 ms=100",
+             "t=2000 ch=0 fade duty=223 ms=250",  // 64 -> 255 over 299 ms: a full segment first
+             "t=2250 ch=0 fade duty=84 ms=250",   // The change to 0 waited for the segment; 400 ms from 223
+             "t=2500 ch=0 fade duty=0 ms=150",
+         },
+         0, 0},
+        {"toggle",
+         {{0, 1, fadeTo(0, 200)}, {1000, 1, fadeTo(200, 0)}},
+         5000,
+         {
+             "t=0 ch=1 fade duty=159 ms=250",     // On: 313 ms, split at 250
+             "t=250 ch=1 fade duty=200 ms=63",
+             "t=1000 ch=1 fade duty=41 ms=250",   // Off: the same in reverse
+             "t=1250 ch=1 fade duty=0 ms=63",
+         },
+         0, 0},
+        {"breathe",
+         {{0, 2, pwmEffectProgram(PWM_EFFECT_BREATHE, 160)}},
+         2 * PWM_BREATHE_PERIOD_MS - 1,
+         {
+             "t=0 ch=2 fade duty=26 ms=250",      // Up from off: 1500 ms in six segments
+             "t=250 ch=2 fade duty=52 ms=250",
+             "t=500 ch=2 fade duty=79 ms=250",
+             "t=750 ch=2 fade duty=106 ms=250",
+             "t=1000 ch=2 fade duty=133 ms=250",
+             "t=1250 ch=2 fade duty=160 ms=250",
+             "t=1500 ch=2 fade duty=137 ms=250",  // Down to 160/8
+             "t=1750 ch=2 fade duty=114 ms=250",
+             "t=2000 ch=2 fade duty=91 ms=250",
+             "t=2250 ch=2 fade duty=68 ms=250",
+             "t=2500 ch=2 fade duty=44 ms=250",
+             "t=2750 ch=2 fade duty=20 ms=250",
+             "t=3000 ch=2 fade duty=43 ms=250",   // Second breath starts from the floor
+             "t=3250 ch=2 fade duty=66 ms=250",
+             "t=3500 ch=2 fade duty=89 ms=250",
+             "t=3750 ch=2 fade duty=112 ms=250",
+             "t=4000 ch=2 fade duty=136 ms=250",
+             "t=4250 ch=2 fade duty=160 ms=250",
+             "t=4500 ch=2 fade duty=137 ms=250",
+             "t=4750 ch=2 fade duty=114 ms=250",
+             "t=5000 ch=2 fade duty=91 ms=250",
+             "t=5250 ch=2 fade duty=68 ms=250",
+             "t=5500 ch=2 fade duty=44 ms=250",
+             "t=5750 ch=2 fade duty=20 ms=250",
+         },
+         0, 0},
+        {"blink",
+         {{0, 0, pwmEffectProgram(PWM_EFFECT_BLINK, 200)},
+          {2200, 1, fadeTo(0, 90)},
+          {3000, 1, pwmEffectProgram(PWM_EFFECT_BLINK, 90)},
+          {4200, 0, fadeTo(200, 0)}},
+         4999,
+         {
+             "t=0 ch=0 set duty=200",             // Hard steps, held 500 ms each
+             "t=500 ch=0 set duty=0",
+             "t=1000 ch=0 set duty=200",
+             "t=1500 ch=0 set duty=0",
+             "t=2000 ch=0 set duty=200",
+             "t=2200 ch=1 fade duty=90 ms=141",
+             "t=2500 ch=0 set duty=0",
+             "t=3000 ch=0 set duty=200",
+             // ch1 is already at 90: the blink starts with its hold, no write
+             "t=3500 ch=0 set duty=0",
+             "t=3500 ch=1 set duty=0",
+             "t=4000 ch=0 set duty=200",
+             "t=4000 ch=1 set duty=90",
+             "t=4200 ch=0 fade duty=41 ms=250",   // A steady request cuts the hold short
+             "t=4450 ch=0 fade duty=0 ms=63",
+             "t=4500 ch=1 set duty=0",
+         },
+         0, 0},
+        {"unchanged",
+         {{0, 0, fadeTo(0, 255)},
+          {100, 0, fadeTo(0, 255)},              // Same as the one playing
+          {150, 0, fadeTo(255, 10)},             // Replaced before it starts...
+          {200, 0, fadeTo(0, 255)},              // ...by the one playing, so dropped
+          {1000, 0, fadeTo(0, 255)},             // Finished, still the same
+          {1100, 0, fadeTo(255, 255)},           // Fade to where it already is
+          {1200, 0, pwmFadeProgram(255, 0)}},    // Jump to where it already is
+         2000,
+         {
+             "t=0 ch=0 fade duty=159 ms=250",
+             "t=250 ch=0 fade duty=255 ms=150",
+         },
+         3, 1},
+    };
+
+    for (const Scenario& scenario : scenarios) { check(scenario, verbose); }
+    if (failures > 0) { printf("%d failures\n", failures); }
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,128 @@
+// Host check of the parallel segment plan and bit encoding (led_segments.h).
+// Builds the wire buffer the output task would hand to FastLED for a test
+// frame, splits it the way the firmware does, and prints each pin's plan and
+// waveform. It then decodes every pin's waveform and checks it against the
+// pixel bytes that pin should carry, worked out from the pixel numbers alone.
+// scripts/segment_golden.sh runs a few cases and diffs them against
+// tools/golden/.
+//
+//   segment_waveform --leds 10 --segments 3 [--rgbw] [--chipset ws2812|sk6812] [--no-wave]
+//
+// Pixel i of the test frame holds bytes i*4+1, i*4+2, ... so a byte that lands
+// on the wrong pin or in the wrong place shows up in the check.
+
+#include "led_segments.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static uint8_t testByte(int pixel, int channel) {
+    return (uint8_t)(pixel * 4 + channel + 1);
+}
+
+int main(int argc, char** argv) {
+    int leds = 0;
+    int segments = 1;
+    bool rgbw = false;
+    bool wave = true;
+    const LedWireTiming* timing = &ws2812WireTiming;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--rgbw")) { rgbw = true; }
+        else if (!strcmp(argv[i], "--no-wave")) { wave = false; }
+        else if (!strcmp(argv[i], "--leds") && hasValue) { leds = atoi(argv[++i]); }
+        else if (!strcmp(argv[i], "--segments") && hasValue) { segments = atoi(argv[++i]); }
+        else if (!strcmp(argv[i], "--chipset") && hasValue) {
+            const char* name = argv[++i];
+            if (!strcmp(name, "ws2812")) { timing = &ws2812WireTiming; }
+            else if (!strcmp(name, "sk6812")) { timing = &sk6812WireTiming; }
+            else { fprintf(stderr, "unknown chipset %s\n", name); return 2; }
+        } else {
+            fprintf(stderr, "usage: %s --leds N --segments S [--rgbw] [--chipset ws2812|sk6812] [--no-wave]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (leds <= 0) {
+        fprintf(stderr, "need --leds N\n");
+        return 2;
+    }
+    if (rgbw && timing != &sk6812WireTiming) {
+        fprintf(stderr, "RGBW strips are SK6812\n");
+        return 2;
+    }
+
+    // Wire buffer in CRGB entries of 3 bytes, as registered with FastLED. RGB: the
+    // frame itself, reordered per pixel by the controller (GRB for WS2812, RGB for
+    // SK6812). RGBW: packed GRBW quads plus padding, sent as-is.
+    const int bytesPerPixel = rgbw ? 4 : 3;
+    const int wireEntries = rgbw ? (leds * 4 + 2) / 3 : leds;
+    std::vector<uint8_t> wire(wireEntries * 3, 0);
+    for (int i = 0; i < leds; i++) {
+        for (int c = 0; c < bytesPerPixel; c++) { wire[i * bytesPerPixel + c] = testByte(i, c); }
+    }
+    const bool grb = !rgbw && timing == &ws2812WireTiming;
+
+    LedSegmentPlan plan = planLedSegments(leds, segments, rgbw);
+    printf("PLAN leds=%d segments=%d rgbw=%d chipset=%s longest_bytes=%d frame_us=%lu\n", leds, plan.numSegments,
+           rgbw ? 1 : 0, timing->name, plan.longestWireBytes, (unsigned long)ledWireFrameUs(plan.longestWireBytes, *timing));
+
+    int failed = 0;
+    int covered = 0;
+    for (int s = 0; s < plan.numSegments; s++) {
+        const LedSegment& segment = plan.segments[s];
+        printf("SEGMENT index=%d start=%d count=%d wire_start=%d wire_count=%d bytes=%d wire_us=%lu\n", s,
+               segment.start, segment.count, segment.wireStart, segment.wireCount, segment.wireCount * 3,
+               (unsigned long)ledWireFrameUs(segment.wireCount * 3, *timing));
+
+        // Bytes this pin's controller clocks out, in wire order
+        std::vector<uint8_t> sent;
+        for (int e = segment.wireStart; e < segment.wireStart + segment.wireCount; e++) {
+            const uint8_t* entry = &wire[e * 3];
+            if (grb) {
+                sent.insert(sent.end(), {entry[1], entry[0], entry[2]});
+            } else {
+                sent.insert(sent.end(), {entry[0], entry[1], entry[2]});
+            }
+        }
+        std::vector<LedWireSymbol> symbols(sent.size() * 8);
+        ledWireEncode(sent.data(), (int)sent.size(), *timing, symbols.data());
+        if (wave) {
+            for (size_t b = 0; b < sent.size(); b++) {
+                printf("WAVE seg=%d byte=%zu value=0x%02x symbols=", s, b, sent[b]);
+                for (int bit = 0; bit < 8; bit++) {
+                    const LedWireSymbol& symbol = symbols[b * 8 + bit];
+                    printf("%s%u/%u", bit > 0 ? "," : "", symbol.highNs, symbol.lowNs);
+                }
+                printf("\n");
+            }
+        }
+
+        // Expected: the segment's pixels in order, channels in the chipset's wire order.
+        // Only padding (zeros past the last pixel) may follow them.
+        std::vector<uint8_t> decoded(sent.size());
+        int decodedBytes = ledWireDecode(symbols.data(), (int)symbols.size(), *timing, decoded.data());
+        std::vector<uint8_t> expected;
+        for (int i = segment.start; i < segment.start + segment.count; i++) {
+            if (grb) {
+                expected.insert(expected.end(), {testByte(i, 1), testByte(i, 0), testByte(i, 2)});
+            } else {
+                for (int c = 0; c < bytesPerPixel; c++) { expected.push_back(testByte(i, c)); }
+            }
+        }
+        bool ok = segment.start == covered && decodedBytes >= (int)expected.size() &&
+                  memcmp(decoded.data(), expected.data(), expected.size()) == 0;
+        for (int b = (int)expected.size(); ok && b < decodedBytes; b++) {
+            ok = segment.start + segment.count == leds && decoded[b] == 0;
+        }
+        covered = segment.start + segment.count;
+        printf("CHECK seg=%d pixels=%d bytes=%d result=%s\n", s, segment.count, decodedBytes, ok ? "ok" : "FAIL");
+        if (!ok) failed++;
+    }
+    if (covered != leds) {
+        printf("CHECK covered=%d leds=%d result=FAIL\n", covered, leds);
+        failed++;
+    }
+    return failed > 0 ? 1 : 0;
+}
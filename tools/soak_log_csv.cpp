@@ -0,0 +1,363 @@
+// Host tools for the flash soak log (soak_log.h).
+//
+//   soak_log_csv convert [--log FILE | --port /dev/ttyUSB0] [--out FILE]
+//   soak_log_csv simulate --records N [--reboots K] [--seed S] [--expect FILE]
+//
+// convert turns a dump into CSV, one row per record, oldest first. The dump
+// comes from a captured console log, stdin, or the board itself: with --port
+// it types 'd' at 115200 baud and follows the board to the dump baud. The CSV
+// goes to stdout or --out. Lines that aren't part of the dump are ignored.
+// The record count and CRC on the "SOAK DUMP END" line are checked, and a
+// mismatch exits non-zero. Columns:
+//   sequence,boot,time_ms,bus_v,current_ma,lux,pattern,brightness
+// boot counts the resets seen in the dump, from 0: time_ms drops back at each
+// one. lux is empty when there was no reading.
+//
+// simulate runs the firmware's ring and dump code on an in-memory flash. It
+// logs N records over K reboots, some of which are power cuts that lose the
+// partial batch. It then prints the dump, and with --expect writes the CSV
+// that converting the dump must give. That CSV is worked out from the writes
+// alone. scripts/soak_log_roundtrip.sh runs both.
+
+#include "soak_log.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+struct CsvRow {
+    SoakRecord record;
+    int boot;
+};
+
+static void writeCsv(FILE* out, const std::vector<CsvRow>& rows) {
+    fprintf(out, "sequence,boot,time_ms,bus_v,current_ma,lux,pattern,brightness\n");
+    for (const CsvRow& row : rows) {
+        const SoakRecord& r = row.record;
+        fprintf(out, "%lu,%d,%lu,%u.%03u,%d,", (unsigned long)r.sequence, row.boot, (unsigned long)r.timeMs,
+                r.busMv / 1000, r.busMv % 1000, r.currentMa);
+        if (r.lux != soakLuxNone) fprintf(out, "%u", r.lux);
+        fprintf(out, ",%u,%u\n", r.pattern, r.brightness);
+    }
+}
+
+// --- convert ---
+struct DumpReader {
+    std::vector<SoakRecord> records;
+    uint32_t crc = 0;
+    bool ended = false;
+    bool valid = false;
+    int badLines = 0;
+
+    // Returns true once the dump is complete
+    bool line(const char* text) {
+        uint8_t bytes[soakDumpRecordsPerLine * soakRecordSize];
+        int count = soakDumpParseLine(text, bytes, soakDumpRecordsPerLine);
+        if (count > 0) {
+            crc = soakCrc32(crc, bytes, count * soakRecordSize);
+            for (int i = 0; i < count; i++) {
+                SoakRecord record;
+                if (soakRecordDecode(bytes + i * soakRecordSize, record)) records.push_back(record);
+            }
+            return false;
+        }
+        if (strncmp(text, "SOAK DATA", 9) == 0) {
+            badLines++;
+            return false;
+        }
+        unsigned long expectedRecords, expectedCrc;
+        if (sscanf(text, "SOAK DUMP END records=%lu crc32=%lx", &expectedRecords, &expectedCrc) == 2) {
+            ended = true;
+            valid = badLines == 0 && expectedRecords == records.size() && expectedCrc == crc;
+            if (!valid) {
+                fprintf(stderr, "dump damaged: %zu records (end line says %lu), crc32 %08lx (end line says %08lx), %d bad lines\n",
+                        records.size(), expectedRecords, (unsigned long)crc, expectedCrc, badLines);
+            }
+            return true;
+        }
+        return false;
+    }
+};
+
+static std::vector<CsvRow> rowsFromRecords(std::vector<SoakRecord> records) {
+    std::stable_sort(records.begin(), records.end(),
+                     [](const SoakRecord& a, const SoakRecord& b) { return a.sequence < b.sequence; });
+    std::vector<CsvRow> rows;
+    int boot = 0;
+    for (size_t i = 0; i < records.size(); i++) {
+        if (i > 0 && records[i].timeMs < records[i - 1].timeMs) boot++;
+        rows.push_back({records[i], boot});
+    }
+    return rows;
+}
+
+static bool setSpeed(int fd, long baud) {
+    termios settings;
+    if (tcgetattr(fd, &settings) != 0) return true; // Not a tty: nothing to set
+    cfmakeraw(&settings);
+    static const struct { long baud; speed_t speed; } speeds[] = {
+        {115200, B115200}, {230400, B230400}, {460800, B460800}, {921600, B921600},
+        {1000000, B1000000}, {1500000, B1500000}, {2000000, B2000000},
+    };
+    for (const auto& entry : speeds) {
+        if (entry.baud == baud) {
+            cfsetispeed(&settings, entry.speed);
+            cfsetospeed(&settings, entry.speed);
+            return tcsetattr(fd, TCSANOW, &settings) == 0;
+        }
+    }
+    fprintf(stderr, "unsupported baud %ld\n", baud);
+    return false;
+}
+
+// Ask the board for a dump and feed its lines to the reader
+static bool readDumpFromPort(const char* port, DumpReader& reader) {
+    int fd = open(port, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        fprintf(stderr, "can't open %s: %s\n", port, strerror(errno));
+        return false;
+    }
+    if (!setSpeed(fd, 115200)) return false;
+    tcflush(fd, TCIOFLUSH);
+    if (write(fd, "d", 1) != 1) return false;
+
+    std::string line;
+    char buffer[4096];
+    for (;;) {
+        pollfd in = {fd, POLLIN, 0};
+        if (poll(&in, 1, 10000) <= 0) {
+            fprintf(stderr, "no dump from %s\n", port);
+            close(fd);
+            return false;
+        }
+        ssize_t got = read(fd, buffer, sizeof(buffer));
+        if (got <= 0) break;
+        for (ssize_t i = 0; i < got; i++) {
+            if (buffer[i] != '\n') {
+                if (buffer[i] != '\r') line += buffer[i];
+                continue;
+            }
+            unsigned long baud;
+            if (sscanf(line.c_str(), "SOAK DUMP BEGIN baud=%lu", &baud) == 1) {
+                fprintf(stderr, "%s\n", line.c_str());
+                tcdrain(fd);
+                if (!setSpeed(fd, (long)baud)) return false;
+            } else if (reader.line(line.c_str())) {
+                close(fd);
+                return true;
+            }
+            line.clear();
+        }
+    }
+    close(fd);
+    return false;
+}
+
+static int runConvert(int argc, char** argv) {
+    const char* logPath = nullptr;
+    const char* port = nullptr;
+    const char* outPath = nullptr;
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--log") && hasValue) { logPath = argv[++i]; }
+        else if (!strcmp(argv[i], "--port") && hasValue) { port = argv[++i]; }
+        else if (!strcmp(argv[i], "--out") && hasValue) { outPath = argv[++i]; }
+        else {
+            fprintf(stderr, "usage: %s convert [--log FILE | --port PATH] [--out FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    DumpReader reader;
+    if (port != nullptr) {
+        if (!readDumpFromPort(port, reader)) return 1;
+    } else {
+        FILE* in = logPath != nullptr ? fopen(logPath, "r") : stdin;
+        if (in == nullptr) {
+            fprintf(stderr, "can't open %s: %s\n", logPath, strerror(errno));
+            return 1;
+        }
+        char line[1024];
+        while (fgets(line, sizeof(line), in) != nullptr) {
+            line[strcspn(line, "\r\n")] = '\0';
+            if (reader.line(line)) break;
+        }
+        if (in != stdin) fclose(in);
+    }
+    if (!reader.ended) fprintf(stderr, "no SOAK DUMP END line: the dump is cut short\n");
+
+    FILE* out = outPath != nullptr ? fopen(outPath, "w") : stdout;
+    if (out == nullptr) {
+        fprintf(stderr, "can't write %s: %s\n", outPath, strerror(errno));
+        return 1;
+    }
+    std::vector<CsvRow> rows = rowsFromRecords(reader.records);
+    writeCsv(out, rows);
+    if (out != stdout) fclose(out);
+    fprintf(stderr, "%zu records, %d boots\n", rows.size(), rows.empty() ? 0 : rows.back().boot + 1);
+    return reader.ended && reader.valid ? 0 : 1;
+}
+
+// --- simulate ---
+// The writer side of src/soak_log.cpp over a byte array instead of segment files
+struct SimulatedRing {
+    std::vector<uint8_t> flash = std::vector<uint8_t>(soakRingSlots * soakRecordSize, 0xFF);
+    std::vector<uint8_t> batch = std::vector<uint8_t>(soakRecordsPerBatch * soakRecordSize);
+    int fillCount = 0;
+    uint32_t nextSlot = 0;
+    uint32_t nextSequence = 0;
+    // What was written where, kept apart from the flash contents
+    std::vector<CsvRow> persisted;
+    std::vector<int> slotOwner = std::vector<int>(soakRingSlots, -1);
+    std::vector<CsvRow> pendingRows;
+
+    void boot() {
+        std::vector<uint8_t> firstRecords(SOAK_LOG_SEGMENTS * soakRecordSize);
+        for (int s = 0; s < SOAK_LOG_SEGMENTS; s++) {
+            memcpy(&firstRecords[s * soakRecordSize], &flash[(size_t)s * SOAK_LOG_SEGMENT_BYTES], soakRecordSize);
+        }
+        int newest = soakLogNewestSegment(firstRecords.data(), SOAK_LOG_SEGMENTS);
+        SoakResume resume = soakLogResume(newest, newest >= 0 ? &flash[(size_t)newest * SOAK_LOG_SEGMENT_BYTES] : nullptr);
+        nextSlot = resume.slot;
+        nextSequence = resume.sequence;
+        fillCount = 0;
+        pendingRows.clear();
+    }
+
+    void append(SoakRecord record, int bootIndex) {
+        record.sequence = nextSequence++;
+        soakRecordEncode(record, &batch[fillCount * soakRecordSize]);
+        pendingRows.push_back({record, bootIndex});
+        if (++fillCount == soakRecordsPerBatch) writeBatch();
+    }
+
+    // As handOver() and writeBatch(): padded to a whole batch
+    void writeBatch() {
+        if (fillCount == 0) return;
+        memset(&batch[fillCount * soakRecordSize], 0xFF, (soakRecordsPerBatch - fillCount) * soakRecordSize);
+        memcpy(&flash[(size_t)nextSlot * soakRecordSize], batch.data(), batch.size());
+        for (int i = 0; i < soakRecordsPerBatch; i++) {
+            slotOwner[nextSlot + i] = i < fillCount ? (int)persisted.size() + i : -1;
+        }
+        persisted.insert(persisted.end(), pendingRows.begin(), pendingRows.end());
+        pendingRows.clear();
+        nextSlot = (nextSlot + soakRecordsPerBatch) % soakRingSlots;
+        fillCount = 0;
+    }
+
+    // As soakLogDump()
+    void dump(FILE* out) {
+        fprintf(out, "SOAK DUMP BEGIN baud=0 slots=%lu record_bytes=%d\n", (unsigned long)soakRingSlots, soakRecordSize);
+        SoakDumpWriter writer([](const char* line, void* context) { fprintf((FILE*)context, "%s\n", line); }, out);
+        for (uint32_t n = 0; n < soakRingSlots; n += soakDumpRecordsPerLine) {
+            uint32_t slot = (nextSlot + n) % soakRingSlots;
+            writer.addSlots(&flash[(size_t)slot * soakRecordSize], soakDumpRecordsPerLine);
+        }
+        writer.finish();
+    }
+
+    // Records still in flash, in write order, with boots renumbered from the oldest one kept
+    std::vector<CsvRow> expected() const {
+        std::vector<bool> kept(persisted.size(), false);
+        for (int owner : slotOwner) {
+            if (owner >= 0) kept[owner] = true;
+        }
+        std::vector<CsvRow> rows;
+        for (size_t i = 0; i < persisted.size(); i++) {
+            if (kept[i]) rows.push_back(persisted[i]);
+        }
+        int boot = -1;
+        int lastBoot = -1;
+        for (CsvRow& row : rows) {
+            if (row.boot != lastBoot) {
+                lastBoot = row.boot;
+                boot++;
+            }
+            row.boot = boot;
+        }
+        return rows;
+    }
+};
+
+static uint32_t nextRandom(uint32_t& state) {
+    state = state * 1664525 + 1013904223;
+    return state >> 8;
+}
+
+static int runSimulate(int argc, char** argv) {
+    int records = 0;
+    int reboots = 0;
+    uint32_t seed = 1;
+    const char* expectPath = nullptr;
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--records") && hasValue) { records = atoi(argv[++i]); }
+        else if (!strcmp(argv[i], "--reboots") && hasValue) { reboots = atoi(argv[++i]); }
+        else if (!strcmp(argv[i], "--seed") && hasValue) { seed = (uint32_t)atol(argv[++i]); }
+        else if (!strcmp(argv[i], "--expect") && hasValue) { expectPath = argv[++i]; }
+        else { records = 0; break; }
+    }
+    if (records <= 0) {
+        fprintf(stderr, "usage: %s simulate --records N [--reboots K] [--seed S] [--expect FILE]\n", argv[0]);
+        return 2;
+    }
+
+    SimulatedRing ring;
+    ring.boot();
+    int bootIndex = 0;
+    uint32_t timeMs = 1000 + nextRandom(seed) % 4000;
+    int cuts = 0;
+    for (int n = 0; n < records; n++) {
+        SoakRecord record;
+        record.timeMs = timeMs;
+        record.busMv = (uint16_t)(5000 - nextRandom(seed) % 300);
+        record.currentMa = (int16_t)(nextRandom(seed) % 4000 - 100);
+        record.lux = n % 17 == 0 ? soakLuxNone : (uint16_t)(nextRandom(seed) % 2000);
+        record.pattern = (uint8_t)(n / 50 % 6);
+        record.brightness = (uint8_t)(nextRandom(seed) % 256);
+        ring.append(record, bootIndex);
+        timeMs += SOAK_LOG_INTERVAL_MS;
+
+        // Spread the reboots out; every other one is a power cut that loses the partial batch
+        if (reboots > 0 && (n + 1) % (records / (reboots + 1) + 1) == 0 && bootIndex < reboots) {
+            if (bootIndex % 2 == 0) {
+                ring.fillCount = 0;
+                ring.pendingRows.clear();
+                cuts++;
+            } else {
+                ring.writeBatch(); // Logging turned off first
+            }
+            ring.boot();
+            bootIndex++;
+            timeMs = 1000 + nextRandom(seed) % 4000;
+        }
+    }
+    ring.writeBatch(); // The dump writes out the partial batch first
+    ring.dump(stdout);
+
+    std::vector<CsvRow> expected = ring.expected();
+    fprintf(stderr, "SIM records=%d reboots=%d power_cuts=%d slots=%lu kept=%zu\n", records, bootIndex, cuts,
+            (unsigned long)soakRingSlots, expected.size());
+    if (expectPath != nullptr) {
+        FILE* out = fopen(expectPath, "w");
+        if (out == nullptr) return 1;
+        writeCsv(out, expected);
+        fclose(out);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && !strcmp(argv[1], "convert")) return runConvert(argc, argv);
+    if (argc >= 2 && !strcmp(argv[1], "simulate")) return runSimulate(argc, argv);
+    fprintf(stderr, "usage: %s convert|simulate ...\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,152 @@
+// Host build of one controller on the animation sync chain (anim_sync.h), for
+// testing on Linux without hardware. Each node writes its beacons to a new pty
+// and prints the pty's path; the next node reads that path. The link stands in
+// for the UART between two controllers. scripts/sync_pty_chain.sh builds this
+// and wires up a leader and a few followers.
+//
+//   sync_node --name f1 --rx /dev/pts/7 [--ppm 40] [--offset-ms 2500] [--seconds 30]
+//   sync_node --name leader --leader
+//
+// --ppm and --offset-ms give the node's simulated crystal an error and start
+// offset against CLOCK_MONOTONIC. The leader should run without them: its
+// clock is then the reference, and each follower also prints its true error.
+
+#include "anim_sync.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+static double clockPpm = 0;
+static double clockOffsetUs = 0;
+
+static uint64_t monotonicUs() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000ULL + now.tv_nsec / 1000;
+}
+
+// This node's own clock, running fast or slow by clockPpm
+static uint64_t localUs(uint64_t trueUs) {
+    return (uint64_t)((double)trueUs * (1.0 + clockPpm * 1e-6) + clockOffsetUs);
+}
+
+static void makeRaw(int fd) {
+    termios settings;
+    if (tcgetattr(fd, &settings) != 0) return;
+    cfmakeraw(&settings);
+    tcsetattr(fd, TCSANOW, &settings);
+}
+
+// New pty for beacons going out; the slave side stays open here so writes
+// never fail while nobody is listening yet
+static int openTxPty() {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) return -1;
+    const char* path = ptsname(master);
+    int slave = open(path, O_RDWR | O_NOCTTY);
+    if (slave < 0) return -1;
+    makeRaw(slave);
+    fcntl(master, F_SETFL, O_NONBLOCK);
+    printf("TX %s\n", path);
+    fflush(stdout);
+    return master;
+}
+
+static int openRx(const char* path) {
+    int fd = open(path, O_RDONLY | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) return -1;
+    makeRaw(fd);
+    tcflush(fd, TCIFLUSH); // Drop beacons queued before this node started
+    return fd;
+}
+
+int main(int argc, char** argv) {
+    const char* name = "node";
+    const char* rxPath = nullptr;
+    bool leader = false;
+    double seconds = 0;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--leader")) { leader = true; }
+        else if (!strcmp(argv[i], "--name") && hasValue) { name = argv[++i]; }
+        else if (!strcmp(argv[i], "--rx") && hasValue) { rxPath = argv[++i]; }
+        else if (!strcmp(argv[i], "--ppm") && hasValue) { clockPpm = atof(argv[++i]); }
+        else if (!strcmp(argv[i], "--offset-ms") && hasValue) { clockOffsetUs = atof(argv[++i]) * 1000; }
+        else if (!strcmp(argv[i], "--seconds") && hasValue) { seconds = atof(argv[++i]); }
+        else {
+            fprintf(stderr, "usage: %s --name N (--leader | --rx PATH) [--ppm P] [--offset-ms O] [--seconds S]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (leader == (rxPath != nullptr)) {
+        fprintf(stderr, "%s: need exactly one of --leader or --rx\n", name);
+        return 2;
+    }
+
+    int rxFd = -1;
+    if (rxPath != nullptr && (rxFd = openRx(rxPath)) < 0) {
+        fprintf(stderr, "%s: can't open %s: %s\n", name, rxPath, strerror(errno));
+        return 1;
+    }
+    int txFd = openTxPty();
+    if (txFd < 0) {
+        fprintf(stderr, "%s: can't create a pty: %s\n", name, strerror(errno));
+        return 1;
+    }
+
+    // A pty has no wire time; what is left of the delay is read latency, which the filter handles
+    SyncNode node(0);
+    node.setRole(leader ? SYNC_ROLE_LEADER : SYNC_ROLE_FOLLOWER);
+    const SyncPatternState leaderPattern = {0, 0}; // Rainbow from leader time 0
+
+    uint64_t startUs = monotonicUs();
+    uint64_t nextReportUs = startUs + 1000000;
+    for (;;) {
+        uint64_t nowUs = monotonicUs();
+        if (seconds > 0 && nowUs - startUs >= (uint64_t)(seconds * 1e6)) break;
+
+        uint64_t dueUs = node.usUntilDue(localUs(nowUs));
+        uint64_t waitUs = nextReportUs > nowUs ? nextReportUs - nowUs : 0;
+        if (dueUs < waitUs) { waitUs = dueUs; }
+        pollfd rx = {rxFd, POLLIN, 0};
+        poll(&rx, rxFd >= 0 ? 1 : 0, (int)((waitUs + 999) / 1000));
+
+        if (rxFd >= 0 && (rx.revents & POLLIN)) {
+            uint8_t buffer[256];
+            ssize_t length = read(rxFd, buffer, sizeof(buffer));
+            if (length > 0) { node.receive(buffer, (size_t)length, localUs(monotonicUs())); }
+        }
+
+        uint8_t beacon[syncBeaconSize];
+        size_t length = node.poll(localUs(monotonicUs()), leaderPattern, beacon);
+        if (length > 0 && write(txFd, beacon, length) < 0 && errno != EAGAIN) {
+            fprintf(stderr, "%s: write failed: %s\n", name, strerror(errno));
+        }
+
+        nowUs = monotonicUs();
+        if (nowUs < nextReportUs) continue;
+        nextReportUs += 1000000;
+        SyncNodeStats stats = node.stats();
+        if (leader) {
+            printf("SYNC node=%s role=leader sent=%lu\n", name, (unsigned long)stats.sent);
+        } else {
+            SyncClockStats clock = node.clock().stats();
+            int64_t trueErrorUs = (int64_t)(node.sharedTimeUs(localUs(nowUs)) - nowUs);
+            printf("SYNC node=%s role=follower locked=%d hops=%u received=%lu crc_errors=%lu drift_ppm=%.3f "
+                   "error_us=%ld worst_error_us=%ld true_error_us=%lld pattern_t_ms=%lu\n",
+                   name, node.following() ? 1 : 0, stats.hops, (unsigned long)stats.received, (unsigned long)stats.crcErrors,
+                   clock.driftPpb / 1000.0, (long)clock.lastErrorUs, (long)clock.worstErrorUs, (long long)trueErrorUs,
+                   (unsigned long)(node.sharedTimeUs(localUs(nowUs)) / 1000 - leaderPattern.epochMs));
+            node.clock().clearErrorPeak();
+        }
+        fflush(stdout);
+    }
+    return 0;
+}